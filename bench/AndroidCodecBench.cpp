@@ -12,12 +12,19 @@
 #include "SkCommandLineFlags.h"
 #include "SkOSFile.h"
 
-AndroidCodecBench::AndroidCodecBench(SkString baseName, SkData* encoded, int sampleSize)
+AndroidCodecBench::AndroidCodecBench(SkString baseName, SkData* encoded, int sampleSize,
+                                     Mode mode)
     : fData(SkRef(encoded))
     , fSampleSize(sampleSize)
+    , fMode(mode)
 {
     // Parse filename and the color type to give the benchmark a useful name
     fName.printf("AndroidCodec_%s_SampleSize%d", baseName.c_str(), sampleSize);
+    switch (mode) {
+        case kPointSample_Mode:                               break;
+        case kBoxFilter_Mode:   fName.append("_box");         break;
+        case kScalePixels_Mode: fName.append("_scalePixels"); break;
+    }
 }
 
 const char* AndroidCodecBench::onGetName() {
@@ -43,8 +50,23 @@ void AndroidCodecBench::onDelayedSetup() {
 
 void AndroidCodecBench::onDraw(int n, SkCanvas* canvas) {
     std::unique_ptr<SkAndroidCodec> codec;
+    if (kScalePixels_Mode == fMode) {
+        for (int i = 0; i < n; i++) {
+            codec = SkAndroidCodec::MakeFromData(fData);
+            SkBitmap full;
+            full.allocPixels(fInfo.makeWH(codec->getInfo().width(), codec->getInfo().height()));
+            codec->getAndroidPixels(full.info(), full.getPixels(), full.rowBytes());
+            SkPixmap dst(fInfo, fPixelStorage.get(), fInfo.minRowBytes());
+            full.pixmap().scalePixels(dst, kMedium_SkFilterQuality);
+        }
+        return;
+    }
+
     SkAndroidCodec::AndroidOptions options;
     options.fSampleSize = fSampleSize;
+    if (kBoxFilter_Mode == fMode) {
+        options.fSampleFilter = SkAndroidCodec::SampleFilter::kBox;
+    }
     for (int i = 0; i < n; i++) {
         codec = SkAndroidCodec::MakeFromData(fData);
 #ifdef SK_DEBUG
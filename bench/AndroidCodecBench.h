@@ -20,8 +20,15 @@
  */
 class AndroidCodecBench : public Benchmark {
 public:
+    enum Mode {
+        kPointSample_Mode,  // SkAndroidCodec::SampleFilter::kPoint
+        kBoxFilter_Mode,    // SkAndroidCodec::SampleFilter::kBox
+        kScalePixels_Mode,  // Decode at full size, then SkPixmap::scalePixels().
+    };
+
     // Calls encoded->ref()
-    AndroidCodecBench(SkString basename, SkData* encoded, int sampleSize);
+    AndroidCodecBench(SkString basename, SkData* encoded, int sampleSize,
+                      Mode = kPointSample_Mode);
 
 protected:
     const char* onGetName() override;
@@ -33,6 +40,7 @@ private:
     SkString                fName;
     sk_sp<SkData>           fData;
     const int               fSampleSize;
+    const Mode              fMode;
     SkImageInfo             fInfo;          // Set in onDelayedSetup.
     SkAutoMalloc            fPixelStorage;  // Set in onDelayedSetup.
     typedef Benchmark INHERITED;
@@ -129,6 +129,10 @@ public:
 
     virtual void getGpuStats(SkCanvas*, SkTArray<SkString>* keys, SkTArray<double>* values) {}
 
+    // Appends keys and values of the benchmark's own counts, like allocations per draw, to report
+    // next to its timings.
+    virtual void getStats(SkTArray<SkString>*, SkTArray<double>*) {}
+
 protected:
     virtual void setupPaint(SkPaint* paint);
 
@@ -8,11 +8,13 @@
 #include "Benchmark.h"
 #include "SkBitmap.h"
 #include "SkBlurImageFilter.h"
+#include "SkExecutor.h"
 #include "SkOffsetImageFilter.h"
 #include "SkCanvas.h"
 #include "SkPaint.h"
 #include "SkRandom.h"
 #include "SkShader.h"
+#include "SkSpecialImage.h"
 #include "SkString.h"
 
 #define FILTER_WIDTH_SMALL  32
@@ -125,6 +127,60 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Runs each band as soon as it's added, on the calling thread.
+class InlineExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { work(); }
+};
+
+// Blurs a full 4K raster layer, as a backdrop blur would, splitting the work across a thread pool
+// of the given size (or running it all on the calling thread when threads is 0).
+class BlurImageFilter4KBench : public Benchmark {
+public:
+    BlurImageFilter4KBench(SkScalar sigma, int threads) : fSigma(sigma), fThreads(threads) {
+        fName.printf("blur_image_filter_4k_%.2f_%d_threads", SkScalarToFloat(sigma), threads);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        SkBitmap checkerboard = make_checkerboard(3840, 2160);
+        fImage = SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(3840, 2160), checkerboard);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        } else {
+            // Not SkExecutor::GetDefault(), which nanobench may have made a thread pool.
+            fExecutor.reset(new InlineExecutor);
+        }
+        fFilter = SkBlurImageFilter::Make(fSigma, fSigma, nullptr);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkImageFilter::OutputProperties noColorSpace(nullptr);
+        SkImageFilter::Context ctx(SkMatrix::I(), fImage->subset(), nullptr, noColorSpace,
+                                   fExecutor.get());
+        for (int i = 0; i < loops; i++) {
+            SkIPoint offset;
+            sk_sp<SkSpecialImage> result = fFilter->filterImage(fImage.get(), ctx, &offset);
+        }
+    }
+
+private:
+    SkString                    fName;
+    SkScalar                    fSigma;
+    int                         fThreads;
+    sk_sp<SkSpecialImage>       fImage;
+    sk_sp<SkImageFilter>        fFilter;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    typedef Benchmark INHERITED;
+};
+
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, 0, false, false, false);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_SMALL, 0, false, false, false);)
 DEF_BENCH(return new BlurImageFilterBench(0, BLUR_SIGMA_LARGE, false, false, false);)
@@ -163,3 +219,6 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+DEF_BENCH(return new BlurImageFilter4KBench(BLUR_SIGMA_LARGE, 0);)
+DEF_BENCH(return new BlurImageFilter4KBench(BLUR_SIGMA_LARGE, 4);)
@@ -7,7 +7,10 @@
 
 #include "Benchmark.h"
 #include "Resources.h"
+#include "SkAutoMalloc.h"
 #include "SkBitmap.h"
+#include "SkCodec.h"
+#include "SkExecutor.h"
 #include "SkJpegEncoder.h"
 #include "SkPngEncoder.h"
 #include "SkWebpEncoder.h"
@@ -46,6 +49,53 @@ private:
     SkBitmap    fBitmap;
 };
 
+// Re-encodes the YUV planes of a jpeg, without going through RGB.
+class EncodeYUVBench : public Benchmark {
+public:
+    EncodeYUVBench(const char* filename)
+        : fSourceFilename(filename)
+        , fName(SkStringPrintf("Encode_%s_JPEG_YUV", filename)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onPreDraw(SkCanvas*) override {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(GetResourceAsData(fSourceFilename));
+        SkAssertResult(codec && codec->queryYUV8(&fSizeInfo, &fYUVColorSpace));
+        fColorSpace = codec->getInfo().refColorSpace();
+        size_t sizes[3];
+        for (int i = 0; i < 3; i++) {
+            sizes[i] = fSizeInfo.fWidthBytes[i] * fSizeInfo.fSizes[i].height();
+        }
+        fStorage.reset(sizes[0] + sizes[1] + sizes[2]);
+        fPlanes[0] = fStorage.get();
+        fPlanes[1] = SkTAddOffset<void>(fPlanes[0], sizes[0]);
+        fPlanes[2] = SkTAddOffset<void>(fPlanes[1], sizes[1]);
+        SkAssertResult(SkCodec::kSuccess == codec->getYUV8Planes(fSizeInfo, fPlanes));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkJpegEncoder::Options opts;
+        opts.fQuality = 90;
+        while (loops-- > 0) {
+            SkNullWStream dst;
+            SkAssertResult(SkJpegEncoder::EncodeYUV(&dst, fSizeInfo, fPlanes, fYUVColorSpace,
+                                                    fColorSpace.get(), opts));
+            SkASSERT(dst.bytesWritten() > 0);
+        }
+    }
+
+private:
+    const char*         fSourceFilename;
+    SkString            fName;
+    SkYUVSizeInfo       fSizeInfo;
+    SkYUVColorSpace     fYUVColorSpace;
+    sk_sp<SkColorSpace> fColorSpace;
+    SkAutoMalloc        fStorage;
+    void*               fPlanes[3];
+};
+
 static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
     SkJpegEncoder::Options opts;
     opts.fQuality = 90;
@@ -71,23 +121,34 @@ static bool encode_webp_lossless(SkWStream* dst, const SkPixmap& src) {
 static bool encode_png(SkWStream* dst,
                        const SkPixmap& src,
                        SkPngEncoder::FilterFlag filters,
-                       int zlibLevel) {
+                       int zlibLevel,
+                       SkExecutor* executor = nullptr) {
     SkPngEncoder::Options opts;
     opts.fFilterFlags = filters;
     opts.fUnpremulBehavior = SkTransferFunctionBehavior::kIgnore;
     opts.fZLibLevel = zlibLevel;
+    opts.fExecutor = executor;
     return SkPngEncoder::Encode(dst, src, opts);
 }
 
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
+// Splits the encode up on the default executor (see --threads).
+#define PNG_PARALLEL(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL, \
+                             &SkExecutor::GetDefault()); }
+
 static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
 DEF_BENCH(return new EncodeBench(srcs[0], &encode_jpeg, "JPEG"));
 DEF_BENCH(return new EncodeBench(srcs[1], &encode_jpeg, "JPEG"));
 
+// Compare re-encoding a jpeg from RGB to re-encoding its YUV planes.
+DEF_BENCH(return new EncodeBench("images/mandrill_512_q075.jpg", &encode_jpeg, "JPEG"));
+DEF_BENCH(return new EncodeYUVBench("images/mandrill_512_q075.jpg"));
+
 // TODO: What is the appropriate quality to use to benchmark WEBP encodes?
 DEF_BENCH(return new EncodeBench(srcs[0], encode_webp_lossy, "WEBP"));
 DEF_BENCH(return new EncodeBench(srcs[1], encode_webp_lossy, "WEBP"));
@@ -119,4 +180,10 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_PARALLEL(kAll, 6), "PNG_parallel"));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_PARALLEL(kAll, 1), "PNG_parallel_1"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_PARALLEL(kAll, 6), "PNG_parallel"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_PARALLEL(kAll, 1), "PNG_parallel_1"));
+
 #undef PNG
+#undef PNG_PARALLEL
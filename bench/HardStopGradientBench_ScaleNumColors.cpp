@@ -33,6 +33,7 @@ public:
     HardStopGradientBench_ScaleNumColors(SkShader::TileMode tilemode, int count) {
         fName.printf("hardstop_scale_num_colors_%s_%03d_colors", get_tilemode_name(tilemode), count);
 
+        SkASSERT(count <= kMaxColors);
         fTileMode   = tilemode;
         fColorCount = count;
     }
@@ -68,13 +69,13 @@ public:
         };
 
         // Alternate between different choices
-        SkColor  colors[100];
+        SkColor  colors[kMaxColors];
         for (int i = 0; i < fColorCount; i++) {
             colors[i] = color_choices[i % kNumColorChoices];
         }
 
         // Create a hard stop
-        SkScalar positions[100];
+        SkScalar positions[kMaxColors];
         positions[0] = 0.0f;
         positions[1] = 0.0f;
         for (int i = 2; i < fColorCount; i++) {
@@ -102,6 +103,7 @@ public:
 
 private:
     static const int kSize = 500;
+    static const int kMaxColors = 256;
 
     SkShader::TileMode  fTileMode;
     SkString            fName;
@@ -119,6 +121,7 @@ DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kClamp_TileM
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kClamp_TileMode,  25);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kClamp_TileMode,  50);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kClamp_TileMode, 100);)
+DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kClamp_TileMode, 256);)
 
 // Repeat
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_TileMode,   3);)
@@ -128,6 +131,7 @@ DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_Tile
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_TileMode,  25);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_TileMode,  50);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_TileMode, 100);)
+DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kRepeat_TileMode, 256);)
 
 // Mirror
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_TileMode,   3);)
@@ -137,3 +141,4 @@ DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_Tile
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_TileMode,  25);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_TileMode,  50);)
 DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_TileMode, 100);)
+DEF_BENCH(return new HardStopGradientBench_ScaleNumColors(SkShader::kMirror_TileMode, 256);)
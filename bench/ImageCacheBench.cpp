@@ -7,6 +7,7 @@
 
 #include "Benchmark.h"
 #include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +73,44 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Looks up keys in the global cache from many threads at once, to measure lock contention.
+class ImageCacheThreadedBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 512,
+        THREAD_COUNT = 8,
+        FINDS_PER_LOOP = 64,
+    };
+public:
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+protected:
+    const char* onGetName() override {
+        return "imagecache_threaded";
+    }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            SkResourceCache::Add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup().batch(THREAD_COUNT, [&](int thread) {
+            for (int i = 0; i < loops; ++i) {
+                for (int j = 0; j < FINDS_PER_LOOP; ++j) {
+                    // Hits reorder the LRU, so every one needs exclusive access to its cache.
+                    TestKey key((thread * FINDS_PER_LOOP + i + j) % CACHE_COUNT);
+                    SkResourceCache::Find(key, TestRec::Visitor, nullptr);
+                }
+            }
+        });
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ImageCacheThreadedBench(); )
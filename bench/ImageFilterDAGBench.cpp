@@ -7,10 +7,12 @@
 
 #include "Benchmark.h"
 #include "Resources.h"
+#include "SkBitmapDevice.h"
 #include "SkBlurImageFilter.h"
 #include "SkCanvas.h"
 #include "SkDisplacementMapEffect.h"
 #include "SkImage.h"
+#include "SkMakeUnique.h"
 #include "SkMergeImageFilter.h"
 #include "SkOffsetImageFilter.h"
 #include "SkXfermodeImageFilter.h"
@@ -18,17 +20,37 @@
 // Exercise a blur filter connected to 5 inputs of the same merge filter.
 // This bench shows an improvement in performance once cacheing of re-used
 // nodes is implemented, since the DAG is no longer flattened to a tree.
+// With a tile size, it draws to a raster device of its own that evaluates the DAG one tile of
+// its output at a time.
 class ImageFilterDAGBench : public Benchmark {
 public:
-    ImageFilterDAGBench() {}
+    ImageFilterDAGBench(int tileSize = 0) : fTileSize(tileSize) {}
 
 protected:
     const char* onGetName() override {
-        return "image_filter_dag";
+        return fTileSize ? "image_filter_dag_tiled" : "image_filter_dag";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return fTileSize ? kRaster_Backend == backend : INHERITED::isSuitableFor(backend);
+    }
+
+    void onDelayedSetup() override {
+        if (fTileSize) {
+            const SkIPoint size = this->getSize();
+            SkBitmap bitmap;
+            bitmap.allocN32Pixels(size.x(), size.y());
+            sk_sp<SkBitmapDevice> device(new SkBitmapDevice(bitmap));
+            device->setImageFilterTileSize(fTileSize);
+            fTiledCanvas = skstd::make_unique<SkCanvas>(std::move(device));
+        }
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
         const SkRect rect = SkRect::Make(SkIRect::MakeWH(400, 400));
+        if (fTiledCanvas) {
+            canvas = fTiledCanvas.get();
+        }
 
         for (int j = 0; j < loops; j++) {
             sk_sp<SkImageFilter> blur(SkBlurImageFilter::Make(20.0f, 20.0f, nullptr));
@@ -44,6 +66,8 @@ protected:
 
 private:
     static const int kNumInputs = 5;
+    int fTileSize;
+    std::unique_ptr<SkCanvas> fTiledCanvas;
 
     typedef Benchmark INHERITED;
 };
@@ -145,6 +169,7 @@ private:
 };
 
 DEF_BENCH(return new ImageFilterDAGBench;)
+DEF_BENCH(return new ImageFilterDAGBench(128);)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
@@ -20,20 +20,81 @@ static const char* name(SkMatrixConvolutionImageFilter::TileMode mode) {
     return "oops";
 }
 
+enum class Kernel {
+    k3x3,           // Not separable.
+    kSharpen5x5,    // Not separable.
+    kGaussian5x5,   // Separable.
+    kGaussian7x7,   // Separable.
+};
+
+static const char* name(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::k3x3:         return "";
+        case Kernel::kSharpen5x5:  return "_sharpen5x5";
+        case Kernel::kGaussian5x5: return "_gaussian5x5";
+        case Kernel::kGaussian7x7: return "_gaussian7x7";
+    }
+    return "oops";
+}
+
 class MatrixConvolutionBench : public Benchmark {
 public:
-    MatrixConvolutionBench(SkMatrixConvolutionImageFilter::TileMode tileMode, bool convolveAlpha)
-        : fName(SkStringPrintf("matrixconvolution_%s%s",
+    MatrixConvolutionBench(SkMatrixConvolutionImageFilter::TileMode tileMode, bool convolveAlpha,
+                           Kernel kernelType = Kernel::k3x3)
+        : fName(SkStringPrintf("matrixconvolution_%s%s%s",
                                name(tileMode),
-                               convolveAlpha ? "" : "_noConvolveAlpha")) {
+                               convolveAlpha ? "" : "_noConvolveAlpha",
+                               name(kernelType))) {
         SkISize kernelSize = SkISize::Make(3, 3);
-        SkScalar kernel[9] = {
+        SkScalar kernel[49] = {
             SkIntToScalar( 1), SkIntToScalar( 1), SkIntToScalar( 1),
             SkIntToScalar( 1), SkIntToScalar(-7), SkIntToScalar( 1),
             SkIntToScalar( 1), SkIntToScalar( 1), SkIntToScalar( 1),
         };
         SkScalar gain = 0.3f, bias = SkIntToScalar(100);
         SkIPoint kernelOffset = SkIPoint::Make(1, 1);
+
+        static const int kBinomial5[] = { 1, 4, 6, 4, 1 },
+                         kBinomial7[] = { 1, 6, 15, 20, 15, 6, 1 };
+        switch (kernelType) {
+            case Kernel::k3x3:
+                break;
+            case Kernel::kSharpen5x5:
+                // Twice the image, less its Gaussian blur.
+                for (int y = 0; y < 5; y++) {
+                    for (int x = 0; x < 5; x++) {
+                        kernel[y * 5 + x] = -kBinomial5[x] * kBinomial5[y] / 256.0f;
+                    }
+                }
+                kernel[12] += 2;
+                kernelSize = SkISize::Make(5, 5);
+                gain = 1;
+                bias = 0;
+                kernelOffset = SkIPoint::Make(2, 2);
+                break;
+            case Kernel::kGaussian5x5:
+                for (int y = 0; y < 5; y++) {
+                    for (int x = 0; x < 5; x++) {
+                        kernel[y * 5 + x] = SkIntToScalar(kBinomial5[x] * kBinomial5[y]);
+                    }
+                }
+                kernelSize = SkISize::Make(5, 5);
+                gain = 1.0f / 256;
+                bias = 0;
+                kernelOffset = SkIPoint::Make(2, 2);
+                break;
+            case Kernel::kGaussian7x7:
+                for (int y = 0; y < 7; y++) {
+                    for (int x = 0; x < 7; x++) {
+                        kernel[y * 7 + x] = SkIntToScalar(kBinomial7[x] * kBinomial7[y]);
+                    }
+                }
+                kernelSize = SkISize::Make(7, 7);
+                gain = 1.0f / 4096;
+                bias = 0;
+                kernelOffset = SkIPoint::Make(3, 3);
+                break;
+        }
         fFilter = SkMatrixConvolutionImageFilter::Make(kernelSize, kernel, gain, bias,
                                                        kernelOffset, tileMode, convolveAlpha,
                                                        nullptr);
@@ -68,3 +129,8 @@ DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kCl
 DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kRepeat_TileMode, true); )
 DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kClampToBlack_TileMode, true); )
 DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kClampToBlack_TileMode, false); )
+
+DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kClamp_TileMode, true, Kernel::kSharpen5x5); )
+DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kClamp_TileMode, true, Kernel::kGaussian5x5); )
+DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kClamp_TileMode, true, Kernel::kGaussian7x7); )
+DEF_BENCH( return new MatrixConvolutionBench(SkMatrixConvolutionImageFilter::kRepeat_TileMode, true, Kernel::kGaussian7x7); )
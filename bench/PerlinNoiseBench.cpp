@@ -11,19 +11,20 @@
 
 class PerlinNoiseBench : public Benchmark {
     SkISize fSize;
+    bool    fTurbulence;
 
 public:
-    PerlinNoiseBench()  {
+    PerlinNoiseBench(bool turbulence) : fTurbulence(turbulence) {
         fSize = SkISize::Make(80, 80);
     }
 
 protected:
     const char* onGetName() override {
-        return "perlinnoise";
+        return fTurbulence ? "perlinnoise_turbulence_stitched" : "perlinnoise";
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
-        this->test(loops, canvas, 0, 0, 0.1f, 0.1f, 3, 0, false);
+        this->test(loops, canvas, 0, 0, 0.1f, 0.1f, 3, 0, fTurbulence);
     }
 
 private:
@@ -42,9 +43,12 @@ private:
               float baseFrequencyX, float baseFrequencyY, int numOctaves, float seed,
               bool stitchTiles) {
         SkPaint paint;
-        paint.setShader(SkPerlinNoiseShader::MakeFractalNoise(baseFrequencyX, baseFrequencyY,
-                                                              numOctaves, seed,
-                                                              stitchTiles ? &fSize : nullptr));
+        const SkISize* tileSize = stitchTiles ? &fSize : nullptr;
+        paint.setShader(fTurbulence
+                ? SkPerlinNoiseShader::MakeTurbulence(baseFrequencyX, baseFrequencyY,
+                                                      numOctaves, seed, tileSize)
+                : SkPerlinNoiseShader::MakeFractalNoise(baseFrequencyX, baseFrequencyY,
+                                                        numOctaves, seed, tileSize));
         for (int i = 0; i < loops; i++) {
             this->drawClippedRect(canvas, x, y, paint);
         }
@@ -55,4 +59,5 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DEF_BENCH( return new PerlinNoiseBench(); )
+DEF_BENCH( return new PerlinNoiseBench(false); )
+DEF_BENCH( return new PerlinNoiseBench(true); )
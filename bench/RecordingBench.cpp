@@ -86,6 +86,73 @@ void PipingBench::onDraw(int loops, SkCanvas*) {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SkNullCanvas.h"
+
+static constexpr int kPipeAnimationFrames = 30;
+
+PipeFrameDeltaBench::PipeFrameDeltaBench(const char* name, const SkPicture* pic, bool decode)
+    : INHERITED(name, pic)
+    , fDecode(decode)
+{
+    fName.prependf("pipe_frames_%s_", decode ? "decode" : "encode");
+}
+
+void PipeFrameDeltaBench::onDelayedSetup() {
+    // Frame 0 is encoded against nothing, so it's a key frame and decoding can loop around.
+    SkPipeSerializer serializer, fullSerializer;
+    size_t deltaBytes = 0, fullBytes = 0;
+    for (int i = 0; i < kPipeAnimationFrames; ++i) {
+        SkDynamicMemoryWStream stream;
+        this->drawFrame(serializer.beginFrame(fSrc->cullRect(), &stream), i);
+        serializer.endFrame();
+        fFrames.push_back(stream.detachAsData());
+
+        SkDynamicMemoryWStream fullStream;
+        this->drawFrame(fullSerializer.beginWrite(fSrc->cullRect(), &fullStream), i);
+        fullSerializer.endWrite();
+
+        // Skip the first frame: it defines all the images, typefaces, etc. in both streams.
+        if (i > 0) {
+            deltaBytes += fFrames.back()->size();
+            fullBytes  += fullStream.bytesWritten();
+        }
+    }
+    fDeltaBytesPerFrame = (double)deltaBytes / (kPipeAnimationFrames - 1);
+    fFullBytesPerFrame  = (double)fullBytes  / (kPipeAnimationFrames - 1);
+}
+
+void PipeFrameDeltaBench::drawFrame(SkCanvas* canvas, int frame) const {
+    // Zoom in 50% about the center over the course of the animation.
+    const SkRect cull = fSrc->cullRect();
+    SkScalar scale = 1 + 0.5f * frame / kPipeAnimationFrames;
+    SkMatrix zoom;
+    zoom.setScale(scale, scale, cull.centerX(), cull.centerY());
+    canvas->concat(zoom);
+    fSrc->playback(canvas);
+}
+
+void PipeFrameDeltaBench::onDraw(int loops, SkCanvas*) {
+    if (fDecode) {
+        SkPipeDeserializer deserializer;
+        std::unique_ptr<SkCanvas> canvas = SkMakeNullCanvas();
+        for (int i = 0; i < loops; ++i) {
+            const SkData* frame = fFrames[i % kPipeAnimationFrames].get();
+            deserializer.playback(frame->data(), frame->size(), canvas.get());
+        }
+    } else {
+        SkDynamicMemoryWStream stream;
+        SkPipeSerializer serializer;
+        for (int i = 0; i < loops; ++i) {
+            this->drawFrame(serializer.beginFrame(fSrc->cullRect(), &stream),
+                            i % kPipeAnimationFrames);
+            serializer.endFrame();
+            stream.reset();
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #include "SkSerialProcs.h"
 
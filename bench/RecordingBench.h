@@ -9,8 +9,10 @@
 #define RecordingBench_DEFINED
 
 #include "Benchmark.h"
+#include "SkData.h"
 #include "SkPicture.h"
 #include "SkLiteDL.h"
+#include "SkTArray.h"
 
 class PictureCentricBench : public Benchmark {
 public:
@@ -53,6 +55,31 @@ private:
     typedef PictureCentricBench INHERITED;
 };
 
+// Pipes a short zoom animation of the picture as frame deltas (SkPipeSerializer::beginFrame).
+// Times either encoding or decoding+playback of one frame.
+class PipeFrameDeltaBench : public PictureCentricBench {
+public:
+    PipeFrameDeltaBench(const char* name, const SkPicture*, bool decode);
+
+    // Valid after delayedSetup(), which encodes the animation.
+    double deltaBytesPerFrame() const { return fDeltaBytesPerFrame; }
+    double fullBytesPerFrame() const { return fFullBytesPerFrame; }
+
+protected:
+    void onDelayedSetup() override;
+    void onDraw(int loops, SkCanvas*) override;
+
+private:
+    void drawFrame(SkCanvas*, int frame) const;
+
+    bool                        fDecode;
+    SkTArray<sk_sp<SkData>>     fFrames;
+    double                      fDeltaBytesPerFrame = 0;
+    double                      fFullBytesPerFrame = 0;
+
+    typedef PictureCentricBench INHERITED;
+};
+
 class DeserializePictureBench : public Benchmark {
 public:
     DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture);
@@ -43,6 +43,7 @@ protected:
     virtual void drawPicture();
 
     const SkPicture* picture() const { return fPic.get(); }
+    SkScalar scale() const { return fScale; }
     const SkTDArray<SkSurface*>& surfaces() const { return fSurfaces; }
     const SkTDArray<SkIRect>& tileRects() const { return fTileRects; }
 
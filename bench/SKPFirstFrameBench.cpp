@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SKPFirstFrameBench.h"
+#include "SkExecutor.h"
+#include "SkGraphics.h"
+#include "SkNoDrawCanvas.h"
+#include "SkSurface.h"
+
+#if SK_SUPPORT_GPU
+#include "GrContext.h"
+#endif
+
+namespace {
+// Collects the lazy images a picture draws.  Images inside shaders are not found.
+class LazyImageCollector : public SkNoDrawCanvas {
+public:
+    LazyImageCollector(const SkRect& bounds, SkTArray<sk_sp<SkImage>>* images)
+        : SkNoDrawCanvas(bounds.roundOut().width(), bounds.roundOut().height())
+        , fImages(images) {}
+
+protected:
+    void onDrawImage(const SkImage* image, SkScalar, SkScalar, const SkPaint*) override {
+        this->collect(image);
+    }
+    void onDrawImageRect(const SkImage* image, const SkRect*, const SkRect&, const SkPaint*,
+                         SrcRectConstraint) override {
+        this->collect(image);
+    }
+    void onDrawImageNine(const SkImage* image, const SkIRect&, const SkRect&,
+                         const SkPaint*) override {
+        this->collect(image);
+    }
+    void onDrawImageLattice(const SkImage* image, const Lattice&, const SkRect&,
+                            const SkPaint*) override {
+        this->collect(image);
+    }
+
+private:
+    void collect(const SkImage* image) {
+        if (!image->isLazyGenerated()) {
+            return;
+        }
+        for (const sk_sp<SkImage>& seen : *fImages) {
+            if (seen.get() == image) {
+                return;
+            }
+        }
+        fImages->push_back(sk_ref_sp(image));
+    }
+
+    SkTArray<sk_sp<SkImage>>* fImages;
+};
+}
+
+SKPFirstFrameBench::SKPFirstFrameBench(const char* name, const SkPicture* pic,
+                                       const SkIRect& clip, SkScalar scale, bool prefetch)
+    : INHERITED(name, pic, clip, scale, false, true)
+    , fPrefetch(prefetch) {
+    fUniqueName.printf("%s_%.2g_first_frame%s", name, scale, prefetch ? "_prefetch" : "");
+}
+
+const char* SKPFirstFrameBench::onGetUniqueName() {
+    return fUniqueName.c_str();
+}
+
+void SKPFirstFrameBench::onPerCanvasPreDraw(SkCanvas* canvas) {
+    INHERITED::onPerCanvasPreDraw(canvas);
+    fDstColorSpace = canvas->imageInfo().refColorSpace();
+
+    LazyImageCollector collector(this->picture()->cullRect(), &fImages);
+    this->picture()->playback(&collector);
+}
+
+void SKPFirstFrameBench::onPerCanvasPostDraw(SkCanvas* canvas) {
+    INHERITED::onPerCanvasPostDraw(canvas);
+    fImages.reset();
+    fHandles.reset();
+}
+
+void SKPFirstFrameBench::drawPicture() {
+    // Start each frame with nothing decoded.
+    fHandles.reset();
+    SkGraphics::PurgeResourceCache();
+#if SK_SUPPORT_GPU
+    if (GrContext* context = this->surfaces()[0]->getCanvas()->getGrContext()) {
+        context->freeGpuResources();
+    }
+#endif
+
+    if (fPrefetch) {
+        for (const sk_sp<SkImage>& image : fImages) {
+            if (auto handle = image->prefetchDecode(SkExecutor::GetDefault(),
+                                                    fDstColorSpace.get())) {
+                fHandles.push_back(std::move(handle));
+            }
+        }
+    }
+
+    INHERITED::drawPicture();
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKPFirstFrameBench_DEFINED
+#define SKPFirstFrameBench_DEFINED
+
+#include "SKPBench.h"
+#include "SkImage.h"
+#include "SkTArray.h"
+
+/**
+ * Times the first draw of an SkPicture, purging the image cache before each draw so that every
+ * lazy image in it must be decoded again.  If prefetch is true, each draw is preceded by a call
+ * to SkImage::prefetchDecode() for every image drawn directly by the picture, on the default
+ * executor (see --threads).
+ */
+class SKPFirstFrameBench : public SKPBench {
+public:
+    SKPFirstFrameBench(const char* name, const SkPicture*, const SkIRect& devClip, SkScalar scale,
+                       bool prefetch);
+
+protected:
+    const char* onGetUniqueName() override;
+    void onPerCanvasPreDraw(SkCanvas* canvas) override;
+    void onPerCanvasPostDraw(SkCanvas* canvas) override;
+
+    void drawMPDPicture() override {
+        SK_ABORT("MPD not supported\n");
+    }
+    void drawPicture() override;
+
+private:
+    const bool                                 fPrefetch;
+    SkString                                   fUniqueName;
+    sk_sp<SkColorSpace>                        fDstColorSpace;
+    SkTArray<sk_sp<SkImage>>                   fImages;
+    SkTArray<sk_sp<SkImage::PrefetchHandle>>   fHandles;
+
+    typedef SKPBench INHERITED;
+};
+
+#endif
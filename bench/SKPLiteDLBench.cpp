@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SKPLiteDLBench.h"
+#include "SkBBHFactory.h"
+#include "SkLiteRecorder.h"
+#include "SkSurface.h"
+#include "SkTaskGroup.h"
+
+SKPLiteDLBench::SKPLiteDLBench(const char* name, const SkPicture* pic, const SkIRect& clip,
+                               SkScalar scale, bool threaded, bool doLooping)
+    : INHERITED(name, pic, clip, scale, threaded, doLooping) {
+    fUniqueName.printf("%s_%.2g_lite", name, scale);
+    if (threaded) {
+        fUniqueName.append("_mpd");
+    }
+
+    SkLiteRecorder recorder;
+    recorder.reset(&fDL, pic->cullRect().roundOut());
+    pic->playback(&recorder);
+
+    SkRTreeFactory factory;
+    fDL.finish(pic->cullRect(), &factory);
+}
+
+const char* SKPLiteDLBench::onGetUniqueName() {
+    return fUniqueName.c_str();
+}
+
+void SKPLiteDLBench::drawTile(int j) {
+    SkCanvas* canvas = this->surfaces()[j]->getCanvas();
+
+    SkAutoCanvasRestore acr(canvas, true);
+    canvas->translate(-this->tileRects()[j].fLeft / this->scale(),
+                      -this->tileRects()[j].fTop  / this->scale());
+    fDL.draw(canvas);
+    canvas->flush();
+}
+
+void SKPLiteDLBench::drawMPDPicture() {
+    // GPU tiles all share one GrContext, so only raster tiles can be drawn concurrently.
+    if (this->surfaces().count() > 0 && this->surfaces()[0]->getCanvas()->getGrContext()) {
+        this->drawPicture();
+        return;
+    }
+    SkTaskGroup().batch(this->tileRects().count(), [this](int j) { this->drawTile(j); });
+}
+
+void SKPLiteDLBench::drawPicture() {
+    for (int j = 0; j < this->tileRects().count(); ++j) {
+        this->drawTile(j);
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKPLiteDLBench_DEFINED
+#define SKPLiteDLBench_DEFINED
+
+#include "SKPBench.h"
+#include "SkLiteDL.h"
+
+/**
+ * Plays back an SKP re-recorded into an SkLiteDL (with an R-tree) into each tile.
+ * When threaded, raster tiles all draw the same SkLiteDL concurrently on SkExecutor::GetDefault().
+ * GPU tiles share a GrContext, so they are always drawn one after another.
+ */
+class SKPLiteDLBench : public SKPBench {
+public:
+    SKPLiteDLBench(const char* name, const SkPicture*, const SkIRect& devClip, SkScalar scale,
+                   bool threaded, bool doLooping);
+
+protected:
+    const char* onGetUniqueName() override;
+    void drawMPDPicture() override;
+    void drawPicture() override;
+
+private:
+    void drawTile(int j);
+
+    SkLiteDL fDL;
+    SkString fUniqueName;
+
+    typedef SKPBench INHERITED;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkBitmapDevice.h"
+#include "SkCanvas.h"
+#include "SkMakeUnique.h"
+#include "SkPaint.h"
+#include "SkString.h"
+
+// A UI-like frame: a few panels, each a translucent layer holding nested translucent layers.
+// On raster canvases every layer is a fresh buffer unless SkBitmapDevice's layer pool recycles it.
+// The bench draws to a raster device of its own, so that it can turn the pool off, and reports
+// how many layer buffers each frame allocates.
+class SaveLayerBench : public Benchmark {
+public:
+    SaveLayerBench(bool pooled) : fPooled(pooled) {
+        fName.printf("savelayer_nested_translucent%s", pooled ? "" : "_unpooled");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    SkIPoint onGetSize() override { return SkIPoint::Make(1024, 768); }
+
+    bool isSuitableFor(Backend backend) override { return kRaster_Backend == backend; }
+
+    void onDelayedSetup() override {
+        const SkIPoint size = this->getSize();
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(size.x(), size.y());
+        fDevice.reset(new SkBitmapDevice(bitmap));
+        if (!fPooled) {
+            fDevice->setLayerPoolBudget(0);
+        }
+        fCanvas = skstd::make_unique<SkCanvas>(fDevice);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas* canvas = fCanvas.get();
+        SkPaint paint;
+        for (int i = 0; i < loops; ++i) {
+            for (int panel = 0; panel < 4; ++panel) {
+                SkRect r = SkRect::MakeXYWH(32 + panel * 240, 32, 224, 704);
+                for (int depth = 0; depth < 3; ++depth) {
+                    canvas->saveLayerAlpha(&r, 0xC0);
+                    paint.setColor(SkColorSetARGB(0xFF, 0x40 * depth, 0x30 * panel, 0x80));
+                    canvas->drawRect(r, paint);
+                    r.inset(16, 32);
+                }
+                for (int depth = 0; depth < 3; ++depth) {
+                    canvas->restore();
+                }
+            }
+        }
+        fFrames += loops;
+    }
+
+    void getStats(SkTArray<SkString>* keys, SkTArray<double>* values) override {
+        keys->push_back(SkString("layer_allocs_per_frame"));
+        values->push_back(fFrames ? (double)fDevice->layerPoolAllocationCount() / fFrames : 0);
+    }
+
+private:
+    bool                      fPooled;
+    SkString                  fName;
+    sk_sp<SkBitmapDevice>     fDevice;
+    std::unique_ptr<SkCanvas> fCanvas;
+    int64_t                   fFrames = 0;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new SaveLayerBench(true);)
+DEF_BENCH(return new SaveLayerBench(false);)
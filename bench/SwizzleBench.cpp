@@ -37,3 +37,28 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+
+// The rest of SkSwizzler's row procs don't share Swizzle_8888's signature, so adapt them.
+// Each reads no more than K*4 bytes of src.
+static void strip_16_to_8(uint32_t* dst, const void* src, int count) {
+    SkOpts::strip_16_to_8((uint8_t*)dst, src, 2*count);
+}
+static void index_to_n32(uint32_t* dst, const void* src, int count) {
+    static uint32_t ctable[256];
+    SkOpts::index_to_n32(dst, (const uint8_t*)src, count, ctable);
+}
+static void RGBA_to_565(uint32_t* dst, const void* src, int count) {
+    SkOpts::RGBA_to_565((uint16_t*)dst, (const uint32_t*)src, count);
+}
+static void BGRA_to_565(uint32_t* dst, const void* src, int count) {
+    SkOpts::BGRA_to_565((uint16_t*)dst, (const uint32_t*)src, count);
+}
+static void gather_32(uint32_t* dst, const void* src, int count) {
+    SkOpts::gather_32(dst, src, count/2, 8);
+}
+
+DEF_BENCH(return new SwizzleBench("SkOpts::strip_16_to_8", strip_16_to_8));
+DEF_BENCH(return new SwizzleBench("SkOpts::index_to_n32",  index_to_n32));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA_to_565",   RGBA_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::BGRA_to_565",   BGRA_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::gather_32",     gather_32));
@@ -22,6 +22,8 @@
 #include "ResultsWriter.h"
 #include "SKPAnimationBench.h"
 #include "SKPBench.h"
+#include "SKPFirstFrameBench.h"
+#include "SKPLiteDLBench.h"
 #include "SkAndroidCodec.h"
 #include "SkAutoMalloc.h"
 #include "SkBBoxHierarchy.h"
@@ -127,9 +129,12 @@ DEFINE_string(scales, "1.0", "Space-separated scales for SKPs.");
 DEFINE_string(zoom, "1.0,0", "Comma-separated zoomMax,zoomPeriodMs factors for a periodic SKP zoom "
                              "function that ping-pongs between 1.0 and zoomMax.");
 DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
-DEFINE_bool(lite, false, "Use SkLiteRecorder in recording benchmarks?");
+DEFINE_bool(lite, false, "Use SkLiteRecorder in recording benchmarks, and play SKPs back from "
+                         "an SkLiteDL, tiled and (with --mpd, on raster) threaded?");
 DEFINE_bool(mpd, true, "Use MultiPictureDraw for the SKPs?");
 DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
+DEFINE_bool(firstFrame, false, "Also time the first frame of each SKP, decoding its images from "
+                               "scratch, with and without SkImage::prefetchDecode()?");
 DEFINE_int32(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
 DEFINE_bool(gpuStatsDump, false, "Dump GPU states after each benchmark to json");
@@ -141,6 +146,8 @@ DEFINE_string(benchType,  "",
         "Apply usual --match rules to bench type: micro, recording, piping, playback, skcodec, etc.");
 
 DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
+DEFINE_bool(pictureCost, false, "Print each SKP's estimated raster cost next to its measured "
+                                "playback time, and how well the two correlate overall.");
 
 static double now_ms() { return SkTime::GetNSecs() * 1e-6; }
 
@@ -613,6 +620,8 @@ public:
                       , fGMs(skiagm::GMRegistry::Head())
                       , fCurrentRecording(0)
                       , fCurrentPiping(0)
+                      , fCurrentPipeFrames(0)
+                      , fCurrentPipeFrameBench(nullptr)
                       , fCurrentDeserialPicture(0)
                       , fCurrentScale(0)
                       , fCurrentSKP(0)
@@ -626,7 +635,9 @@ public:
                       , fCurrentAlphaType(0)
                       , fCurrentSubsetType(0)
                       , fCurrentSampleSize(0)
-                      , fCurrentAnimSKP(0) {
+                      , fCurrentAnimSKP(0)
+                      , fCurrentFirstFrameSKP(0)
+                      , fHasPictureCost(false) {
         collect_files(FLAGS_skps, ".skp", &fSKPs);
         collect_files(FLAGS_svgs, ".svg", &fSVGs);
 
@@ -718,6 +729,7 @@ public:
     Benchmark* next() {
         std::unique_ptr<Benchmark> bench;
         do {
+            fHasPictureCost = false;
             bench.reset(this->rawNext());
             if (!bench) {
                 return nullptr;
@@ -776,6 +788,23 @@ public:
             return new PipingBench(name.c_str(), pic.get());
         }
 
+        // Add all .skps as PipeFrameDeltaBenches, first encoding, then decoding.
+        while (fCurrentPipeFrames < 2 * fSKPs.count()) {
+            const bool decode = fCurrentPipeFrames >= fSKPs.count();
+            const SkString& path = fSKPs[fCurrentPipeFrames++ % fSKPs.count()];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "pipe_frames";
+            // The animation is only encoded by delayedSetup(), if the bench isn't skipped.
+            auto bench = new PipeFrameDeltaBench(name.c_str(), pic.get(), decode);
+            fCurrentPipeFrameBench = bench;
+            return bench;
+        }
+
         // Add all .skps as DeserializePictureBenchs.
         while (fCurrentDeserialPicture < fSKPs.count()) {
             const SkString& path = fSKPs[fCurrentDeserialPicture++];
@@ -815,6 +844,12 @@ public:
                     SkString name = SkOSPath::Basename(path.c_str());
                     fSourceType = "skp";
                     fBenchType = "playback";
+                    this->setPictureCost(pic.get(), fScales[fCurrentScale]);
+                    if (FLAGS_lite) {
+                        return new SKPLiteDLBench(name.c_str(), pic.get(), fClip,
+                                                  fScales[fCurrentScale],
+                                                  fUseMPDs[fCurrentUseMPD++], FLAGS_loopSKP);
+                    }
                     return new SKPBench(name.c_str(), pic.get(), fClip, fScales[fCurrentScale],
                                         fUseMPDs[fCurrentUseMPD++], FLAGS_loopSKP);
                 }
@@ -827,6 +862,7 @@ public:
                 if (sk_sp<SkPicture> pic = ReadSVGPicture(path)) {
                     fSourceType = "svg";
                     fBenchType = "playback";
+                    this->setPictureCost(pic.get(), fScales[fCurrentScale]);
                     return new SKPBench(SkOSPath::Basename(path).c_str(), pic.get(), fClip,
                                         fScales[fCurrentScale], false, FLAGS_loopSKP);
                 }
@@ -856,6 +892,25 @@ public:
             }
         }
 
+        // Then the first frame of each skp, decoding its images as part of the frame.
+        if (FLAGS_firstFrame) {
+            while (fCurrentFirstFrameSKP < 2 * fSKPs.count()) {
+                const SkString& path = fSKPs[fCurrentFirstFrameSKP / 2];
+                const bool prefetch = 1 == fCurrentFirstFrameSKP % 2;
+                fCurrentFirstFrameSKP++;
+                sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+                if (!pic) {
+                    continue;
+                }
+
+                SkString name = SkOSPath::Basename(path.c_str());
+                fSourceType = "skp";
+                fBenchType = "first_frame";
+                this->setPictureCost(pic.get(), 1.0f);
+                return new SKPFirstFrameBench(name.c_str(), pic.get(), fClip, 1.0f, prefetch);
+            }
+        }
+
         for (; fCurrentCodec < fImages.count(); fCurrentCodec++) {
             fSourceType = "image";
             fBenchType = "skcodec";
@@ -934,6 +989,12 @@ public:
 
         // Run AndroidCodecBenches
         const int sampleSizes[] = { 2, 4, 8 };
+        const AndroidCodecBench::Mode androidCodecModes[] = {
+            AndroidCodecBench::kPointSample_Mode,
+            AndroidCodecBench::kBoxFilter_Mode,
+            AndroidCodecBench::kScalePixels_Mode,
+        };
+        const int androidCodecModeCount = SK_ARRAY_COUNT(androidCodecModes);
         for (; fCurrentAndroidCodec < fImages.count(); fCurrentAndroidCodec++) {
             fSourceType = "image";
             fBenchType = "skandroidcodec";
@@ -950,8 +1011,11 @@ public:
                 continue;
             }
 
-            while (fCurrentSampleSize < (int) SK_ARRAY_COUNT(sampleSizes)) {
-                int sampleSize = sampleSizes[fCurrentSampleSize];
+            // Each sample size is run in every mode.
+            while (fCurrentSampleSize <
+                    (int) SK_ARRAY_COUNT(sampleSizes) * androidCodecModeCount) {
+                int sampleSize = sampleSizes[fCurrentSampleSize / androidCodecModeCount];
+                auto mode = androidCodecModes[fCurrentSampleSize % androidCodecModeCount];
                 fCurrentSampleSize++;
                 if (10 * sampleSize > SkTMin(codec->getInfo().width(), codec->getInfo().height())) {
                     // Avoid benchmarking scaled decodes of already small images.
@@ -959,7 +1023,7 @@ public:
                 }
 
                 return new AndroidCodecBench(SkOSPath::Basename(path.c_str()),
-                                             encoded.get(), sampleSize);
+                                             encoded.get(), sampleSize, mode);
             }
             fCurrentSampleSize = 0;
         }
@@ -1083,9 +1147,35 @@ public:
             log->metric("bytes", fSKPBytes);
             log->metric("ops",   fSKPOps);
         }
+        if (0 == strcmp(fBenchType, "pipe_frames")) {
+            log->metric("bytes_per_frame",      fCurrentPipeFrameBench->deltaBytesPerFrame());
+            log->metric("full_bytes_per_frame", fCurrentPipeFrameBench->fullBytesPerFrame());
+        }
+        if (const SkPicture::Cost* cost = this->currentPictureCost()) {
+            log->metric("cost_pixels",            cost->fPixels);
+            log->metric("cost_ops",               cost->fOps);
+            log->metric("cost_save_layers",       cost->fSaveLayers);
+            log->metric("cost_blur_mask_filters", cost->fBlurMaskFilters);
+            log->metric("cost_image_filters",     cost->fImageFilters);
+            log->metric("cost_complex_paths",     cost->fComplexPaths);
+            log->metric("cost_perspective",       cost->fPerspective);
+        }
+    }
+
+    // The estimated cost of the SKP or SVG we're playing back, or null for other benches.
+    const SkPicture::Cost* currentPictureCost() const {
+        return fHasPictureCost ? &fPictureCost : nullptr;
     }
 
 private:
+    void setPictureCost(const SkPicture* pic, SkScalar scale) {
+        // SKPBench draws the picture scaled into fClip, so cost the part of it that lands there.
+        SkRect region = SkRect::Make(fClip);
+        SkMatrix::MakeScale(1 / scale).mapRect(&region);
+        fPictureCost = pic->approximateCost(region);
+        fHasPictureCost = true;
+    }
+
     enum SubsetType {
         kTopLeft_SubsetType     = 0,
         kTopRight_SubsetType    = 1,
@@ -1117,6 +1207,8 @@ private:
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording;
     int fCurrentPiping;
+    int fCurrentPipeFrames;
+    const PipeFrameDeltaBench* fCurrentPipeFrameBench;  // Owned by our caller, like all benches.
     int fCurrentDeserialPicture;
     int fCurrentScale;
     int fCurrentSKP;
@@ -1131,6 +1223,10 @@ private:
     int fCurrentSubsetType;
     int fCurrentSampleSize;
     int fCurrentAnimSKP;
+    int fCurrentFirstFrameSKP;  // Counts each SKP twice, without and with prefetching.
+
+    SkPicture::Cost fPictureCost;
+    bool            fHasPictureCost;  // Is fPictureCost for the current bench?
 };
 
 // Some runs (mostly, Valgrind) are so slow that the bot framework thinks we've hung.
@@ -1248,6 +1344,7 @@ int main(int argc, char** argv) {
 
     int runs = 0;
     BenchmarkStream benchStream;
+    SkTArray<double> costPixels, costMs;  // --pictureCost: estimated pixels vs. median ms
     while (Benchmark* b = benchStream.next()) {
         std::unique_ptr<Benchmark> bench(b);
         if (SkCommandLineFlags::ShouldSkip(FLAGS_match, bench->getUniqueName())) {
@@ -1316,6 +1413,11 @@ int main(int argc, char** argv) {
                 }
             }
 
+            SkTArray<SkString> statKeys;
+            SkTArray<double> statValues;
+            bench->getStats(&statKeys, &statValues);
+            SkASSERT(statKeys.count() == statValues.count());
+
 #if SK_SUPPORT_GPU
             SkTArray<SkString> keys;
             SkTArray<double> values;
@@ -1343,6 +1445,9 @@ int main(int argc, char** argv) {
             target->fillOptions(log.get());
             log->metric("min_ms",    stats.min);
             log->metrics("samples",    samples);
+            for (int j = 0; j < statKeys.count(); j++) {
+                log->metric(statKeys[j].c_str(), statValues[j]);
+            }
 #if SK_SUPPORT_GPU
             if (gpuStatsDump) {
                 // dump to json, only SKPBench currently returns valid keys / values
@@ -1403,12 +1508,37 @@ int main(int argc, char** argv) {
                         );
             }
 
+            for (int j = 0; j < statKeys.count(); j++) {
+                SkDebugf("%s:\t%g\t%s\t%s\n",
+                         statKeys[j].c_str(), statValues[j], config, bench->getUniqueName());
+            }
+
 #if SK_SUPPORT_GPU
             if (FLAGS_gpuStats && Benchmark::kGPU_Backend == configs[i].backend) {
                 target->dumpStats();
             }
 #endif
 
+            const SkPicture::Cost* cost = benchStream.currentPictureCost();
+            if (FLAGS_pictureCost && cost && cost->fPixels > 0) {
+                SkDebugf("cost:\t%.3gMpx\t%d ops\t%d layers\t%d blurs\t%d filters\t"
+                         "%d complex paths\t%d perspective\t%s\t%.3gns/px\t%s\t%s\n"
+                         , cost->fPixels * 1e-6
+                         , cost->fOps
+                         , cost->fSaveLayers
+                         , cost->fBlurMaskFilters
+                         , cost->fImageFilters
+                         , cost->fComplexPaths
+                         , cost->fPerspective
+                         , HUMANIZE(stats.median)
+                         , stats.median * 1e6 / cost->fPixels
+                         , config
+                         , bench->getUniqueName()
+                         );
+                costPixels.push_back(cost->fPixels);
+                costMs.push_back(stats.median);
+            }
+
             if (FLAGS_verbose) {
                 SkDebugf("Samples:  ");
                 for (int i = 0; i < samples.count(); i++) {
@@ -1420,6 +1550,25 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (FLAGS_pictureCost && costPixels.count() > 1) {
+        // How well does the estimated pixel count alone predict playback time?
+        const int n = costPixels.count();
+        double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+        for (int i = 0; i < n; i++) {
+            sx  += costPixels[i];
+            sy  += costMs[i];
+            sxx += costPixels[i] * costPixels[i];
+            syy += costMs[i] * costMs[i];
+            sxy += costPixels[i] * costMs[i];
+        }
+        const double cov  = n * sxy - sx * sy,
+                     varX = n * sxx - sx * sx,
+                     varY = n * syy - sy * sy;
+        SkDebugf("cost: %d pictures, %.3gns/px fit, correlation %.3f\n",
+                 n, varX > 0 ? cov / varX * 1e6 : 0.0,
+                 varX > 0 && varY > 0 ? cov / sqrt(varX * varY) : 0.0);
+    }
+
     SkGraphics::PurgeAllCaches();
 
     log->bench("memory_usage", 0,0);
@@ -13,12 +13,17 @@
 #include "SkDrawable.h"
 #include "SkMatrix.h"
 #include "SkRect.h"
+#include "SkTArray.h"
+#include "../private/SkMutex.h"
 
 class SkAndroidCodec;
+class SkExecutor;
 class SkPicture;
 
 /**
  *  Thread unsafe drawable for drawing animated images (e.g. GIF).
+ *
+ *  The only work done on other threads is decoding ahead (see setDecodeAhead).
  */
 class SK_API SkAnimatedImage : public SkDrawable {
 public:
@@ -97,6 +102,26 @@ public:
         return fRepetitionCount;
     }
 
+    /**
+     *  Keep up to budgetBytes worth of decoded frames, so that looping back or
+     *  showing a frame that was decoded ahead does not need to decode it (again).
+     *  Least recently shown frames are dropped first.
+     *
+     *  The default budget of 0 keeps only the frames needed to decode the next one.
+     */
+    void setFrameCacheBudget(size_t budgetBytes);
+
+    /**
+     *  Decode up to frameCount of the frames following the current one on executor,
+     *  so that decodeNextFrame can take them from the frame cache rather than
+     *  decode them itself.  The frame cache budget limits how many frames can be
+     *  kept ready.
+     *
+     *  Pass nullptr (the default) to stop decoding ahead.  Pending work holds a
+     *  ref on this image, and the executor must outlive it.
+     */
+    void setDecodeAhead(SkExecutor* executor, int frameCount);
+
 protected:
     SkRect onGetBounds() override;
     void onDraw(SkCanvas*) override;
@@ -111,6 +136,12 @@ private:
         bool copyTo(Frame*) const;
     };
 
+    struct CachedFrame {
+        Frame    fFrame;
+        int      fDuration;
+        uint32_t fLastUse;
+    };
+
     std::unique_ptr<SkAndroidCodec> fCodec;
     const SkISize                   fScaledSize;
     const SkImageInfo               fDecodeInfo;
@@ -127,6 +158,18 @@ private:
     int                             fRepetitionCount;
     int                             fRepetitionsCompleted;
 
+    // fCodecMutex is held while using fCodec, fCacheMutex while using the fields
+    // below it.  Never take fCodecMutex while holding fCacheMutex.
+    SkMutex                         fCodecMutex;
+    SkMutex                         fCacheMutex;
+    SkTArray<CachedFrame>           fFrameCache;
+    size_t                          fFrameCacheBytes;
+    size_t                          fFrameCacheBudget;
+    uint32_t                        fFrameCacheUses;
+    SkExecutor*                     fExecutor;
+    int                             fDecodeAheadCount;
+    bool                            fDecodeAheadPending;
+
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, SkISize scaledSize,
             SkImageInfo decodeInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess);
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>);
@@ -134,6 +177,16 @@ private:
     int computeNextFrame(int current, bool* animationEnded);
     double finish();
 
+    // Frame cache helpers, which take fCacheMutex.  The frames they return share
+    // pixels with the cache, and must be copied before being drawn into.
+    bool findCachedFrame(int index, CachedFrame* result);
+    bool findCachedPriorFrame(int requiredFrame, int index, Frame* result);
+    void addCachedFrame(Frame, int duration);
+    void purgeFrameCache(size_t budget);  // Requires fCacheMutex to be held.
+
+    void scheduleDecodeAhead();
+    void decodeAhead(int current);
+
     typedef SkDrawable INHERITED;
 };
 
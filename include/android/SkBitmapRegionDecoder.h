@@ -71,6 +71,19 @@ public:
     virtual sk_sp<SkColorSpace> computeOutputColorSpace(SkColorType outputColorType,
             sk_sp<SkColorSpace> prefColorSpace = nullptr) = 0;
 
+    /*
+     * Keep decoded tiles of the image in the global SkResourceCache, so that later calls to
+     * decodeRegion() that overlap earlier ones only decode the tiles that are missing (or
+     * were purged).  Cached tiles are freed when this object is destroyed.
+     *
+     * @param tileSize  Width and height of a tile, in pixels of the sampled output.  Tiles
+     *                  are aligned to the top left of the image.  Zero turns the cache off.
+     *
+     * Only regions whose left and top are multiples of sampleSize are served from the cache.
+     * Implementations that do not support caching ignore this.
+     */
+    virtual void setTileCacheSize(int /*tileSize*/) {}
+
 
     int width() const { return fWidth; }
     int height() const { return fHeight; }
@@ -188,11 +188,33 @@ public:
     //        called SkAndroidCodec.  On the other hand, it's may be a bit confusing to call
     //        these Options when SkCodec has a slightly different set of Options.  Maybe these
     //        should be DecodeOptions or SamplingOptions?
+    /**
+     *  How a sample size is implemented when the underlying codec cannot scale to it
+     *  natively.
+     */
+    enum class SampleFilter {
+        /**
+         *  Keep one pixel out of each sampleSize x sampleSize block.  This is the fastest,
+         *  but aliases badly.
+         */
+        kPoint,
+
+        /**
+         *  Average each sampleSize x sampleSize block as rows are decoded.
+         *
+         *  Only 8-bit color types are averaged; other color types are point sampled.
+         *  Codecs that cannot hand over rows as they are decoded (e.g. GIF) are decoded at
+         *  full size into temporary memory first.
+         */
+        kBox,
+    };
+
     struct AndroidOptions {
         AndroidOptions()
             : fZeroInitialized(SkCodec::kNo_ZeroInitialized)
             , fSubset(nullptr)
             , fSampleSize(1)
+            , fSampleFilter(SampleFilter::kPoint)
         {}
 
         /**
@@ -222,6 +244,13 @@ public:
          *  The default is 1, representing no downscaling.
          */
         int fSampleSize;
+
+        /**
+         *  How fSampleSize is implemented if the codec cannot scale natively.
+         *
+         *  The default is SampleFilter::kPoint.
+         */
+        SampleFilter fSampleFilter;
     };
 
     /**
@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -254,6 +255,7 @@ public:
             , fFrameIndex(0)
             , fPriorFrame(kNone)
             , fPremulBehavior(SkTransferFunctionBehavior::kRespect)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -305,6 +307,16 @@ public:
          *  we will always do a legacy premultiply.
          */
         SkTransferFunctionBehavior fPremulBehavior;
+
+        /**
+         *  If not NULL, getPixels() may split the decode into independent pieces and
+         *  run them on this executor.  It still returns only once the whole image has
+         *  been decoded.
+         *
+         *  Currently only used for baseline jpegs with restart markers, when the encoded
+         *  data is in memory.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -21,6 +21,8 @@ class GrContext;
 
 class SkCanvas;
 class SkImage;
+class SkLiteDL;
+class SkLiteRecorder;
 class SkSurface;
 
 /*
@@ -34,6 +36,10 @@ class SkSurface;
  * This class never accesses the GPU but performs all the cpu work it can. It
  * is thread-safe (i.e., one can break a scene into tiles and perform their cpu-side
  * work in parallel ahead of time).
+ *
+ * A raster SkSurfaceCharacterization works the same way: the draws are recorded into a
+ * display list, and detach() also decodes lazy images and rasterizes glyph masks the
+ * replay will need, so SkSurface::draw(SkDeferredDisplayList*) mostly just blits.
  */
 class SK_API SkDeferredDisplayListRecorder {
 public:
@@ -118,8 +124,15 @@ public:
 private:
     bool init();
 
+    SkCanvas* getRasterCanvas();
+    std::unique_ptr<SkDeferredDisplayList> detachRaster();
+
     const SkSurfaceCharacterization             fCharacterization;
 
+    // Used when recording for a raster surface.
+    std::unique_ptr<SkLiteDL>                   fRasterDL;
+    std::unique_ptr<SkLiteRecorder>             fRasterRecorder;
+
 #if SK_SUPPORT_GPU
     sk_sp<GrContext>                            fContext;
     sk_sp<SkDeferredDisplayList::LazyProxyData> fLazyProxyData;
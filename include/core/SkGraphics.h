@@ -126,6 +126,16 @@ public:
      */
     static void PurgeResourceCache();
 
+    /**
+     *  Raster canvases recycle the pixel buffers of their saveLayer()s.  These get/set how many
+     *  bytes of idle layer buffers all raster canvases together may hold on to, 16MB by default,
+     *  and return how many they hold now.  Lowering the limit frees idle buffers to fit, and 0
+     *  turns the recycling off.  PurgeAllCaches() frees all of them.
+     */
+    static size_t GetLayerPoolTotalByteLimit();
+    static size_t SetLayerPoolTotalByteLimit(size_t newLimit);
+    static size_t GetLayerPoolTotalBytesUsed();
+
     /**
      *  When the cachable entry is very lage (e.g. a large scaled bitmap), adding it to the cache
      *  can cause most/all of the existing entries to be purged. To avoid the, the client can set
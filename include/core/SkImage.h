@@ -22,6 +22,7 @@
 
 class SkData;
 class SkCanvas;
+class SkExecutor;
 class SkImageFilter;
 class SkImageGenerator;
 class SkPaint;
@@ -840,6 +841,43 @@ public:
     */
     bool isLazyGenerated() const;
 
+    /** \class SkImage::PrefetchHandle
+        Tracks a decode started by prefetchDecode(). Releasing the handle does not cancel
+        the decode.
+    */
+    class SK_API PrefetchHandle : public SkRefCnt {
+    public:
+        /** Skips the decode if it has not started yet. A decode that is already running
+            is allowed to finish.
+        */
+        virtual void cancel() = 0;
+
+        /** Returns true once the decode has finished, failed, or been canceled.
+
+            @return  true if the decode will not run any more
+        */
+        virtual bool isDone() const = 0;
+
+        /** Blocks until isDone() returns true.
+        */
+        virtual void wait() = 0;
+    };
+
+    /** Starts decoding a lazy image into the image cache on executor, so that drawing it
+        later to a surface in dstColorSpace does not have to decode it first. A draw that needs
+        the pixels while the decode is running waits for it, rather than decoding again.
+
+        The decoded pixels are subject to the image cache budget like any others, so this is
+        only useful shortly before the image is drawn.
+
+        Returns nullptr if SkImage is not lazy generated, or its pixels are already cached.
+
+        @param executor       runs the decode
+        @param dstColorSpace  SkColorSpace of the surface SkImage will be drawn to; may be nullptr
+        @return               handle to the pending decode, or nullptr
+    */
+    sk_sp<PrefetchHandle> prefetchDecode(SkExecutor& executor, SkColorSpace* dstColorSpace) const;
+
     /** Creates SkImage in target SkColorSpace.
         Returns nullptr if SkImage could not be created.
 
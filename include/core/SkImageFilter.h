@@ -21,6 +21,7 @@ class GrContext;
 class GrFragmentProcessor;
 class SkColorFilter;
 class SkColorSpaceXformer;
+class SkExecutor;
 struct SkIPoint;
 class SkSpecialImage;
 class SkImageFilterCache;
@@ -54,11 +55,12 @@ public:
     class Context {
     public:
         Context(const SkMatrix& ctm, const SkIRect& clipBounds, SkImageFilterCache* cache,
-                const OutputProperties& outputProperties)
+                const OutputProperties& outputProperties, SkExecutor* executor = nullptr)
             : fCTM(ctm)
             , fClipBounds(clipBounds)
             , fCache(cache)
             , fOutputProperties(outputProperties)
+            , fExecutor(executor)
         {}
 
         const SkMatrix& ctm() const { return fCTM; }
@@ -66,6 +68,12 @@ public:
         SkImageFilterCache* cache() const { return fCache; }
         const OutputProperties& outputProperties() const { return fOutputProperties; }
 
+        /**
+         *  Filters may split large raster work into tasks on this executor.
+         *  If nullptr, they use SkExecutor::GetDefault().
+         */
+        SkExecutor* executor() const { return fExecutor; }
+
         /**
          *  Since a context can be build directly, its constructor has no chance to
          *  "return null" if it's given invalid or unsupported inputs. Call this to
@@ -81,6 +89,7 @@ public:
         SkIRect                fClipBounds;
         SkImageFilterCache*    fCache;
         OutputProperties       fOutputProperties;
+        SkExecutor*            fExecutor;
     };
 
     class CropRect {
@@ -242,6 +251,14 @@ public:
      */
     bool canHandleComplexCTM() const;
 
+    /**
+     *  Raster devices may evaluate a large filter one tile of its output at a time, by calling
+     *  filterImage() with each tile as the clip bounds. This call returns true iff the filter and
+     *  all of its (non-null) inputs produce the same pixels within a tile as they would when
+     *  evaluated over the whole output.
+     */
+    bool canFilterInTiles() const;
+
     /**
      * Return an imagefilter which transforms its input by the given matrix.
      */
@@ -393,6 +410,14 @@ protected:
      */
     virtual bool onCanHandleComplexCTM() const { return false; }
 
+    /**
+     *  Override this to return true if your subclass only reads the input pixels that
+     *  onFilterNodeBounds(kReverse_MapDirection) asks for, and uses the clip bounds only to limit
+     *  the pixels it writes, never to decide their values (e.g. by treating the edge of the clip
+     *  as the edge of the image). The caller will take care of calling your inputs.
+     */
+    virtual bool onCanFilterInTiles() const { return false; }
+
     /** Given a "srcBounds" rect, computes destination bounds for this filter.
      *  "dstBounds" are computed by transforming the crop rect by the context's
      *  CTM, applying it to the initial bounds, and intersecting the result with
@@ -47,6 +47,10 @@ public:
      *  Perform all the previously added draws. This will reset the state
      *  of this object. If flush is true, all canvases are flushed after
      *  draw.
+     *
+     *  Raster canvases backed by distinct pixel memory are drawn concurrently on
+     *  SkExecutor::GetDefault(). Pairs that share a target are drawn in the order
+     *  they were added.
      */
     void draw(bool flush = false);
 
@@ -113,6 +113,25 @@ public:
     /** Returns the approximate byte size of this picture, not including large ref'd objects. */
     virtual size_t approximateBytesUsed() const = 0;
 
+    /** A rough model of how expensive this picture is to rasterize.  Pixel counts are in
+     *  picture space and include overdraw; the remaining fields count features that are
+     *  known to be slow to draw in software regardless of their area.
+     */
+    struct Cost {
+        double fPixels          = 0;  // Sum of the bounds areas touched by each drawing op.
+        int    fOps             = 0;  // Drawing ops (including saveLayer composites).
+        int    fSaveLayers      = 0;
+        int    fBlurMaskFilters = 0;
+        int    fImageFilters    = 0;  // Includes saveLayer backdrops.
+        int    fComplexPaths    = 0;  // Concave paths drawn or clipped to, and path effects.
+        int    fPerspective     = 0;  // Drawing ops with a perspective matrix.
+    };
+
+    /** Return the approximate cost of drawing the parts of this picture that intersect region,
+     *  in picture coordinates.  Pass cullRect() to estimate the cost of the whole picture.
+     */
+    virtual Cost approximateCost(const SkRect& region) const;
+
     // Returns NULL if this is not an SkBigPicture.
     virtual const SkBigPicture* asSkBigPicture() const { return nullptr; }
 
@@ -690,7 +690,8 @@ public:
         into multiple tiles. DeferredDisplayListRecorder records the drawing commands
         for each tile.
 
-        Return true if SkSurface supports characterization. raster surface returns false.
+        Return true if SkSurface supports characterization. Raster surfaces record into a
+        display list that is replayed by draw(SkDeferredDisplayList*).
 
         @param characterization  properties for parallel drawing
         @return                  true if supported
@@ -701,8 +702,6 @@ public:
         Has no effect and returns false if SkSurfaceCharacterization stored in
         deferredDisplayList is not compatible with SkSurface.
 
-        raster surface returns false.
-
         @param deferredDisplayList  drawing commands
         @return                     false if deferredDisplayList is not compatible
     */
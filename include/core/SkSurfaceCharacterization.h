@@ -11,9 +11,12 @@
 #include "GrTypes.h"
 
 #include "SkColorSpace.h"
+#include "SkImageInfo.h"
 #include "SkRefCnt.h"
 #include "SkSurfaceProps.h"
 
+#include <new>
+
 class SkColorSpace;
 
 #if SK_SUPPORT_GPU
@@ -25,6 +28,9 @@ class SkColorSpace;
     data and pass it on to the SkDeferredDisplayList if/when it is created. Note that both of
     those objects (the Recorder and the DisplayList) will take a ref on the
     GrContextThreadSafeProxy and SkColorSpace objects.
+
+    A characterization of a raster surface has no GrContextThreadSafeProxy; only its image info
+    and surface props are meaningful.
 */
 class SK_API SkSurfaceCharacterization {
 public:
@@ -61,6 +67,7 @@ public:
     size_t cacheMaxResourceBytes() const { return fCacheMaxResourceBytes; }
 
     bool isValid() const { return kUnknown_SkColorType != fImageInfo.colorType(); }
+    bool isRaster() const { return this->isValid() && !fContextInfo; }
 
     const SkImageInfo& imageInfo() const { return fImageInfo; }
     GrSurfaceOrigin origin() const { return fOrigin; }
@@ -78,6 +85,7 @@ public:
 
 private:
     friend class SkSurface_Gpu; // for 'set' & 'config'
+    friend class SkSurface_Raster; // for 'setRaster'
     friend class GrContextThreadSafeProxy; // for private ctor
     friend class SkDeferredDisplayListRecorder; // for 'config'
     friend class SkSurface; // for 'config'
@@ -134,6 +142,22 @@ private:
         fSurfaceProps = surfaceProps;
     }
 
+    void setRaster(const SkImageInfo& ii, const SkSurfaceProps& surfaceProps) {
+        fContextInfo.reset();
+        fCacheMaxResourceBytes = 0;
+        fImageInfo = ii;
+        fOrigin = kTopLeft_GrSurfaceOrigin;
+        fConfig = kUnknown_GrPixelConfig;
+        fFSAAType = GrFSAAType::kNone;
+        fStencilCnt = 0;
+        fIsTextureable = Textureable::kNo;
+        fIsMipMapped = MipMapped::kNo;
+        fUsesGLFBO0 = UsesGLFBO0::kNo;
+        // SkSurfaceProps has no assignment of its own; it is trivially destructible, so copy
+        // construct it in place.
+        new (&fSurfaceProps) SkSurfaceProps(surfaceProps);
+    }
+
     sk_sp<GrContextThreadSafeProxy> fContextInfo;
     size_t                          fCacheMaxResourceBytes;
 
@@ -150,34 +174,44 @@ private:
 
 #else// !SK_SUPPORT_GPU
 
+// Without a GPU backend, only raster surfaces can be characterized.
 class SK_API SkSurfaceCharacterization {
 public:
     SkSurfaceCharacterization() : fSurfaceProps(0, kUnknown_SkPixelGeometry) { }
 
-    SkSurfaceCharacterization createResized(int width, int height) const {
-        return *this;
-    }
+    SkSurfaceCharacterization createResized(int width, int height) const;
 
-    bool operator==(const SkSurfaceCharacterization& other) const { return false; }
+    bool operator==(const SkSurfaceCharacterization& other) const;
     bool operator!=(const SkSurfaceCharacterization& other) const {
         return !(*this == other);
     }
 
     size_t cacheMaxResourceBytes() const { return 0; }
 
-    bool isValid() const { return false; }
+    bool isValid() const { return kUnknown_SkColorType != fImageInfo.colorType(); }
+    bool isRaster() const { return this->isValid(); }
 
-    int width() const { return 0; }
-    int height() const { return 0; }
+    const SkImageInfo& imageInfo() const { return fImageInfo; }
+    int width() const { return fImageInfo.width(); }
+    int height() const { return fImageInfo.height(); }
+    SkColorType colorType() const { return fImageInfo.colorType(); }
     int stencilCount() const { return 0; }
     bool isTextureable() const { return false; }
     bool isMipMapped() const { return false; }
     bool usesGLFBO0() const { return false; }
-    SkColorSpace* colorSpace() const { return nullptr; }
-    sk_sp<SkColorSpace> refColorSpace() const { return nullptr; }
+    SkColorSpace* colorSpace() const { return fImageInfo.colorSpace(); }
+    sk_sp<SkColorSpace> refColorSpace() const { return fImageInfo.refColorSpace(); }
     const SkSurfaceProps& surfaceProps()const { return fSurfaceProps; }
 
 private:
+    friend class SkSurface_Raster; // for 'setRaster'
+
+    void setRaster(const SkImageInfo& ii, const SkSurfaceProps& surfaceProps) {
+        fImageInfo = ii;
+        new (&fSurfaceProps) SkSurfaceProps(surfaceProps);  // It has no assignment of its own.
+    }
+
+    SkImageInfo    fImageInfo;
     SkSurfaceProps fSurfaceProps;
 };
 
@@ -30,6 +30,7 @@ protected:
     sk_sp<SkImageFilter> onMakeColorSpace(SkColorSpaceXformer*) const override;
     bool onIsColorFilterNode(SkColorFilter**) const override;
     bool onCanHandleComplexCTM() const override { return true; }
+    bool onCanFilterInTiles() const override { return true; }
     bool affectsTransparentBlack() const override;
 
 private:
@@ -97,6 +97,8 @@ private:
 
     SkISize   fKernelSize;
     SkScalar* fKernel;
+    SkScalar* fSeparableKernel;  // Row weights, column weights and divisor if fKernel is
+                                 // separable, or nullptr.
     SkScalar  fGain;
     SkScalar  fBias;
     SkIPoint  fKernelOffset;
@@ -119,7 +121,8 @@ private:
                               SkBitmap* result,
                               SkIVector& offset,
                               const SkIRect& rect,
-                              const SkIRect& bounds) const;
+                              const SkIRect& bounds,
+                              const Context& ctx) const;
     void filterBorderPixels(const SkBitmap& src,
                             SkBitmap* result,
                             SkIVector& offset,
@@ -35,6 +35,7 @@ protected:
                                         SkIPoint* offset) const override;
     sk_sp<SkImageFilter> onMakeColorSpace(SkColorSpaceXformer*) const override;
     bool onCanHandleComplexCTM() const override { return true; }
+    bool onCanFilterInTiles() const override { return true; }
 
 private:
     SkMergeImageFilter(sk_sp<SkImageFilter>* const filters, int count, const CropRect* cropRect);
@@ -46,6 +46,7 @@ protected:
                                         SkIPoint* offset) const override;
     sk_sp<SkImageFilter> onMakeColorSpace(SkColorSpaceXformer*) const override;
     void flatten(SkWriteBuffer&) const override;
+    bool onCanFilterInTiles() const override { return true; }
 
     SkISize radius() const { return fRadius; }
 
@@ -9,7 +9,9 @@
 #define SkJpegEncoder_DEFINED
 
 #include "SkEncoder.h"
+#include "SkYUVSizeInfo.h"
 
+class SkColorSpace;
 class SkJpegEncoderMgr;
 class SkWStream;
 
@@ -83,6 +85,25 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Encode the Y, U and V |planes| to the |dst| stream as they are, without converting them
+     *  to RGB and back.  The sizes and widthBytes of the planes are described by |sizeInfo|,
+     *  as returned by SkCodec::queryYUV8().
+     *
+     *  The chroma subsampling is determined by the sizes of the planes, so
+     *  |options.fDownsample| is ignored.  Each of U and V may be half the width and/or half
+     *  the height of Y, rounded up.
+     *
+     *  If |colorSpace| is not null, it is written to the jpeg as an ICC profile, as Encode()
+     *  does for a tagged SkPixmap.
+     *
+     *  Returns false if the sizes are unsupported, or if |yuvColorSpace| is not
+     *  kJPEG_SkYUVColorSpace, since that is the only one a jpeg can hold.
+     */
+    static bool EncodeYUV(SkWStream* dst, const SkYUVSizeInfo& sizeInfo,
+                          const void* const planes[3], SkYUVColorSpace yuvColorSpace,
+                          SkColorSpace* colorSpace, const Options& options);
+
     ~SkJpegEncoder() override;
 
 protected:
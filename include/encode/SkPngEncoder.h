@@ -11,6 +11,7 @@
 #include "SkEncoder.h"
 #include "SkDataTable.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -66,6 +67,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If not NULL, rows are filtered and compressed in independent bands on this executor.
+         *  Each band is deflated on its own, primed with the tail of the band before it, so the
+         *  image data is still a single zlib stream and the file grows only slightly.
+         *
+         *  The result is a valid png with the same pixels, but it is not byte for byte the same
+         *  as a serial encode.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
@@ -14,11 +14,15 @@
 #include "GrOpList.h"
 #endif
 
+#include <memory>
+
+class SkLiteDL;
 class SkSurface;
 
 /*
  * This class contains pre-processed gpu operations that can be replayed into
- * an SkSurface via draw(SkDeferredDisplayList*).
+ * an SkSurface via draw(SkDeferredDisplayList*). For a raster characterization it holds
+ * a recorded display list instead.
  *
  * TODO: we probably need to expose this class so users can query it for memory usage.
  */
@@ -42,6 +46,9 @@ public:
 
     SkDeferredDisplayList(const SkSurfaceCharacterization& characterization,
                           sk_sp<LazyProxyData>);
+    SkDeferredDisplayList(const SkSurfaceCharacterization& characterization,
+                          std::unique_ptr<SkLiteDL>);
+    ~SkDeferredDisplayList();
 
     const SkSurfaceCharacterization& characterization() const {
         return fCharacterization;
@@ -50,6 +57,7 @@ public:
 private:
     friend class GrDrawingManager; // for access to 'fOpLists' and 'fLazyProxyData'
     friend class SkDeferredDisplayListRecorder; // for access to 'fLazyProxyData'
+    friend class SkSurface_Raster; // for access to 'fRasterDL'
 
     const SkSurfaceCharacterization fCharacterization;
 
@@ -57,6 +65,7 @@ private:
     SkTArray<sk_sp<GrOpList>>    fOpLists;
 #endif
     sk_sp<LazyProxyData>         fLazyProxyData;
+    std::unique_ptr<SkLiteDL>    fRasterDL;
 };
 
 #endif
@@ -10,6 +10,7 @@
 #include "SkCanvas.h"
 #include "SkCodec.h"
 #include "SkCodecPriv.h"
+#include "SkExecutor.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 
@@ -71,6 +72,12 @@ SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec, SkISize
     , fFinished(false)
     , fRepetitionCount(fCodec->codec()->getRepetitionCount())
     , fRepetitionsCompleted(0)
+    , fFrameCacheBytes(0)
+    , fFrameCacheBudget(0)
+    , fFrameCacheUses(0)
+    , fExecutor(nullptr)
+    , fDecodeAheadCount(0)
+    , fDecodeAheadPending(false)
 {
     if (!fActiveFrame.fBitmap.tryAllocPixels(fDecodeInfo)) {
         return;
@@ -162,6 +169,28 @@ int SkAnimatedImage::decodeNextFrame() {
     bool animationEnded = false;
     int frameToDecode = this->computeNextFrame(fActiveFrame.fIndex, &animationEnded);
 
+    CachedFrame cached;
+    if (fFrameCount > 1 && frameToDecode != fActiveFrame.fIndex
+            && frameToDecode != fRestoreFrame.fIndex
+            && this->findCachedFrame(frameToDecode, &cached)) {
+        if (is_restore_previous(cached.fFrame.fDisposalMethod)
+                && fActiveFrame.fIndex != SkCodec::kNone
+                && !is_restore_previous(fActiveFrame.fDisposalMethod)) {
+            // As below, keep the active frame around for the frames after this one.
+            SkTSwap(fActiveFrame, fRestoreFrame);
+        }
+        if (!cached.fFrame.copyTo(&fActiveFrame)) {
+            return this->finish();
+        }
+        fCurrentFrameDuration = cached.fDuration;
+        this->scheduleDecodeAhead();
+        if (animationEnded) {
+            return this->finish();
+        }
+        return fCurrentFrameDuration;
+    }
+
+    SkAutoMutexAcquire lock(fCodecMutex);
     SkCodec::FrameInfo frameInfo;
     if (fCodec->codec()->getFrameInfo(frameToDecode, &frameInfo)) {
         if (!frameInfo.fFullyReceived) {
@@ -197,6 +226,7 @@ int SkAnimatedImage::decodeNextFrame() {
 
     if (frameToDecode == fRestoreFrame.fIndex) {
         SkTSwap(fActiveFrame, fRestoreFrame);
+        this->scheduleDecodeAhead();
         if (animationEnded) {
             return this->finish();
         }
@@ -244,6 +274,20 @@ int SkAnimatedImage::decodeNextFrame() {
                 return this->finish();
             }
             options.fPriorFrame = fActiveFrame.fIndex;
+        } else {
+            // Rather than decoding all the way from the required frame, start from the
+            // latest frame in the cache that this one can be drawn on top of.
+            Frame prior;
+            if (this->findCachedPriorFrame(frameInfo.fRequiredFrame, frameToDecode, &prior)) {
+                if (is_restore_previous(frameInfo.fDisposalMethod)
+                        && fActiveFrame.fIndex != SkCodec::kNone
+                        && !is_restore_previous(fActiveFrame.fDisposalMethod)) {
+                    SkTSwap(fActiveFrame, fRestoreFrame);
+                }
+                if (prior.copyTo(&fActiveFrame)) {
+                    options.fPriorFrame = fActiveFrame.fIndex;
+                }
+            }
         }
     }
 
@@ -269,12 +313,170 @@ int SkAnimatedImage::decodeNextFrame() {
     fActiveFrame.fIndex = frameToDecode;
     fActiveFrame.fDisposalMethod = frameInfo.fDisposalMethod;
 
+    if (fFrameCount > 1) {
+        Frame copy;
+        if (fFrameCacheBudget > 0 && fActiveFrame.copyTo(&copy)) {
+            this->addCachedFrame(std::move(copy), frameInfo.fDuration);
+        }
+        this->scheduleDecodeAhead();
+    }
+
     if (animationEnded) {
         return this->finish();
     }
     return fCurrentFrameDuration;
 }
 
+void SkAnimatedImage::setFrameCacheBudget(size_t budgetBytes) {
+    SkAutoMutexAcquire lock(fCacheMutex);
+    fFrameCacheBudget = budgetBytes;
+    this->purgeFrameCache(budgetBytes);
+}
+
+void SkAnimatedImage::setDecodeAhead(SkExecutor* executor, int frameCount) {
+    {
+        SkAutoMutexAcquire lock(fCacheMutex);
+        fExecutor = executor;
+        fDecodeAheadCount = frameCount;
+    }
+    this->scheduleDecodeAhead();
+}
+
+bool SkAnimatedImage::findCachedFrame(int index, CachedFrame* result) {
+    SkAutoMutexAcquire lock(fCacheMutex);
+    for (CachedFrame& cached : fFrameCache) {
+        if (cached.fFrame.fIndex == index) {
+            cached.fLastUse = ++fFrameCacheUses;
+            *result = cached;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SkAnimatedImage::findCachedPriorFrame(int requiredFrame, int index, Frame* result) {
+    SkAutoMutexAcquire lock(fCacheMutex);
+    const CachedFrame* best = nullptr;
+    for (const CachedFrame& cached : fFrameCache) {
+        const Frame& frame = cached.fFrame;
+        if (frame.fIndex >= requiredFrame && frame.fIndex < index
+                && !is_restore_previous(frame.fDisposalMethod)
+                && (!best || frame.fIndex > best->fFrame.fIndex)) {
+            best = &cached;
+        }
+    }
+    if (!best) {
+        return false;
+    }
+    *result = best->fFrame;
+    return true;
+}
+
+void SkAnimatedImage::addCachedFrame(Frame frame, int duration) {
+    const size_t bytes = frame.fBitmap.computeByteSize();
+    SkAutoMutexAcquire lock(fCacheMutex);
+    if (bytes > fFrameCacheBudget) {
+        return;
+    }
+    for (const CachedFrame& cached : fFrameCache) {
+        if (cached.fFrame.fIndex == frame.fIndex) {
+            return;
+        }
+    }
+    this->purgeFrameCache(fFrameCacheBudget - bytes);
+
+    CachedFrame& cached = fFrameCache.push_back();
+    cached.fFrame = std::move(frame);
+    cached.fDuration = duration;
+    cached.fLastUse = ++fFrameCacheUses;
+    fFrameCacheBytes += bytes;
+}
+
+void SkAnimatedImage::purgeFrameCache(size_t budget) {
+    fCacheMutex.assertHeld();
+    while (fFrameCacheBytes > budget) {
+        int oldest = 0;
+        for (int i = 1; i < fFrameCache.count(); i++) {
+            if (fFrameCache[i].fLastUse < fFrameCache[oldest].fLastUse) {
+                oldest = i;
+            }
+        }
+        fFrameCacheBytes -= fFrameCache[oldest].fFrame.fBitmap.computeByteSize();
+        fFrameCache.removeShuffle(oldest);
+    }
+}
+
+void SkAnimatedImage::scheduleDecodeAhead() {
+    SkExecutor* executor;
+    {
+        SkAutoMutexAcquire lock(fCacheMutex);
+        if (!fExecutor || fDecodeAheadCount < 1 || fDecodeAheadPending || fFrameCount < 2
+                || fActiveFrame.fIndex == SkCodec::kNone) {
+            return;
+        }
+        fDecodeAheadPending = true;
+        executor = fExecutor;
+    }
+
+    sk_sp<SkAnimatedImage> self = sk_ref_sp(this);
+    const int current = fActiveFrame.fIndex;
+    executor->add([self, current] { self->decodeAhead(current); });
+}
+
+void SkAnimatedImage::decodeAhead(int current) {
+    int count;
+    {
+        SkAutoMutexAcquire lock(fCacheMutex);
+        // Leave room in the cache for the frame being shown.
+        const size_t frameBytes = fDecodeInfo.computeMinByteSize();
+        const size_t cacheFrames = frameBytes ? fFrameCacheBudget / frameBytes : 0;
+        count = (int) SkTMin<size_t>(fDecodeAheadCount, cacheFrames > 0 ? cacheFrames - 1 : 0);
+    }
+
+    int index = current;
+    for (int i = 0; i < count; i++) {
+        index = index + 1 == fFrameCount ? 0 : index + 1;
+        CachedFrame cached;
+        if (index == current || this->findCachedFrame(index, &cached)) {
+            continue;
+        }
+
+        SkAutoMutexAcquire lock(fCodecMutex);
+        SkCodec::FrameInfo frameInfo;
+        if (!fCodec->codec()->getFrameInfo(index, &frameInfo) || !frameInfo.fFullyReceived) {
+            break;
+        }
+
+        auto alphaType = kOpaque_SkAlphaType == frameInfo.fAlphaType ?
+                         kOpaque_SkAlphaType : kPremul_SkAlphaType;
+        SkCodec::Options options;
+        options.fFrameIndex = index;
+        Frame frame, prior;
+        if (frameInfo.fRequiredFrame != SkCodec::kNone
+                && this->findCachedPriorFrame(frameInfo.fRequiredFrame, index, &prior)
+                && prior.copyTo(&frame)) {
+            SkAssertResult(frame.fBitmap.setAlphaType(alphaType));
+            options.fPriorFrame = prior.fIndex;
+        } else if (!frame.fBitmap.tryAllocPixels(fDecodeInfo.makeAlphaType(alphaType))) {
+            break;
+        }
+
+        const SkBitmap& dst = frame.fBitmap;
+        auto result = fCodec->codec()->getPixels(dst.info(), dst.getPixels(), dst.rowBytes(),
+                                                 &options);
+        if (result != SkCodec::kSuccess) {
+            SkCodecPrintf("error %i decoding ahead to frame %i\n", result, index);
+            break;
+        }
+        frame.fIndex = index;
+        frame.fDisposalMethod = frameInfo.fDisposalMethod;
+        this->addCachedFrame(std::move(frame), frameInfo.fDuration);
+    }
+
+    SkAutoMutexAcquire lock(fCacheMutex);
+    fDecodeAheadPending = false;
+}
+
 void SkAnimatedImage::onDraw(SkCanvas* canvas) {
     if (fSimple) {
         canvas->drawBitmap(fActiveFrame.fBitmap, 0, 0);
@@ -6,16 +6,177 @@
  */
 
 #include "SkAndroidCodec.h"
+#include "SkBitmapCache.h"
 #include "SkBitmapRegionCodec.h"
 #include "SkBitmapRegionDecoderPriv.h"
+#include "SkCachedData.h"
 #include "SkCodecPriv.h"
+#include "SkConvertPixels.h"
+#include "SkNextID.h"
 #include "SkPixelRef.h"
+#include "SkResourceCache.h"
+
+namespace {
+static unsigned gRegionTileKeyNamespaceLabel;
+
+struct RegionTileKey : public SkResourceCache::Key {
+    RegionTileKey(uint32_t uniqueID, int tileX, int tileY, int sampleSize,
+                  const SkImageInfo& info)
+        : fUniqueID(uniqueID)
+        , fTileX(tileX)
+        , fTileY(tileY)
+        , fSampleSize(sampleSize)
+        , fColorType(info.colorType())
+        , fAlphaType(info.alphaType())
+        , fColorSpaceHash(info.colorSpace() ? info.colorSpace()->toXYZD50Hash() : 0)
+    {
+        this->init(&gRegionTileKeyNamespaceLabel, SkMakeResourceCacheSharedIDForBitmap(uniqueID),
+                   sizeof(fUniqueID) + sizeof(fTileX) + sizeof(fTileY) + sizeof(fSampleSize) +
+                   sizeof(fColorType) + sizeof(fAlphaType) + sizeof(fColorSpaceHash));
+    }
+
+    uint32_t fUniqueID;
+    int32_t  fTileX;
+    int32_t  fTileY;
+    int32_t  fSampleSize;
+    int32_t  fColorType;
+    int32_t  fAlphaType;
+    uint32_t fColorSpaceHash;
+};
+
+struct RegionTileValue {
+    SkImageInfo   fInfo;
+    SkCachedData* fData;
+};
+
+struct RegionTileRec : public SkResourceCache::Rec {
+    RegionTileRec(const RegionTileKey& key, SkCachedData* data, const SkImageInfo& info)
+        : fKey(key)
+    {
+        fValue.fData = data;
+        fValue.fInfo = info;
+        fValue.fData->attachToCacheAndRef();
+    }
+    ~RegionTileRec() override {
+        fValue.fData->detachFromCacheAndUnref();
+    }
+
+    RegionTileKey   fKey;
+    RegionTileValue fValue;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fValue.fData->size(); }
+    const char* getCategory() const override { return "region-tile"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override {
+        return fValue.fData->diagnostic_only_getDiscardable();
+    }
+
+    // The key only holds a hash of the color space, so check that it really matches.
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const RegionTileRec& rec = static_cast<const RegionTileRec&>(baseRec);
+        RegionTileValue* result = static_cast<RegionTileValue*>(contextData);
+        if (!SkColorSpace::Equals(rec.fValue.fInfo.colorSpace(), result->fInfo.colorSpace())) {
+            return false;
+        }
+
+        SkCachedData* tmpData = rec.fValue.fData;
+        tmpData->ref();
+        if (nullptr == tmpData->data()) {
+            tmpData->unref();
+            return false;
+        }
+        result->fData = tmpData;
+        result->fInfo = rec.fValue.fInfo;
+        return true;
+    }
+};
+} // namespace
 
 SkBitmapRegionCodec::SkBitmapRegionCodec(SkAndroidCodec* codec)
     : INHERITED(codec->getInfo().width(), codec->getInfo().height())
     , fCodec(codec)
+    , fUniqueID(SkNextID::ImageID())
+    , fTileSize(0)
+    , fAddedTiles(false)
 {}
 
+SkBitmapRegionCodec::~SkBitmapRegionCodec() {
+    if (fAddedTiles) {
+        SkResourceCache::PostPurgeSharedID(SkMakeResourceCacheSharedIDForBitmap(fUniqueID));
+    }
+}
+
+bool SkBitmapRegionCodec::decodeTiles(const SkImageInfo& decodeInfo, const SkIRect& subset,
+                                      int sampleSize, SkBitmap* dst, int dstX, int dstY) {
+    SkASSERT(fTileSize > 0);
+    SkASSERT(0 == subset.x() % sampleSize && 0 == subset.y() % sampleSize);
+
+    // The requested region and the tiles, in the coordinates of the whole scaled image.
+    const SkIRect region = SkIRect::MakeXYWH(subset.x() / sampleSize, subset.y() / sampleSize,
+                                             decodeInfo.width(), decodeInfo.height());
+    const SkIRect imageBounds = SkIRect::MakeSize(fCodec->getInfo().dimensions());
+    const int tileSpan = fTileSize * sampleSize;
+    const size_t bpp = decodeInfo.bytesPerPixel();
+
+    for (int ty = region.top() / fTileSize; ty <= (region.bottom() - 1) / fTileSize; ty++) {
+        for (int tx = region.left() / fTileSize; tx <= (region.right() - 1) / fTileSize; tx++) {
+            RegionTileKey key(fUniqueID, tx, ty, sampleSize, decodeInfo);
+            RegionTileValue tile;
+            tile.fInfo = decodeInfo;
+            tile.fData = nullptr;
+            if (!SkResourceCache::Find(key, RegionTileRec::Visitor, &tile)) {
+                SkIRect tileSubset = SkIRect::MakeXYWH(tx * tileSpan, ty * tileSpan,
+                                                       tileSpan, tileSpan);
+                if (!tileSubset.intersect(imageBounds)) {
+                    return false;
+                }
+                SkIRect supported = tileSubset;
+                if (!fCodec->getSupportedSubset(&supported) || supported != tileSubset) {
+                    return false;
+                }
+
+                const SkISize tileSize = fCodec->getSampledSubsetDimensions(sampleSize,
+                                                                            tileSubset);
+                tile.fInfo = decodeInfo.makeWH(tileSize.width(), tileSize.height());
+                tile.fData = SkResourceCache::NewCachedData(tile.fInfo.computeMinByteSize());
+                if (!tile.fData) {
+                    return false;
+                }
+
+                SkAndroidCodec::AndroidOptions options;
+                options.fSampleSize = sampleSize;
+                options.fSubset = &tileSubset;
+                const SkCodec::Result result = fCodec->getAndroidPixels(tile.fInfo,
+                        tile.fData->writable_data(), tile.fInfo.minRowBytes(), &options);
+                if (SkCodec::kSuccess == result) {
+                    SkResourceCache::Add(new RegionTileRec(key, tile.fData, tile.fInfo));
+                    fAddedTiles = true;
+                } else if (SkCodec::kIncompleteInput != result) {
+                    tile.fData->unref();
+                    return false;
+                }
+            }
+
+            // Copy the part of the tile that overlaps the region.
+            const SkIRect tileRect = SkIRect::MakeXYWH(tx * fTileSize, ty * fTileSize,
+                                                       tile.fInfo.width(), tile.fInfo.height());
+            SkIRect overlap;
+            if (overlap.intersect(tileRect, region)) {
+                const size_t tileRowBytes = tile.fInfo.minRowBytes();
+                const char* src = static_cast<const char*>(tile.fData->data()) +
+                                  (overlap.top() - tileRect.top()) * tileRowBytes +
+                                  (overlap.left() - tileRect.left()) * bpp;
+                SkRectMemcpy(dst->getAddr(dstX + overlap.left() - region.left(),
+                                          dstY + overlap.top() - region.top()),
+                             dst->rowBytes(), src, tileRowBytes, overlap.width() * bpp,
+                             overlap.height());
+            }
+            tile.fData->unref();
+        }
+    }
+    return true;
+}
+
 bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocator,
         const SkIRect& desiredSubset, int sampleSize, SkColorType dstColorType,
         bool requireUnpremul, sk_sp<SkColorSpace> dstColorSpace) {
@@ -97,6 +258,16 @@ bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocat
         memset(pixels, 0, bytes);
     }
 
+    // Assemble the region from cached tiles if we can.  Tiles that were purged or never
+    // decoded are decoded now and added to the cache.
+    if (fTileSize > 0 && 0 == subset.x() % sampleSize && 0 == subset.y() % sampleSize &&
+            !decodeInfo.isEmpty()) {
+        if (this->decodeTiles(decodeInfo, subset, sampleSize, bitmap, scaledOutX, scaledOutY)) {
+            return true;
+        }
+        SkCodecPrintf("Warning: Could not decode from tiles.\n");
+    }
+
     // Decode into the destination bitmap
     SkAndroidCodec::AndroidOptions options;
     options.fSampleSize = sampleSize;
@@ -23,6 +23,8 @@ public:
      */
     SkBitmapRegionCodec(SkAndroidCodec* codec);
 
+    ~SkBitmapRegionCodec() override;
+
     bool decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocator,
                       const SkIRect& desiredSubset, int sampleSize,
                       SkColorType colorType, bool requireUnpremul,
@@ -39,9 +41,21 @@ public:
         return fCodec->computeOutputColorSpace(outputColorType, prefColorSpace);
     }
 
+    void setTileCacheSize(int tileSize) override { fTileSize = SkTMax(0, tileSize); }
+
 private:
 
+    /*
+     * Fill the decodeInfo sized rect of dst at (dstX, dstY) with the region of the image
+     * starting at subset's top left, scaled by sampleSize, using cached tiles where we can.
+     */
+    bool decodeTiles(const SkImageInfo& decodeInfo, const SkIRect& subset, int sampleSize,
+                     SkBitmap* dst, int dstX, int dstY);
+
     std::unique_ptr<SkAndroidCodec> fCodec;
+    const uint32_t                  fUniqueID;
+    int                             fTileSize;
+    bool                            fAddedTiles;
 
     typedef SkBitmapRegionDecoder INHERITED;
 
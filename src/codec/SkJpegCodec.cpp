@@ -12,10 +12,14 @@
 #include "SkColorData.h"
 #include "SkJpegDecoderMgr.h"
 #include "SkJpegInfo.h"
+#include "SkJpegRestartIndex.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTypes.h"
 
+#include <atomic>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "SkJpegUtility.h"
@@ -306,8 +310,13 @@ SkJpegCodec::SkJpegCodec(int width, int height, const SkEncodedInfo& info,
     , fSwizzleSrcRow(nullptr)
     , fColorXformSrcRow(nullptr)
     , fSwizzlerSubset(SkIRect::MakeEmpty())
+    , fIndexedRestarts(false)
+    , fRegionDst(nullptr)
+    , fRegionRowBytes(0)
 {}
 
+SkJpegCodec::~SkJpegCodec() {}
+
 /*
  * Return the row bytes of a particular image type and width
  */
@@ -376,6 +385,7 @@ bool SkJpegCodec::onRewind() {
     }
     SkASSERT(nullptr != decoderMgr);
     fDecoderMgr.reset(decoderMgr);
+    fImageDecoderMgr.reset();
 
     fSwizzler.reset(nullptr);
     fSwizzleSrcRow = nullptr;
@@ -591,6 +601,11 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return fDecoderMgr->returnFailure("setOutputColorSpace", kInvalidConversion);
     }
 
+    if (options.fExecutor &&
+            this->decodeRestartBands(dstInfo, dst, dstRowBytes, options.fExecutor)) {
+        return kSuccess;
+    }
+
     if (!jpeg_start_decompress(dinfo)) {
         return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
     }
@@ -615,6 +630,121 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+const SkJpegRestartIndex* SkJpegCodec::restartIndex() {
+    if (!fIndexedRestarts) {
+        fIndexedRestarts = true;
+        SkStream* stream = this->stream();
+        if (stream->hasLength() && stream->getMemoryBase()) {
+            fRestartIndex = SkJpegRestartIndex::Make(stream->getMemoryBase(), stream->getLength(),
+                                                     fDecoderMgr->dinfo());
+        }
+    }
+    return fRestartIndex.get();
+}
+
+/*
+ * Decode rows [skip, skip + count) of a standalone band made by SkJpegRestartIndex into dst,
+ * using the same output settings as the decompressor for the whole image.
+ */
+static bool decode_band(const uint8_t* band, size_t size, const jpeg_decompress_struct& settings,
+                        int skip, int count, void* dst, size_t rowBytes) {
+    SkMemoryStream stream(band, size, false);
+    JpegDecoderMgr decoderMgr(&stream);
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+    if (setjmp(jmp)) {
+        return decoderMgr.returnFalse("decode_band");
+    }
+
+    decoderMgr.init();
+    jpeg_decompress_struct* dinfo = decoderMgr.dinfo();
+    if (JPEG_HEADER_OK != jpeg_read_header(dinfo, true)) {
+        return decoderMgr.returnFalse("decode_band header");
+    }
+    dinfo->out_color_space     = settings.out_color_space;
+    dinfo->dither_mode         = settings.dither_mode;
+    dinfo->dct_method          = settings.dct_method;
+    dinfo->do_fancy_upsampling = settings.do_fancy_upsampling;
+    if (!jpeg_start_decompress(dinfo)) {
+        return decoderMgr.returnFalse("decode_band start");
+    }
+
+    // Context rows above the band are decoded into its first row, then overwritten.
+    JSAMPLE* row = (JSAMPLE*) dst;
+    for (int y = 0; y < skip; y++) {
+        if (1 != jpeg_read_scanlines(dinfo, &row, 1)) {
+            return false;
+        }
+    }
+    for (int y = 0; y < count; y++) {
+        if (1 != jpeg_read_scanlines(dinfo, &row, 1)) {
+            return false;
+        }
+        row = SkTAddOffset<JSAMPLE>(row, rowBytes);
+    }
+    return true;
+}
+
+bool SkJpegCodec::decodeRestartBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                     SkExecutor* executor) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+
+    // Bands are decoded straight into dst, so there's no room for swizzling or color xforms.
+    if (this->colorXform() || JCS_CMYK == dinfo->out_color_space ||
+            dinfo->scale_num != dinfo->scale_denom) {
+        return false;
+    }
+
+    const SkJpegRestartIndex* index = this->restartIndex();
+    if (!index) {
+        return false;
+    }
+    SkASSERT(index->height() == dstInfo.height());
+
+    // Cut the image at row starts into up to kMaxBands bands of at least kMinBandRows.
+    // That's enough to keep a thread pool busy, without the context rows decoded twice at
+    // the edges of each band (see needsContext()) adding up to much.
+    constexpr int kMaxBands = 16;
+    constexpr int kMinBandRows = 4;
+    const int targetRows = SkTMax(index->mcuRows() / kMaxBands, kMinBandRows);
+    SkTDArray<int> bandStarts;
+    bandStarts.push(0);
+    for (int row : index->rowStarts()) {
+        if (row - bandStarts.top() >= targetRows) {
+            bandStarts.push(row);
+        }
+    }
+    if (bandStarts.count() < 2) {
+        return false;
+    }
+    bandStarts.push(index->mcuRows());
+
+    std::atomic<bool> failed(false);
+    SkTaskGroup(*executor).batch(bandStarts.count() - 1, [&](int i) {
+        const int startRow = bandStarts[i],
+                  endRow   = bandStarts[i + 1];
+        int decodeStart = startRow,
+            decodeEnd   = endRow;
+        if (index->needsContext()) {
+            decodeStart = index->rowStartBefore(startRow);
+            decodeEnd   = index->rowStartAfter(endRow);
+        }
+
+        SkAutoTMalloc<uint8_t> band;
+        const size_t size = index->makeBand(decodeStart, decodeEnd, &band);
+
+        const int mcuHeight = index->mcuHeight();
+        const int top       = startRow * mcuHeight,
+                  bottom    = SkTMin(endRow * mcuHeight, dstInfo.height());
+        if (!decode_band(band.get(), size, *dinfo, top - decodeStart * mcuHeight, bottom - top,
+                         SkTAddOffset<void>(dst, top * rowBytes), rowBytes)) {
+            failed = true;
+        }
+    });
+
+    // On failure, fall back to decoding serially, which knows how to report partial images.
+    return !failed;
+}
+
 void SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
@@ -771,6 +901,82 @@ bool SkJpegCodec::onSkipScanlines(int count) {
     return (uint32_t) count == jpeg_skip_scanlines(fDecoderMgr->dinfo(), count);
 }
 
+SkCodec::Result SkJpegCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst,
+        size_t rowBytes, const Options& options) {
+    // Returning kUnimplemented sends the caller to scanline decoding, without a rewind, so
+    // leave fDecoderMgr alone until we know we can decode the subset.
+    if (!options.fSubset) {
+        return kUnimplemented;
+    }
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (dinfo->scale_num != dinfo->scale_denom) {
+        return kUnimplemented;
+    }
+    const SkJpegRestartIndex* index = this->restartIndex();
+    if (!index) {
+        return kUnimplemented;
+    }
+
+    // Find the restart intervals that cover the subset, with an extra row start of context
+    // on either side if chroma upsampling needs it.
+    const int mcuHeight = index->mcuHeight();
+    const int top       = options.fSubset->top(),
+              bottom    = options.fSubset->bottom();
+    int startRow = index->rowStartBefore(top / mcuHeight + 1),
+        endRow   = index->rowStartAfter((bottom - 1) / mcuHeight);
+    if (index->needsContext()) {
+        if (startRow == top / mcuHeight) {
+            startRow = index->rowStartBefore(startRow);
+        }
+        if (endRow == (bottom - 1) / mcuHeight + 1 && endRow < index->mcuRows()) {
+            endRow = index->rowStartAfter(endRow);
+        }
+    }
+    if (0 == startRow) {
+        // Nothing to skip.  The scanline decoder will stop at the bottom of the subset.
+        return kUnimplemented;
+    }
+
+    // The last subset's decoder was dropped by the rewind, so nothing reads fRegion.
+    fRegionStream.reset();
+    const size_t size = index->makeBand(startRow, endRow, &fRegion);
+    std::unique_ptr<SkMemoryStream> stream(new SkMemoryStream(fRegion.get(), size, false));
+    JpegDecoderMgr* decoderMgr = nullptr;
+    if (kSuccess != ReadHeader(stream.get(), nullptr, &decoderMgr, nullptr)) {
+        return kUnimplemented;
+    }
+
+    // From here on, a rewind will bring back the decoder for the whole image.
+    fImageDecoderMgr = std::move(fDecoderMgr);
+    fDecoderMgr.reset(decoderMgr);
+    fRegionStream = std::move(stream);
+
+    Result result = this->onStartScanlineDecode(dstInfo, options);
+    if (kSuccess != result) {
+        return result;
+    }
+    if (!this->onSkipScanlines(top - startRow * mcuHeight)) {
+        return kInvalidInput;
+    }
+
+    fRegionDst = dst;
+    fRegionRowBytes = rowBytes;
+    return kSuccess;
+}
+
+SkCodec::Result SkJpegCodec::onIncrementalDecode(int* rowsDecoded) {
+    const int height = this->options().fSubset->height();
+    const int rows = this->readRows(this->dstInfo(), fRegionDst, fRegionRowBytes, height,
+                                    this->options());
+    if (rows < height) {
+        if (rowsDecoded) {
+            *rowsDecoded = rows;
+        }
+        return fDecoderMgr->returnFailure("Incomplete image data", kIncompleteInput);
+    }
+    return kSuccess;
+}
+
 static bool is_yuv_supported(jpeg_decompress_struct* dinfo) {
     // Scaling is not supported in raw data mode.
     SkASSERT(dinfo->scale_num == dinfo->scale_denom);
@@ -827,7 +1033,8 @@ static bool is_yuv_supported(jpeg_decompress_struct* dinfo) {
 }
 
 bool SkJpegCodec::onQueryYUV8(SkYUVSizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
-    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    jpeg_decompress_struct* dinfo = fImageDecoderMgr ? fImageDecoderMgr->dinfo()
+                                                     : fDecoderMgr->dinfo();
     if (!is_yuv_supported(dinfo)) {
         return false;
     }
@@ -17,6 +17,7 @@
 #include "SkTemplates.h"
 
 class JpegDecoderMgr;
+class SkJpegRestartIndex;
 
 /*
  *
@@ -33,6 +34,8 @@ public:
      */
     static std::unique_ptr<SkCodec> MakeFromStream(std::unique_ptr<SkStream>, Result*);
 
+    ~SkJpegCodec() override;
+
 protected:
 
     /*
@@ -50,6 +53,16 @@ protected:
 
     Result onGetYUV8Planes(const SkYUVSizeInfo& sizeInfo, void* planes[3]) override;
 
+    /*
+     * Incremental decoding is only implemented for subsets of jpegs with restart markers,
+     * to decode just the restart intervals that cover the subset.  Everything else is left
+     * to scanline decoding.
+     */
+    Result onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                    const Options&) override;
+
+    Result onIncrementalDecode(int* rowsDecoded) override;
+
     SkEncodedImageFormat onGetEncodedFormat() const override {
         return SkEncodedImageFormat::kJPEG;
     }
@@ -122,6 +135,20 @@ private:
     void allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Returns the restart markers of the encoded image, or nullptr if it has none
+     * (or they are not useful).  Computed on first use.
+     */
+    const SkJpegRestartIndex* restartIndex();
+
+    /*
+     * If the image has restart markers at the start of some MCU rows, decode bands of rows
+     * in parallel on the executor, each with its own decompressor, straight into dst.
+     * Returns false if this is not possible, in which case nothing has been decoded.
+     */
+    bool decodeRestartBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                            SkExecutor*);
+
     /*
      * Scanline decoding.
      */
@@ -149,6 +176,17 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    std::unique_ptr<SkJpegRestartIndex> fRestartIndex;
+    bool                                fIndexedRestarts;
+
+    // While decoding a subset, fDecoderMgr reads a standalone jpeg made of the restart
+    // intervals covering it, and the decoder for the whole image is kept here.
+    std::unique_ptr<JpegDecoderMgr>     fImageDecoderMgr;
+    SkAutoTMalloc<uint8_t>              fRegion;
+    std::unique_ptr<SkMemoryStream>     fRegionStream;
+    void*                               fRegionDst;
+    size_t                              fRegionRowBytes;
+
     friend class SkRawCodec;
 
     typedef SkCodec INHERITED;
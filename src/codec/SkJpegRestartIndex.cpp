@@ -0,0 +1,196 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkJpegRestartIndex.h"
+
+#include "SkCodecPriv.h"
+
+#include <algorithm>
+
+static bool is_unneeded_marker(uint8_t marker) {
+    // We keep APP0 (JFIF) and APP14 (Adobe), since they determine how libjpeg interprets
+    // the color components.  Other app markers (EXIF, ICC, ...) and comments are only
+    // interesting to the codec that read the whole image.
+    return (marker > JPEG_APP0 && marker < JPEG_APP0 + 14) || JPEG_APP0 + 15 == marker ||
+           JPEG_COM == marker;
+}
+
+std::unique_ptr<SkJpegRestartIndex> SkJpegRestartIndex::Make(const void* data, size_t size,
+                                                             const jpeg_decompress_struct* dinfo) {
+    if (!data || 0 == dinfo->restart_interval || dinfo->progressive_mode || dinfo->arith_code ||
+            dinfo->comps_in_scan != dinfo->num_components) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SkJpegRestartIndex> index(new SkJpegRestartIndex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    index->fData = bytes;
+
+    // Copy the header, up to and including the SOS marker, skipping what we don't need.
+    if (size < 2 || 0xFF != bytes[0] || 0xD8 != bytes[1]) {
+        return nullptr;
+    }
+    index->fHeader.append(2, bytes);
+    index->fHeightOffset = 0;
+    size_t pos = 2;
+    for (;;) {
+        if (pos + 4 > size || 0xFF != bytes[pos]) {
+            return nullptr;
+        }
+        const uint8_t marker = bytes[pos + 1];
+        if (0xFF == marker) {
+            // Fill byte.
+            pos++;
+            continue;
+        }
+        const size_t length = (bytes[pos + 2] << 8) | bytes[pos + 3];
+        if (length < 2 || pos + 2 + length > size) {
+            return nullptr;
+        }
+        if (0xC0 == marker || 0xC1 == marker) {
+            // SOF0 and SOF1: FF Cn, length (2), precision (1), height (2), ...
+            if (length < 8) {
+                return nullptr;
+            }
+            index->fHeightOffset = index->fHeader.count() + 5;
+        }
+        if (!is_unneeded_marker(marker)) {
+            index->fHeader.append(SkToInt(2 + length), bytes + pos);
+        }
+        pos += 2 + length;
+        if (0xDA == marker) {
+            break;
+        }
+    }
+    if (0 == index->fHeightOffset) {
+        return nullptr;
+    }
+
+    // Find the restart markers and the end of the scan.  0xFF in the entropy coded data is
+    // always followed by a stuffed 0x00, more 0xFF fill bytes, or a marker.
+    index->fScanStart = pos;
+    index->fScanEnd = 0;
+    while (pos + 1 < size) {
+        const uint8_t* ff = static_cast<const uint8_t*>(memchr(bytes + pos, 0xFF, size - pos - 1));
+        if (!ff) {
+            break;
+        }
+        pos = ff - bytes;
+        const uint8_t next = bytes[pos + 1];
+        if (0x00 == next) {
+            pos += 2;
+        } else if (0xFF == next) {
+            pos += 1;
+        } else if (JPEG_RST0 <= next && next <= JPEG_RST0 + 7) {
+            index->fMarkers.push(pos);
+            pos += 2;
+        } else {
+            index->fScanEnd = pos;
+            break;
+        }
+    }
+    if (0 == index->fScanEnd) {
+        // The scan is incomplete.
+        return nullptr;
+    }
+
+    // Now figure out where in the image each restart interval begins.
+    if (1 == dinfo->num_components) {
+        // Single component scans are not interleaved: an MCU is a single block.
+        index->fMCUsPerRow = SkToInt((dinfo->image_width + DCTSIZE - 1) / DCTSIZE);
+        index->fMCUHeight  = DCTSIZE;
+    } else {
+        const int mcuWidth = dinfo->max_h_samp_factor * DCTSIZE;
+        index->fMCUsPerRow = SkToInt((dinfo->image_width + mcuWidth - 1) / mcuWidth);
+        index->fMCUHeight  = dinfo->max_v_samp_factor * DCTSIZE;
+    }
+    index->fHeight = SkToInt(dinfo->image_height);
+    index->fMCURows = (index->fHeight + index->fMCUHeight - 1) / index->fMCUHeight;
+    index->fRestartInterval = SkToInt(dinfo->restart_interval);
+
+    const int64_t mcus = (int64_t) index->fMCUsPerRow * index->fMCURows;
+    const int64_t intervals = (mcus + index->fRestartInterval - 1) / index->fRestartInterval;
+    if (index->fMarkers.count() != intervals - 1) {
+        SkCodecPrintf("Expected %d restart markers, found %d.\n",
+                      SkToInt(intervals - 1), index->fMarkers.count());
+        return nullptr;
+    }
+
+    for (int64_t mcu = 0; mcu < mcus; mcu += index->fRestartInterval) {
+        if (0 == mcu % index->fMCUsPerRow) {
+            index->fRowStarts.push(SkToInt(mcu / index->fMCUsPerRow));
+        }
+    }
+    if (index->fRowStarts.count() < 2) {
+        return nullptr;
+    }
+
+    // Vertically subsampled components are upsampled using the rows above and below.
+    index->fNeedsContext = false;
+    if (dinfo->do_fancy_upsampling) {
+        for (int i = 0; i < dinfo->num_components; i++) {
+            if (dinfo->comp_info[i].v_samp_factor < dinfo->max_v_samp_factor) {
+                index->fNeedsContext = true;
+            }
+        }
+    }
+    return index;
+}
+
+int SkJpegRestartIndex::rowStartBefore(int row) const {
+    const int* it = std::lower_bound(fRowStarts.begin(), fRowStarts.end(), row);
+    return it == fRowStarts.begin() ? 0 : *(it - 1);
+}
+
+int SkJpegRestartIndex::rowStartAfter(int row) const {
+    const int* it = std::upper_bound(fRowStarts.begin(), fRowStarts.end(), row);
+    return it == fRowStarts.end() ? fMCURows : *it;
+}
+
+size_t SkJpegRestartIndex::intervalStart(int row) const {
+    const int interval = row * fMCUsPerRow / fRestartInterval;
+    return 0 == interval ? fScanStart : fMarkers[interval - 1] + 2;
+}
+
+size_t SkJpegRestartIndex::intervalEnd(int row) const {
+    if (row == fMCURows) {
+        return fScanEnd;
+    }
+    const int interval = row * fMCUsPerRow / fRestartInterval;
+    return fMarkers[interval - 1];
+}
+
+size_t SkJpegRestartIndex::makeBand(int startRow, int endRow, SkAutoTMalloc<uint8_t>* band) const {
+    SkASSERT(0 <= startRow && startRow < endRow && endRow <= fMCURows);
+    SkASSERT(0 == startRow * fMCUsPerRow % fRestartInterval);
+
+    const size_t start = this->intervalStart(startRow),
+                 end   = this->intervalEnd(endRow);
+    const size_t size  = fHeader.count() + (end - start) + 2;
+    band->reset(size);
+
+    uint8_t* dst = band->get();
+    memcpy(dst, fHeader.begin(), fHeader.count());
+    const int height = SkTMin(endRow * fMCUHeight, fHeight) - startRow * fMCUHeight;
+    dst[fHeightOffset + 0] = height >> 8;
+    dst[fHeightOffset + 1] = height & 0xFF;
+
+    uint8_t* scan = dst + fHeader.count();
+    memcpy(scan, fData + start, end - start);
+
+    // Renumber the restart markers so that the band's first is RST0, as libjpeg expects.
+    const int first = startRow * fMCUsPerRow / fRestartInterval;
+    const int last  = endRow == fMCURows ? fMarkers.count() + 1
+                                         : endRow * fMCUsPerRow / fRestartInterval;
+    for (int i = first; i < last - 1; i++) {
+        scan[fMarkers[i] - start + 1] = JPEG_RST0 + ((i - first) & 7);
+    }
+
+    dst[size - 2] = 0xFF;
+    dst[size - 1] = JPEG_EOI;
+    return size;
+}
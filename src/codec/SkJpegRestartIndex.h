@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegRestartIndex_DEFINED
+#define SkJpegRestartIndex_DEFINED
+
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+#include <memory>
+// stdio is needed for jpeglib
+#include <stdio.h>
+
+extern "C" {
+    #include "jpeglib.h"
+}
+
+/*
+ * Locates the restart markers (RSTn) in a baseline jpeg.
+ *
+ * Each restart interval resets the DC predictors and starts on a byte boundary, so whenever
+ * an interval begins at the start of a row of MCUs, the rows from there on can be decoded
+ * without looking at anything that came before.  This lets us cut the image into bands of
+ * MCU rows and wrap each band up as a short jpeg of its own.
+ */
+class SkJpegRestartIndex {
+public:
+    /*
+     * Returns nullptr if the jpeg in data has no restart markers, or is not a single scan
+     * Huffman coded image.  dinfo must have read the header of the same jpeg.
+     *
+     * Does not copy data, which must outlive the index.
+     */
+    static std::unique_ptr<SkJpegRestartIndex> Make(const void* data, size_t size,
+                                                    const jpeg_decompress_struct* dinfo);
+
+    int mcuRows()   const { return fMCURows; }
+    int mcuHeight() const { return fMCUHeight; }
+    int height()    const { return fHeight; }
+
+    /*
+     * Rows of MCUs at which a restart interval begins, in increasing order.  The first is
+     * always 0.  A band may start or end at any of these (or end at mcuRows()).
+     */
+    const SkTDArray<int>& rowStarts() const { return fRowStarts; }
+
+    /*
+     * Upsampled chroma near the edges of a band depends on the neighboring MCU rows.  If
+     * this returns true, bands must be decoded with an extra row start on either side.
+     */
+    bool needsContext() const { return fNeedsContext; }
+
+    /*
+     * The last row start before row, or 0.
+     * The first row start after row, or mcuRows().
+     */
+    int rowStartBefore(int row) const;
+    int rowStartAfter(int row) const;
+
+    /*
+     * Write a standalone jpeg holding the MCU rows [startRow, endRow) to band, and return its
+     * size.  startRow must be a row start, and endRow must be a row start or mcuRows().
+     */
+    size_t makeBand(int startRow, int endRow, SkAutoTMalloc<uint8_t>* band) const;
+
+private:
+    SkJpegRestartIndex() {}
+
+    // Byte range of the entropy coded data of the restart interval that starts MCU row.
+    size_t intervalStart(int row) const;
+    size_t intervalEnd(int row) const;
+
+    const uint8_t*     fData;
+    SkTDArray<uint8_t> fHeader;          // SOI through SOS, without the markers we don't need.
+    size_t             fHeightOffset;    // Where the image height is stored in fHeader.
+    size_t             fScanStart;
+    size_t             fScanEnd;
+    SkTDArray<size_t>  fMarkers;         // Offset of the RSTn marker that ends each interval.
+    int                fRestartInterval; // In MCUs.
+    int                fMCUsPerRow;
+    int                fMCURows;
+    int                fMCUHeight;
+    int                fHeight;
+    bool               fNeedsContext;
+    SkTDArray<int>     fRowStarts;
+};
+
+#endif
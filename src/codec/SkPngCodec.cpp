@@ -593,6 +593,9 @@ private:
         // If there is no swizzler, all rows are needed.
         if (!this->swizzler() || this->swizzler()->rowNeeded(rowNum - fFirstRow)) {
             this->applyXformRow(fDst, row);
+            if (this->swizzler()) {
+                this->swizzler()->rowWritten(fDst);
+            }
             fDst = SkTAddOffset<void>(fDst, fRowBytes);
             fRowsWrittenToOutput++;
         }
@@ -740,6 +743,9 @@ private:
         void* dst = fDst;
         for (; rowsWrittenToOutput < rowsNeeded; rowsWrittenToOutput++) {
             this->applyXformRow(dst, srcRow);
+            if (this->swizzler()) {
+                this->swizzler()->rowWritten(dst);
+            }
             dst = SkTAddOffset<void>(dst, fRowBytes);
             srcRow = SkTAddOffset<png_byte>(srcRow, fPng_rowbytes * sampleY);
         }
@@ -5,13 +5,116 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmap.h"
 #include "SkCodec.h"
 #include "SkCodecPriv.h"
 #include "SkMath.h"
+#include "SkPixmap.h"
 #include "SkSampledCodec.h"
 #include "SkSampler.h"
 #include "SkTemplates.h"
 
+namespace {
+
+/**
+ *  Averages blocks of sampleX x sampleY pixels of 8888 rows, as they are decoded, into rows
+ *  of the destination.  Only one row of sums is kept, so the memory needed does not depend
+ *  on the height of the image.
+ */
+class BoxFilter {
+public:
+    /**
+     *  @param rowInfo   Describes the 8888 rows handed to accumulate(), which are srcWidth
+     *                   wide.  Only its color type, alpha type and color space are used.
+     *  @param skipRows  Rows to ignore before the first block.
+     */
+    BoxFilter(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+              const SkImageInfo& rowInfo, int srcWidth, int sampleX, int sampleY, int skipRows)
+        : fDstInfo(dstInfo)
+        , fDst(dst)
+        , fRowBytes(rowBytes)
+        , fRowInfo(rowInfo.makeWH(dstInfo.width(), 1))
+        , fSampleX(sampleX)
+        , fSampleY(sampleY)
+        // Center the blocks, dropping the leftover columns evenly on either side.
+        , fOffsetX((srcWidth - dstInfo.width() * sampleX) / 2)
+        , fSkipRows(skipRows)
+        , fSums(4 * dstInfo.width())
+        , fRow(dstInfo.width())
+        , fRowsAccumulated(0)
+        , fRowsWritten(0)
+    {
+        SkASSERT(4 == rowInfo.bytesPerPixel());
+        sk_bzero(fSums.get(), 4 * dstInfo.width() * sizeof(uint32_t));
+    }
+
+    static void AccumulateProc(void* ctx, const void* row) {
+        static_cast<BoxFilter*>(ctx)->accumulate(row);
+    }
+
+    void accumulate(const void* row) {
+        if (fSkipRows > 0) {
+            fSkipRows--;
+            return;
+        }
+        if (fRowsWritten == fDstInfo.height()) {
+            return;
+        }
+
+        const uint8_t* src = SkTAddOffset<const uint8_t>(row, 4 * fOffsetX);
+        uint32_t* sums = fSums.get();
+        for (int x = 0; x < fDstInfo.width(); x++) {
+            for (int i = 0; i < fSampleX; i++) {
+                sums[0] += src[0];
+                sums[1] += src[1];
+                sums[2] += src[2];
+                sums[3] += src[3];
+                src += 4;
+            }
+            sums += 4;
+        }
+
+        if (++fRowsAccumulated == fSampleY) {
+            this->writeRow();
+        }
+    }
+
+    int rowsWritten() const { return fRowsWritten; }
+
+private:
+    void writeRow() {
+        const uint32_t area = fSampleX * fSampleY;
+        uint8_t* row = reinterpret_cast<uint8_t*>(fRow.get());
+        uint32_t* sums = fSums.get();
+        for (int i = 0; i < 4 * fDstInfo.width(); i++) {
+            row[i] = (sums[i] + area / 2) / area;
+            sums[i] = 0;
+        }
+
+        // This converts to the destination's color type and alpha type if they differ.
+        SkPixmap(fRowInfo, row, fRowInfo.minRowBytes()).readPixels(
+                fDstInfo.makeWH(fDstInfo.width(), 1),
+                SkTAddOffset<void>(fDst, fRowsWritten * fRowBytes), fRowBytes);
+        fRowsWritten++;
+        fRowsAccumulated = 0;
+    }
+
+    const SkImageInfo       fDstInfo;
+    void* const             fDst;
+    const size_t            fRowBytes;
+    const SkImageInfo       fRowInfo;
+    const int               fSampleX;
+    const int               fSampleY;
+    const int               fOffsetX;
+    int                     fSkipRows;
+    SkAutoTMalloc<uint32_t> fSums;
+    SkAutoTMalloc<uint32_t> fRow;
+    int                     fRowsAccumulated;
+    int                     fRowsWritten;
+};
+
+}  // namespace
+
 SkSampledCodec::SkSampledCodec(SkCodec* codec, ExifOrientationBehavior behavior)
     : INHERITED(codec, behavior)
 {}
@@ -214,6 +317,20 @@ SkCodec::Result SkSampledCodec::sampledDecode(const SkImageInfo& info, void* pix
 
     const SkImageInfo nativeInfo = info.makeWH(nativeSize.width(), nativeSize.height());
 
+    if (SkAndroidCodec::SampleFilter::kBox == options.fSampleFilter) {
+        switch (info.colorType()) {
+            case kRGBA_8888_SkColorType:
+            case kBGRA_8888_SkColorType:
+            case kRGB_565_SkColorType:
+            case kGray_8_SkColorType:
+                return this->boxFilteredDecode(info, pixels, rowBytes, options, nativeSize,
+                                               sampledOptions.fSubset, subsetY, subsetHeight);
+            default:
+                // Fall back to point sampling.
+                break;
+        }
+    }
+
     {
         // Although startScanlineDecode expects the bottom and top to match the
         // SkImageInfo, startIncrementalDecode uses them to determine which rows to
@@ -347,3 +464,111 @@ SkCodec::Result SkSampledCodec::sampledDecode(const SkImageInfo& info, void* pix
             return SkCodec::kUnimplemented;
     }
 }
+
+SkCodec::Result SkSampledCodec::boxFilteredDecode(const SkImageInfo& info, void* pixels,
+        size_t rowBytes, const AndroidOptions& options, const SkISize& nativeSize,
+        const SkIRect* subset, int subsetY, int subsetHeight) {
+    const int subsetWidth = subset ? subset->width() : nativeSize.width();
+    const int sampleX = subsetWidth / info.width();
+    const int sampleY = subsetHeight / info.height();
+    const int offsetY = (subsetHeight - info.height() * sampleY) / 2;
+
+    // Decode rows as 8888, premultiplied so that averaging weighs colors by coverage.
+    SkImageInfo rowInfo = info;
+    if (4 != info.bytesPerPixel()) {
+        rowInfo = rowInfo.makeColorType(kN32_SkColorType);
+    }
+    if (kUnpremul_SkAlphaType == info.alphaType()) {
+        rowInfo = rowInfo.makeAlphaType(kPremul_SkAlphaType);
+    }
+    const SkImageInfo decodeInfo = rowInfo.makeWH(nativeSize.width(), nativeSize.height());
+
+    SkCodec::Options codecOptions;
+    codecOptions.fZeroInitialized = SkCodec::kNo_ZeroInitialized;
+    codecOptions.fPremulBehavior = SkTransferFunctionBehavior::kIgnore;
+    codecOptions.fSubset = subset;
+
+    SkAutoTMalloc<uint32_t> row(subsetWidth);
+    auto fill = [&](int rowsWritten) {
+        const SkImageInfo fillInfo = info.makeWH(info.width(), info.height() - rowsWritten);
+        SkSampler::Fill(fillInfo, SkTAddOffset<void>(pixels, rowsWritten * rowBytes), rowBytes,
+                        this->codec()->getFillValue(info), options.fZeroInitialized);
+    };
+
+    if (this->codec()->getEncodedFormat() == SkEncodedImageFormat::kPNG) {
+        // PNG only decodes incrementally, but hands each row to the sampler's RowProc.
+        // Every row is written to the same scratch row.
+        SkIRect incrementalSubset = SkIRect::MakeLTRB(0, subsetY, nativeSize.width(),
+                                                      subsetY + subsetHeight);
+        if (subset) {
+            incrementalSubset.fLeft = subset->fLeft;
+            incrementalSubset.fRight = subset->fRight;
+        }
+        codecOptions.fSubset = &incrementalSubset;
+        const SkCodec::Result startResult = this->codec()->startIncrementalDecode(decodeInfo,
+                row.get(), 0, &codecOptions);
+        if (SkCodec::kSuccess == startResult) {
+            SkSampler* sampler = this->codec()->getSampler(true);
+            if (!sampler) {
+                return SkCodec::kUnimplemented;
+            }
+
+            BoxFilter filter(info, pixels, rowBytes, rowInfo, subsetWidth, sampleX, sampleY,
+                             offsetY);
+            sampler->setRowProc(BoxFilter::AccumulateProc, &filter);
+            const SkCodec::Result result = this->codec()->incrementalDecode();
+            sampler->setRowProc(nullptr, nullptr);
+            if (filter.rowsWritten() < info.height()) {
+                fill(filter.rowsWritten());
+            }
+            return SkCodec::kSuccess == result && filter.rowsWritten() < info.height()
+                    ? SkCodec::kIncompleteInput : result;
+        } else if (startResult != SkCodec::kUnimplemented) {
+            return startResult;
+        }
+        codecOptions.fSubset = subset;
+    }
+
+    SkCodec::Result result = this->codec()->startScanlineDecode(decodeInfo, &codecOptions);
+    if (SkCodec::kSuccess == result &&
+            SkCodec::kTopDown_SkScanlineOrder == this->codec()->getScanlineOrder()) {
+        BoxFilter filter(info, pixels, rowBytes, rowInfo, subsetWidth, sampleX, sampleY, 0);
+        const int rows = info.height() * sampleY;
+        if (this->codec()->skipScanlines(subsetY + offsetY)) {
+            for (int y = 0; y < rows; y++) {
+                if (1 != this->codec()->getScanlines(row.get(), 1, 0)) {
+                    break;
+                }
+                filter.accumulate(row.get());
+            }
+        }
+        if (filter.rowsWritten() < info.height()) {
+            fill(filter.rowsWritten());
+            return SkCodec::kIncompleteInput;
+        }
+        return SkCodec::kSuccess;
+    } else if (SkCodec::kSuccess != result && SkCodec::kUnimplemented != result) {
+        return result;
+    }
+
+    // This codec cannot hand us rows in order, so decode the whole subset into temporary
+    // memory and filter that.  Only codecs that do not scale natively get here.
+    SkASSERT(nativeSize == this->codec()->getInfo().dimensions());
+    const SkImageInfo tmpInfo = rowInfo.makeWH(subsetWidth, subsetHeight);
+    SkBitmap tmp;
+    if (!tmp.tryAllocPixels(tmpInfo)) {
+        return SkCodec::kInternalError;
+    }
+    AndroidOptions tmpOptions;
+    tmpOptions.fSubset = options.fSubset;
+    result = this->onGetAndroidPixels(tmpInfo, tmp.getPixels(), tmp.rowBytes(), tmpOptions);
+    if (SkCodec::kSuccess != result && SkCodec::kIncompleteInput != result &&
+            SkCodec::kErrorInInput != result) {
+        return result;
+    }
+    BoxFilter filter(info, pixels, rowBytes, rowInfo, subsetWidth, sampleX, sampleY, offsetY);
+    for (int y = 0; y < subsetHeight; y++) {
+        filter.accumulate(tmp.getAddr(0, y));
+    }
+    return result;
+}
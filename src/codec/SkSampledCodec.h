@@ -54,6 +54,20 @@ private:
     SkCodec::Result sampledDecode(const SkImageInfo& info, void* pixels, size_t rowBytes,
             const AndroidOptions& options);
 
+    /**
+     *  Called from sampledDecode() for SampleFilter::kBox, once the native scale and subset
+     *  have been worked out.
+     *
+     *  @param nativeSize The size fCodec will scale to.
+     *  @param subset     The x range of the subset in nativeSize (spanning its full
+     *                    height), or nullptr if there is none.
+     *  @param subsetY    First row of the subset in nativeSize.
+     *  @param subsetHeight Rows of the subset in nativeSize.
+     */
+    SkCodec::Result boxFilteredDecode(const SkImageInfo& info, void* pixels, size_t rowBytes,
+            const AndroidOptions& options, const SkISize& nativeSize, const SkIRect* subset,
+            int subsetY, int subsetHeight);
+
     typedef SkAndroidCodec INHERITED;
 };
 #endif // SkSampledCodec_DEFINED
@@ -44,6 +44,24 @@ public:
         return (row - get_start_coord(fSampleY)) % fSampleY == 0;
     }
 
+    /**
+     *  Lets SkSampledCodec filter rows as they are decoded, instead of skipping them.
+     *
+     *  Codecs that support this (currently PNG) call rowWritten() with every row of the
+     *  subset, top to bottom, once it has been written to the destination.
+     */
+    typedef void (*RowProc)(void* ctx, const void* row);
+    void setRowProc(RowProc proc, void* ctx) {
+        fRowProc = proc;
+        fRowProcCtx = ctx;
+    }
+
+    void rowWritten(const void* row) const {
+        if (fRowProc) {
+            fRowProc(fRowProcCtx, row);
+        }
+    }
+
     /**
      * Fill the remainder of the destination with a single color
      *
@@ -81,11 +99,15 @@ public:
 
     SkSampler()
         : fSampleY(1)
+        , fRowProc(nullptr)
+        , fRowProcCtx(nullptr)
     {}
 
     virtual ~SkSampler() {}
 private:
-    int fSampleY;
+    int     fSampleY;
+    RowProc fRowProc;
+    void*   fRowProcCtx;
 
     virtual int onSetSampleX(int) = 0;
 };
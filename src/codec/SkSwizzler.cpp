@@ -72,6 +72,23 @@ static void sample8(void* dst, const uint8_t* src, int width, int bpp, int delta
     }
 }
 
+// The fast procs that need an intermediate format convert kChunkPixels at a time through
+// buffers on the stack.
+static constexpr int kChunkPixels = 64;
+
+// Convert a row to 565 by writing each chunk of it as 8888 with toRGBA, and packing that.
+template <typename ToRGBA>
+static void to_565_in_chunks(void* dstRow, int width, bool swapRB, ToRGBA&& toRGBA) {
+    auto pack = swapRB ? SkOpts::BGRA_to_565 : SkOpts::RGBA_to_565;
+    uint16_t* dst = (uint16_t*) dstRow;
+    uint32_t rgba[kChunkPixels];
+    for (int x = 0; x < width; x += kChunkPixels) {
+        const int n = SkTMin(kChunkPixels, width - x);
+        toRGBA(rgba, x, n);
+        pack(dst + x, rgba, n);
+    }
+}
+
 // kBit
 // These routines exclusively choose between white and black
 
@@ -265,6 +282,30 @@ static void swizzle_index_to_565(
     }
 }
 
+static void fast_swizzle_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index_to_n32((uint32_t*) dst, src + offset, width, ctable);
+}
+
+static void fast_swizzle_index_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    // The color table is in N32 order.
+    const bool swapRB = SK_PMCOLOR_BYTE_ORDER(B,G,R,A);
+    to_565_in_chunks(dst, width, swapRB, [src, ctable](uint32_t* n32, int x, int n) {
+        SkOpts::index_to_n32(n32, src + x, n, ctable);
+    });
+}
+
 // kGray
 
 static void swizzle_gray_to_n32(
@@ -304,6 +345,17 @@ static void swizzle_gray_to_565(
     }
 }
 
+static void fast_swizzle_gray_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    to_565_in_chunks(dst, width, false, [src](uint32_t* rgba, int x, int n) {
+        SkOpts::gray_to_RGB1(rgba, src + x, n);
+    });
+}
+
 // kGrayAlpha
 
 static void swizzle_grayalpha_to_n32_unpremul(
@@ -381,6 +433,17 @@ static void swizzle_bgr_to_565(
     }
 }
 
+static void fast_swizzle_bgr_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    to_565_in_chunks(dst, width, true, [src](uint32_t* bgra, int x, int n) {
+        SkOpts::RGB_to_RGB1(bgra, src + 3*x, n);
+    });
+}
+
 // kRGB
 
 static void swizzle_rgb_to_rgba(
@@ -441,6 +504,17 @@ static void swizzle_rgb_to_565(
     }
 }
 
+static void fast_swizzle_rgb_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    to_565_in_chunks(dst, width, false, [src](uint32_t* rgba, int x, int n) {
+        SkOpts::RGB_to_RGB1(rgba, src + 3*x, n);
+    });
+}
+
 // kRGBA
 
 static void swizzle_rgba_to_rgba_premul(
@@ -620,6 +694,56 @@ static void swizzle_rgba16_to_bgra_premul(
     }
 }
 
+// The fast 16-bit procs strip the components to 8 bits, then reuse the 8-bit procs.
+// RGB takes a trip through a buffer, RGBA is converted in place.
+
+template <SkOpts::Swizzle_8888* kExpand>
+static void fast_swizzle_rgb16_to(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    uint32_t* dst32 = (uint32_t*) dst;
+    uint8_t rgb[3 * kChunkPixels];
+    for (int x = 0; x < width; x += kChunkPixels) {
+        const int n = SkTMin(kChunkPixels, width - x);
+        SkOpts::strip_16_to_8(rgb, src + 6*x, 3*n);
+        (*kExpand)(dst32 + x, rgb, n);
+    }
+}
+
+static void fast_swizzle_rgb16_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    uint8_t rgb[3 * kChunkPixels];
+    to_565_in_chunks(dst, width, false, [src, &rgb](uint32_t* rgba, int x, int n) {
+        SkOpts::strip_16_to_8(rgb, src + 6*x, 3*n);
+        SkOpts::RGB_to_RGB1(rgba, rgb, n);
+    });
+}
+
+static void fast_swizzle_rgba16_to_rgba_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::strip_16_to_8((uint8_t*) dst, src + offset, 4*width);
+}
+
+template <SkOpts::Swizzle_8888* kSwizzle>
+static void fast_swizzle_rgba16_to(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::strip_16_to_8((uint8_t*) dst, src + offset, 4*width);
+    (*kSwizzle)((uint32_t*) dst, dst, width);
+}
+
 // kCMYK
 //
 // CMYK is stored as four bytes per pixel.
@@ -735,6 +859,17 @@ static void swizzle_cmyk_to_565(
     }
 }
 
+static void fast_swizzle_cmyk_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    to_565_in_chunks(dst, width, false, [src](uint32_t* rgba, int x, int n) {
+        SkOpts::inverted_CMYK_to_RGB1(rgba, src + 4*x, n);
+    });
+}
+
 template <SkSwizzler::RowProc proc>
 void SkSwizzler::SkipLeadingGrayAlphaZerosThen(
         void* dst, const uint8_t* src, int width,
@@ -881,6 +1016,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_gray_to_565;
+                                fastProc = &fast_swizzle_gray_to_565;
                                 break;
                             default:
                                 return nullptr;
@@ -950,10 +1086,12 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                     proc = &swizzle_index_to_n32_skipZ;
                                 } else {
                                     proc = &swizzle_index_to_n32;
+                                    fastProc = &fast_swizzle_index_to_n32;
                                 }
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_index_to_565;
+                                fastProc = &fast_swizzle_index_to_565;
                                 break;
                             default:
                                 return nullptr;
@@ -968,6 +1106,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                     case kRGBA_8888_SkColorType:
                         if (16 == encodedInfo.bitsPerComponent()) {
                             proc = &swizzle_rgb16_to_rgba;
+                            fastProc = &fast_swizzle_rgb16_to<&SkOpts::RGB_to_RGB1>;
                             break;
                         }
 
@@ -978,6 +1117,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                     case kBGRA_8888_SkColorType:
                         if (16 == encodedInfo.bitsPerComponent()) {
                             proc = &swizzle_rgb16_to_bgra;
+                            fastProc = &fast_swizzle_rgb16_to<&SkOpts::RGB_to_BGR1>;
                             break;
                         }
 
@@ -988,10 +1128,12 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                     case kRGB_565_SkColorType:
                         if (16 == encodedInfo.bitsPerComponent()) {
                             proc = &swizzle_rgb16_to_565;
+                            fastProc = &fast_swizzle_rgb16_to_565;
                             break;
                         }
 
                         proc = &swizzle_rgb_to_565;
+                        fastProc = &fast_swizzle_rgb_to_565;
                         break;
                     default:
                         return nullptr;
@@ -1001,8 +1143,13 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                 switch (dstInfo.colorType()) {
                     case kRGBA_8888_SkColorType:
                         if (16 == encodedInfo.bitsPerComponent()) {
-                            proc = premultiply ? &swizzle_rgba16_to_rgba_premul :
-                                                 &swizzle_rgba16_to_rgba_unpremul;
+                            if (premultiply) {
+                                proc = &swizzle_rgba16_to_rgba_premul;
+                                fastProc = &fast_swizzle_rgba16_to<&SkOpts::RGBA_to_rgbA>;
+                            } else {
+                                proc = &swizzle_rgba16_to_rgba_unpremul;
+                                fastProc = &fast_swizzle_rgba16_to_rgba_unpremul;
+                            }
                             break;
                         }
 
@@ -1028,8 +1175,13 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kBGRA_8888_SkColorType:
                         if (16 == encodedInfo.bitsPerComponent()) {
-                            proc = premultiply ? &swizzle_rgba16_to_bgra_premul :
-                                                 &swizzle_rgba16_to_bgra_unpremul;
+                            if (premultiply) {
+                                proc = &swizzle_rgba16_to_bgra_premul;
+                                fastProc = &fast_swizzle_rgba16_to<&SkOpts::RGBA_to_bgrA>;
+                            } else {
+                                proc = &swizzle_rgba16_to_bgra_unpremul;
+                                fastProc = &fast_swizzle_rgba16_to<&SkOpts::RGBA_to_BGRA>;
+                            }
                             break;
                         }
 
@@ -1070,6 +1222,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_bgr_to_565;
+                        fastProc = &fast_swizzle_bgr_to_565;
                         break;
                     default:
                         return nullptr;
@@ -1149,6 +1302,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_cmyk_to_565;
+                        fastProc = &fast_swizzle_cmyk_to_565;
                         break;
                     default:
                         return nullptr;
@@ -1211,20 +1365,66 @@ int SkSwizzler::onSetSampleX(int sampleX) {
     fSwizzleWidth = get_scaled_dimension(fSrcWidth, sampleX);
     fAllocatedWidth = get_scaled_dimension(fDstWidth, sampleX);
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
+    // The optimized swizzler functions do not support sampling.  Instead, swizzle()
+    // gathers the sampled pixels into fSampledRow and runs the optimized function on
+    // that, unless it would only be copying them again.
     if (1 == fSampleX && fFastProc) {
         fActualProc = fFastProc;
     } else {
         fActualProc = fSlowProc;
     }
+    fSampledRow.reset(this->gatherSamples() ? fSwizzleWidth * fSrcBPP : 0);
 
     return fAllocatedWidth;
 }
 
+bool SkSwizzler::gatherSamples() const {
+    return 1 != fSampleX && fFastProc && fFastProc != &copy;
+}
+
+template <int kBPP>
+static void gather_n(uint8_t* dst, const uint8_t* src, int width, int deltaSrc) {
+    // A fixed size lets the compiler turn each copy into a load and a store.
+    for (int x = 0; x < width; x++) {
+        memcpy(dst, src, kBPP);
+        dst += kBPP;
+        src += deltaSrc;
+    }
+}
+
+static void gather(uint8_t* dst, const uint8_t* src, int width, int bpp, int deltaSrc) {
+    switch (bpp) {
+        case 1: gather_n<1>(dst, src, width, deltaSrc); break;
+        case 2: gather_n<2>(dst, src, width, deltaSrc); break;
+        case 3: gather_n<3>(dst, src, width, deltaSrc); break;
+        case 4: SkOpts::gather_32((uint32_t*) dst, src, width, deltaSrc); break;
+        case 6: gather_n<6>(dst, src, width, deltaSrc); break;
+        case 8: gather_n<8>(dst, src, width, deltaSrc); break;
+        default:
+            for (int x = 0; x < width; x++) {
+                memcpy(dst, src, bpp);
+                dst += bpp;
+                src += deltaSrc;
+            }
+            break;
+    }
+}
+
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
-    fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
-            fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
+    dst = SkTAddOffset<void>(dst, fDstOffsetBytes);
+    if (this->gatherSamples()) {
+        gather(fSampledRow.get(), src + fSrcOffsetUnits, fSwizzleWidth, fSrcBPP,
+               fSampleX * fSrcBPP);
+        fFastProc(dst, fSampledRow.get(), fSwizzleWidth, fSrcBPP, fSrcBPP, 0, fColorTable);
+        return;
+    }
+    if (&sample4 == fActualProc) {
+        // Copying every fSampleX'th pixel is a gather.
+        SkOpts::gather_32((uint32_t*) dst, src + fSrcOffsetUnits, fSwizzleWidth,
+                          fSampleX * fSrcBPP);
+        return;
+    }
+    fActualProc(dst, src, fSwizzleWidth, fSrcBPP, fSampleX * fSrcBPP, fSrcOffsetUnits,
+                fColorTable);
 }
@@ -12,6 +12,7 @@
 #include "SkColor.h"
 #include "SkImageInfo.h"
 #include "SkSampler.h"
+#include "SkTemplates.h"
 
 class SkSwizzler : public SkSampler {
 public:
@@ -207,10 +208,16 @@ private:
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
 
+    // When sampling with a fast proc, the sampled pixels are gathered here first.
+    SkAutoTMalloc<uint8_t> fSampledRow;
+
     SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
             int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
 
     int onSetSampleX(int) override;
 
+    // Whether swizzle() gathers the sampled pixels, so that it can use fFastProc.
+    bool gatherSamples() const;
+
 };
 #endif // SkSwizzler_DEFINED
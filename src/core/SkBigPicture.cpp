@@ -24,6 +24,13 @@ SkBigPicture::SkBigPicture(const SkRect& cull,
     , fBBH(bbh)                     // Take ownership of caller's ref.
 {}
 
+struct SkBigPicture::CostData {
+    SkAutoTMalloc<SkRect>   fBounds;
+    SkAutoTMalloc<SkOpCost> fOps;
+};
+
+SkBigPicture::~SkBigPicture() {}
+
 void SkBigPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
     SkASSERT(canvas);
 
@@ -61,6 +68,41 @@ size_t SkBigPicture::approximateBytesUsed() const {
     return bytes;
 }
 
+const SkBigPicture::CostData& SkBigPicture::costData() const {
+    fCostOnce([this] {
+        const int count = fRecord->count();
+        std::unique_ptr<CostData> data(new CostData);
+        data->fBounds.reset(count);
+        data->fOps.reset(count);
+        SkRecordFillBounds(fCullRect, *fRecord, data->fBounds.get());
+
+        SkOpCostCounter counter;
+        for (int i = 0; i < count; i++) {
+            data->fOps[i] = fRecord->visit(i, counter);
+        }
+        fCostData = std::move(data);
+    });
+    return *fCostData;
+}
+
+SkPicture::Cost SkBigPicture::approximateCost(const SkRect& region) const {
+    const CostData& data = this->costData();
+
+    Cost cost;
+    if (fBBH && !region.contains(fCullRect)) {
+        SkTDArray<int> ops;
+        fBBH->search(region, &ops);
+        for (int i : ops) {
+            data.fOps[i].addTo(data.fBounds[i], region, &cost);
+        }
+    } else {
+        for (int i = 0; i < fRecord->count(); i++) {
+            data.fOps[i].addTo(data.fBounds[i], region, &cost);
+        }
+    }
+    return cost;
+}
+
 int SkBigPicture::drawableCount() const {
     return fDrawablePicts ? fDrawablePicts->count() : 0;
 }
@@ -16,6 +16,7 @@
 class SkBBoxHierarchy;
 class SkMatrix;
 class SkRecord;
+struct SkOpCost;
 
 // An implementation of SkPicture supporting an arbitrary number of drawing commands.
 class SkBigPicture final : public SkPicture {
@@ -38,13 +39,14 @@ public:
                  SnapshotArray*,       // We take exclusive ownership.
                  SkBBoxHierarchy*,     // We take ownership of the caller's ref.
                  size_t approxBytesUsedBySubPictures);
-
+    ~SkBigPicture() override;
 
 // SkPicture overrides
     void playback(SkCanvas*, AbortCallback*) const override;
     SkRect cullRect() const override;
     int approximateOpCount() const override;
     size_t approximateBytesUsed() const override;
+    Cost approximateCost(const SkRect& region) const override;
     const SkBigPicture* asSkBigPicture() const override { return this; }
 
 // Used by GrLayerHoister
@@ -60,11 +62,18 @@ private:
     int drawableCount() const;
     SkPicture const* const* drawablePicts() const;
 
+    // Per-op bounds and costs, computed the first time approximateCost() is called rather than
+    // while recording, so pictures that are never asked pay nothing for them.
+    struct CostData;
+    const CostData& costData() const;
+
     const SkRect                         fCullRect;
     const size_t                         fApproxBytesUsedBySubPictures;
     sk_sp<const SkRecord>                fRecord;
     std::unique_ptr<const SnapshotArray> fDrawablePicts;
     sk_sp<const SkBBoxHierarchy>         fBBH;
+    mutable SkOnce                       fCostOnce;
+    mutable std::unique_ptr<CostData>    fCostData;
 };
 
 #endif//SkBigPicture_DEFINED
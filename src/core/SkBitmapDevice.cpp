@@ -11,7 +11,9 @@
 #include "SkImageFilterCache.h"
 #include "SkMallocPixelRef.h"
 #include "SkMakeUnique.h"
+#include "SkMathPriv.h"
 #include "SkMatrix.h"
+#include "SkMutex.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkPixelRef.h"
@@ -21,9 +23,13 @@
 #include "SkShader.h"
 #include "SkSpecialImage.h"
 #include "SkSurface.h"
+#include "SkTDArray.h"
+#include "SkTInternalLList.h"
 #include "SkTLazy.h"
 #include "SkVertices.h"
 
+#include <atomic>
+
 struct Bounder {
     SkRect  fBounds;
     bool    fHasBounds;
@@ -312,10 +318,246 @@ void SkBitmapDevice::replaceBitmapBackendForRasterSurface(const SkBitmap& bm) {
     this->privateResize(fBitmap.info().width(), fBitmap.info().height());
 }
 
+SkBitmapDevice::~SkBitmapDevice() {}
+
+// Idle layer pixel buffers, bucketed by size.  A buffer comes back to the pool when the last pixel
+// ref using it goes away rather than at restore(), as snapshots of a layer (like the special image
+// an image filter sees, which may then sit in the image filter cache) can outlive its device.
+// Every live pool is listed, so that PurgeLayerPools() can reach them.  All pools' idle buffers
+// count against one global limit, like the SkResourceCache budget.
+SK_DECLARE_STATIC_MUTEX(gLayerPoolsMutex);
+static std::atomic<size_t> gLayerPoolIdleBytes{0};
+static std::atomic<size_t> gLayerPoolByteLimit{SkBitmapDevice::kDefaultLayerPoolTotalByteLimit};
+
+class SkBitmapDevice::LayerPool : public SkRefCnt {
+public:
+    explicit LayerPool(size_t budget) : fBudget(budget) {
+        SkAutoMutexAcquire lock(gLayerPoolsMutex);
+        if (!gPools) {
+            gPools = new SkTInternalLList<LayerPool>;
+        }
+        gPools->addToHead(this);
+    }
+
+    ~LayerPool() override {
+        {
+            SkAutoMutexAcquire lock(gLayerPoolsMutex);
+            gPools->remove(this);
+        }
+        this->trim(0);
+    }
+
+    // Frees idle buffers from each pool in turn until all of them hold at most maxTotalBytes.
+    static void TrimAll(size_t maxTotalBytes) {
+        SkAutoMutexAcquire lock(gLayerPoolsMutex);
+        if (gPools) {
+            SkTInternalLList<LayerPool>::Iter iter;
+            iter.init(*gPools, SkTInternalLList<LayerPool>::Iter::kHead_IterStart);
+            for (LayerPool* pool = iter.get(); pool; pool = iter.next()) {
+                const size_t total = gLayerPoolIdleBytes.load();
+                if (total <= maxTotalBytes) {
+                    break;
+                }
+                pool->shrink(total - maxTotalBytes);
+            }
+        }
+    }
+
+    void setBudget(size_t budget) {
+        {
+            SkAutoMutexAcquire lock(fMutex);
+            fBudget = budget;
+        }
+        this->trim(budget);
+    }
+
+    int allocationCount() const { return fAllocationCount.load(std::memory_order_relaxed); }
+
+    bool allocPixels(const SkImageInfo& info, SkBitmap* bitmap) {
+        const size_t rowBytes = info.minRowBytes();
+        const size_t bytes = info.computeByteSize(rowBytes);
+        const bool poolable = !SkImageInfo::ByteSizeOverflowed(bytes) && bytes <= kMaxPooledBytes;
+        const int bucket = poolable ? Bucket(bytes) : 0;
+        void* block = nullptr;
+        size_t budget;
+        {
+            SkAutoMutexAcquire lock(fMutex);
+            budget = fBudget;
+            if (poolable && !fFree[bucket].isEmpty()) {
+                fFree[bucket].pop(&block);
+                fFreeBytes -= BucketBytes(bucket);
+                gLayerPoolIdleBytes -= BucketBytes(bucket);
+            }
+        }
+        if (block) {
+            if (!info.isOpaque()) {
+                sk_bzero(static_cast<char*>(block) + kHeaderBytes, bytes);
+            }
+        } else {
+            fAllocationCount.fetch_add(1, std::memory_order_relaxed);
+            if (!poolable || 0 == budget || 0 == gLayerPoolByteLimit.load()) {
+                // This buffer won't come back to the pool, so there's no point rounding it up.
+                return bitmap->tryAllocPixelsFlags(info, info.isOpaque()
+                                                         ? 0 : SkBitmap::kZeroPixels_AllocFlag);
+            }
+            // Transparent layers start cleared, as in Create(), and calloc() can often skip it.
+            const size_t blockBytes = kHeaderBytes + BucketBytes(bucket);
+            block = info.isOpaque() ? sk_malloc_canfail(blockBytes)
+                                    : sk_calloc_canfail(blockBytes);
+            if (!block) {
+                return false;
+            }
+            *static_cast<int*>(block) = bucket;
+        }
+
+        this->ref();
+        return bitmap->installPixels(info, static_cast<char*>(block) + kHeaderBytes, rowBytes,
+                                     Release, this);
+    }
+
+private:
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(LayerPool);
+
+    static SkTInternalLList<LayerPool>* gPools;     // guarded by gLayerPoolsMutex
+
+    // Each block starts with its bucket, padded to keep the pixels aligned as malloc() made them.
+    static constexpr size_t kHeaderBytes = 16;
+
+    // Buckets step by a quarter of the distance between powers of two, so a layer uses at least
+    // 80% of the buffer backing it.
+    static constexpr size_t kMaxPooledBytes = SK_MaxS32;
+    static constexpr int kBucketCount = 32 * 4;
+
+    static int Bucket(size_t bytes) {
+        bytes = SkTMax<size_t>(bytes, 8);
+        const int log2 = SkNextLog2(SkToU32(bytes));
+        const int shift = log2 - 3;
+        const size_t quarters = (bytes + (size_t(1) << shift) - 1) >> shift;    // 5 ... 8
+        return log2 * 4 + SkToInt(quarters) - 5;
+    }
+    static size_t BucketBytes(int bucket) {
+        return size_t(bucket % 4 + 5) << (bucket / 4 - 3);
+    }
+
+    static void Release(void* pixels, void* ctx) {
+        LayerPool* pool = static_cast<LayerPool*>(ctx);
+        void* block = static_cast<char*>(pixels) - kHeaderBytes;
+        const int bucket = *static_cast<int*>(block);
+        const size_t bytes = BucketBytes(bucket);
+        {
+            SkAutoMutexAcquire lock(pool->fMutex);
+            if (pool->fFreeBytes + bytes <= pool->fBudget && ReserveIdleBytes(bytes)) {
+                pool->fFree[bucket].push(block);
+                pool->fFreeBytes += bytes;
+                block = nullptr;
+            }
+        }
+        sk_free(block);
+        pool->unref();
+    }
+
+    // Counts bytes of newly idle buffers against the global limit, or returns false if they don't
+    // fit under it.
+    static bool ReserveIdleBytes(size_t bytes) {
+        if (gLayerPoolIdleBytes.fetch_add(bytes) + bytes <= gLayerPoolByteLimit.load()) {
+            return true;
+        }
+        gLayerPoolIdleBytes -= bytes;
+        return false;
+    }
+
+    // Frees idle buffers, largest first, until at most maxBytes of them are left.
+    void trim(size_t maxBytes) {
+        SkAutoMutexAcquire lock(fMutex);
+        this->trimLocked(maxBytes);
+    }
+
+    // Frees at least bytes of idle buffers, or all of them.
+    void shrink(size_t bytes) {
+        SkAutoMutexAcquire lock(fMutex);
+        this->trimLocked(fFreeBytes > bytes ? fFreeBytes - bytes : 0);
+    }
+
+    void trimLocked(size_t maxBytes) {
+        for (int bucket = kBucketCount - 1; bucket >= 0 && fFreeBytes > maxBytes; --bucket) {
+            while (!fFree[bucket].isEmpty() && fFreeBytes > maxBytes) {
+                void* block;
+                fFree[bucket].pop(&block);
+                fFreeBytes -= BucketBytes(bucket);
+                gLayerPoolIdleBytes -= BucketBytes(bucket);
+                sk_free(block);
+            }
+        }
+    }
+
+    SkMutex          fMutex;
+    SkTDArray<void*> fFree[kBucketCount];
+    size_t           fFreeBytes = 0;
+    size_t           fBudget;
+    std::atomic<int> fAllocationCount{0};
+};
+
+SkTInternalLList<SkBitmapDevice::LayerPool>* SkBitmapDevice::LayerPool::gPools = nullptr;
+
+constexpr size_t SkBitmapDevice::kDefaultLayerPoolTotalByteLimit;
+
+void SkBitmapDevice::setLayerPoolBudget(size_t bytes) {
+    fLayerPoolBudget = bytes;
+    if (fLayerPool) {
+        fLayerPool->setBudget(bytes);
+    }
+}
+
+int SkBitmapDevice::layerPoolAllocationCount() const {
+    return fLayerPool ? fLayerPool->allocationCount() : 0;
+}
+
+void SkBitmapDevice::PurgeLayerPools() {
+    LayerPool::TrimAll(0);
+}
+
+size_t SkBitmapDevice::GetLayerPoolTotalByteLimit() {
+    return gLayerPoolByteLimit.load();
+}
+
+size_t SkBitmapDevice::SetLayerPoolTotalByteLimit(size_t newLimit) {
+    const size_t prevLimit = gLayerPoolByteLimit.exchange(newLimit);
+    if (newLimit < prevLimit) {
+        LayerPool::TrimAll(newLimit);
+    }
+    return prevLimit;
+}
+
+size_t SkBitmapDevice::GetLayerPoolTotalBytesUsed() {
+    return gLayerPoolIdleBytes.load();
+}
+
 SkBaseDevice* SkBitmapDevice::onCreateDevice(const CreateInfo& cinfo, const SkPaint*) {
     const SkSurfaceProps surfaceProps(this->surfaceProps().flags(), cinfo.fPixelGeometry);
-    return SkBitmapDevice::Create(cinfo.fInfo, surfaceProps, cinfo.fTrackCoverage,
-                                  cinfo.fAllocator);
+    SkAlphaType newAT = cinfo.fInfo.alphaType();
+    SkBitmapDevice* device;
+    if (cinfo.fAllocator || cinfo.fTrackCoverage ||
+        kUnknown_SkColorType == cinfo.fInfo.colorType() ||
+        !valid_for_bitmap_device(cinfo.fInfo, &newAT)) {
+        device = SkBitmapDevice::Create(cinfo.fInfo, surfaceProps, cinfo.fTrackCoverage,
+                                        cinfo.fAllocator);
+        if (!device) {
+            return nullptr;
+        }
+    } else {
+        if (!fLayerPool) {
+            fLayerPool = sk_make_sp<LayerPool>(fLayerPoolBudget);
+        }
+        SkBitmap bitmap;
+        if (!fLayerPool->allocPixels(cinfo.fInfo.makeAlphaType(newAT), &bitmap)) {
+            return nullptr;
+        }
+        device = new SkBitmapDevice(bitmap, surfaceProps, nullptr, nullptr);
+        device->fLayerPool = fLayerPool;
+    }
+    device->fLayerPoolBudget = fLayerPoolBudget;
+    device->fImageFilterTileSize = fImageFilterTileSize;
+    return device;
 }
 
 bool SkBitmapDevice::onAccessPixels(SkPixmap* pmap) {
@@ -646,15 +888,48 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPain
     sk_sp<SkSpecialImage> filteredImage;
     SkTCopyOnFirstWrite<SkPaint> paint(origPaint);
 
+    if (paint->getMaskFilter()) {
+        paint.writable()->setMaskFilter(paint->getMaskFilter()->makeWithMatrix(this->ctm()));
+    }
+
     if (SkImageFilter* filter = paint->getImageFilter()) {
         SkIPoint offset = SkIPoint::Make(0, 0);
         const SkMatrix matrix = SkMatrix::Concat(
             SkMatrix::MakeTrans(SkIntToScalar(-x), SkIntToScalar(-y)), this->ctm());
         const SkIRect clipBounds = fRCStack.rc().getBounds().makeOffset(-x, -y);
-        sk_sp<SkImageFilterCache> cache(this->getImageFilterCache());
         SkImageFilter::OutputProperties outputProperties(fBitmap.colorSpace());
-        SkImageFilter::Context ctx(matrix, clipBounds, cache.get(), outputProperties);
 
+        const int tileSize = fImageFilterTileSize;
+        if (tileSize > 0 && !clipImage &&
+            (clipBounds.width() > tileSize || clipBounds.height() > tileSize) &&
+            filter->canFilterInTiles()) {
+            // Each tile pulls only the input it needs through the filters' bounds mapping. Its
+            // intermediates are keyed by the tile's clip bounds, so no other tile can use them:
+            // cache them just long enough for nodes shared within the tile to be reused.
+            sk_sp<SkImageFilterCache> tileCache(
+                    SkImageFilterCache::Create(SkImageFilterCache::kDefaultTransientSize));
+            paint.writable()->setImageFilter(nullptr);
+            for (int top = clipBounds.top(); top < clipBounds.bottom(); top += tileSize) {
+                for (int left = clipBounds.left(); left < clipBounds.right(); left += tileSize) {
+                    SkIRect tile = SkIRect::MakeXYWH(left, top, tileSize, tileSize);
+                    SkAssertResult(tile.intersect(clipBounds));
+                    SkImageFilter::Context ctx(matrix, tile, tileCache.get(), outputProperties);
+                    sk_sp<SkSpecialImage> tileImage = filter->filterImage(src, ctx, &offset);
+                    tileCache->purge();
+                    SkBitmap tileBM;
+                    if (!tileImage || !tileImage->getROPixels(&tileBM)) {
+                        continue;
+                    }
+                    // A filter may return pixels beyond its clip, so draw only this tile's.
+                    SkAutoDeviceClipRestore autoClipRestore(this, tile.makeOffset(x, y));
+                    this->drawSprite(tileBM, x + offset.x(), y + offset.y(), *paint);
+                }
+            }
+            return;
+        }
+
+        sk_sp<SkImageFilterCache> cache(this->getImageFilterCache());
+        SkImageFilter::Context ctx(matrix, clipBounds, cache.get(), outputProperties);
         filteredImage = filter->filterImage(src, ctx, &offset);
         if (!filteredImage) {
             return;
@@ -666,10 +941,6 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPain
         y += offset.y();
     }
 
-    if (paint->getMaskFilter()) {
-        paint.writable()->setMaskFilter(paint->getMaskFilter()->makeWithMatrix(this->ctm()));
-    }
-
     if (!clipImage) {
         SkBitmap resultBM;
         if (src->getROPixels(&resultBM)) {
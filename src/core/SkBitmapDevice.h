@@ -69,6 +69,55 @@ public:
         return fCoverage ? &fCoverage->pixmap() : nullptr;
     }
 
+    /**
+     *  If tileSize is positive, image filters whose output is wider or taller than tileSize are
+     *  evaluated one tileSize x tileSize tile at a time, when SkImageFilter::canFilterInTiles().
+     *  Every intermediate image is then bounded by the tile plus the margins its filters need.
+     *  The default, 0, evaluates each filter over its whole output at once.  Set this before
+     *  drawing to the device; the layer devices it makes for saveLayer() inherit it.
+     *
+     *  This is internal for now: neither SkSurfaceProps nor SkGraphics can turn it on, so only
+     *  code that makes its own SkBitmapDevice, like benches and tests, uses it.
+     */
+    void setImageFilterTileSize(int tileSize) { fImageFilterTileSize = SkTMax(tileSize, 0); }
+    int imageFilterTileSize() const { return fImageFilterTileSize; }
+
+    /**
+     *  Layers made by saveLayer() recycle their pixel buffers through a pool owned by the
+     *  top-level device and shared by every layer under it, so a buffer freed by one restore()
+     *  can back the next saveLayer() of a similar size, in this frame or the next.
+     *
+     *  The idle buffers of all pools together are limited by SetLayerPoolTotalByteLimit(), which
+     *  SkGraphics exposes.  This sets a further limit for this device's pool alone; by default
+     *  it has none.  0 turns pooling off.  Set this on the top-level device before drawing; the
+     *  layer devices it makes inherit it.
+     */
+    void setLayerPoolBudget(size_t bytes);
+    size_t layerPoolBudget() const { return fLayerPoolBudget; }
+
+    /**
+     *  How many pixel buffers this device's layers, and their layers, have allocated rather than
+     *  taken from the pool.
+     */
+    int layerPoolAllocationCount() const;
+
+    /**
+     *  Frees the idle buffers of every layer pool, as SkGraphics::PurgeAllCaches() does.
+     */
+    static void PurgeLayerPools();
+
+    /**
+     *  How many bytes of idle buffers all layer pools together may hold on to, 16MB by default.
+     *  Lowering the limit frees idle buffers until the pools fit.  These back SkGraphics'
+     *  Get/SetLayerPoolTotalByteLimit() and GetLayerPoolTotalBytesUsed().
+     */
+    static constexpr size_t kDefaultLayerPoolTotalByteLimit = 16 * 1024 * 1024;
+    static size_t GetLayerPoolTotalByteLimit();
+    static size_t SetLayerPoolTotalByteLimit(size_t newLimit);
+    static size_t GetLayerPoolTotalBytesUsed();
+
+    ~SkBitmapDevice() override;
+
 protected:
     void* getRasterHandle() const override { return fRasterHandle; }
 
@@ -159,6 +208,7 @@ private:
     friend class SkThreadedBMPDevice; // to copy fRCStack
 
     class BDDraw;
+    class LayerPool;
 
     // used to change the backend's pixels (and possibly config/rowbytes)
     // but cannot change the width/height, so there should be no change to
@@ -175,6 +225,9 @@ private:
     void*       fRasterHandle = nullptr;
     SkRasterClipStack  fRCStack;
     std::unique_ptr<SkBitmap> fCoverage;    // if non-null, will have the same dimensions as fBitmap
+    sk_sp<LayerPool> fLayerPool;            // lazily made by the top-level device, for its layers
+    size_t      fLayerPoolBudget = SIZE_MAX;
+    int         fImageFilterTileSize = 0;
 
     typedef SkBaseDevice INHERITED;
 };
@@ -51,6 +51,7 @@ protected:
     sk_sp<SkImageFilter> onMakeColorSpace(SkColorSpaceXformer*) const override;
     SkIRect onFilterNodeBounds(const SkIRect& src, const SkMatrix& ctm,
                                MapDirection, const SkIRect* inputRect) const override;
+    bool onCanFilterInTiles() const override { return true; }
 
 private:
     typedef SkImageFilter INHERITED;
@@ -390,6 +391,24 @@ static void blur_one_direction(Sk4u* buffer, int window,
     }
 }
 
+// Each line (a row for the horizontal pass, a column for the vertical one) is blurred
+// independently of the others, so blur the lines in bands.  The result is the same however the
+// lines are split.
+static void blur_one_direction_in_bands(const SkImageFilter::Context& ctx, int window,
+                                        int srcLeft, int srcRight, int dstRight,
+                                        const uint32_t* src, int srcXStride, int srcYStride,
+                                        int srcH,
+                                        uint32_t* dst, int dstXStride, int dstYStride) {
+    SkImageFilterPriv::ForEachBand(ctx, srcH, dstRight, [&](int first, int last) {
+        // The amount 1024 is enough for buffers up to 10 sigma.
+        SkSTArenaAlloc<1024> alloc;
+        Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(calculate_buffer(window));
+        blur_one_direction(buffer, window, srcLeft, srcRight, dstRight,
+                           src + first * srcYStride, srcXStride, srcYStride, last - first,
+                           dst + first * dstYStride, dstXStride, dstYStride);
+    });
+}
+
 static sk_sp<SkSpecialImage> copy_image_with_bounds(
         SkSpecialImage *source, const sk_sp<SkSpecialImage> &input,
         SkIRect srcBounds, SkIRect dstBounds) {
@@ -459,7 +478,7 @@ static sk_sp<SkSpecialImage> copy_image_with_bounds(
 static sk_sp<SkSpecialImage> cpu_blur(
         SkVector sigma,
         SkSpecialImage *source, const sk_sp<SkSpecialImage> &input,
-        SkIRect srcBounds, SkIRect dstBounds) {
+        SkIRect srcBounds, SkIRect dstBounds, const SkImageFilter::Context& ctx) {
     auto windowW = calculate_window(sigma.x()),
          windowH = calculate_window(sigma.y());
 
@@ -496,14 +515,6 @@ static sk_sp<SkSpecialImage> cpu_blur(
         return nullptr;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
-
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
-
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
     //     the destination. Then, do an in-place vertical blur.
@@ -544,16 +555,16 @@ static sk_sp<SkSpecialImage> cpu_blur(
         intermediateWidth = dstW;
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
-        blur_one_direction(
-                buffer, windowW,
+        blur_one_direction_in_bands(
+                ctx, windowW,
                 srcBounds.left(), srcBounds.right(), dstBounds.right(),
                 static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
                 intermediateSrc, 1, intermediateRowBytesAsPixels);
     }
 
     if (windowH > 1) {
-        blur_one_direction(
-                buffer, windowH,
+        blur_one_direction_in_bands(
+                ctx, windowH,
                 srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
                 intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
                 intermediateDst, dst.rowBytesAsPixels(), 1);
@@ -610,7 +621,7 @@ sk_sp<SkSpecialImage> SkBlurImageFilterImpl::onFilterImage(SkSpecialImage* sourc
     } else
 #endif
     {
-        result = cpu_blur(sigma, source, input, inputBounds, dstBounds);
+        result = cpu_blur(sigma, source, input, inputBounds, dstBounds, ctx);
     }
 
     // Return the resultOffset if the blur succeeded.
@@ -189,7 +189,26 @@ sk_sp<SkColorFilter> SkColorFilter::makeComposed(sk_sp<SkColorFilter> inner) con
         return composition;
     }
 
+    // Composition is associative, so we can also fold across the ends of existing compositions:
+    // this(o(i)) == (this o)(i), and (o(i))(inner) == o(i inner). That way a run of matrices or
+    // tables collapses to one filter however the calls that built it were nested.
     int count = inner->privateComposedFilterCount() + this->privateComposedFilterCount();
+    if (inner->privateComposedFilterCount() > 1) {
+        auto compose = static_cast<const SkComposeColorFilter*>(inner.get());
+        if (auto folded = this->onMakeComposed(compose->fOuter)) {
+            return folded->makeComposed(compose->fInner);
+        }
+    }
+    if (this->privateComposedFilterCount() > 1) {
+        auto compose = static_cast<const SkComposeColorFilter*>(this);
+        auto folded = compose->fInner->makeComposed(inner);
+        if (folded && folded->privateComposedFilterCount() <
+                      compose->fInner->privateComposedFilterCount() +
+                      inner->privateComposedFilterCount()) {
+            return compose->fOuter->makeComposed(std::move(folded));
+        }
+    }
+
     if (count > SK_MAX_COMPOSE_COLORFILTER_COUNT) {
         return nullptr;
     }
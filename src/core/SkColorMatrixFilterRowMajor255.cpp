@@ -6,6 +6,7 @@
  */
 
 #include "SkColorMatrixFilterRowMajor255.h"
+#include "SkBitmap.h"
 #include "SkColorData.h"
 #include "SkNx.h"
 #include "SkPM4fPriv.h"
@@ -13,6 +14,7 @@
 #include "SkReadBuffer.h"
 #include "SkRefCnt.h"
 #include "SkString.h"
+#include "SkTableColorFilter.h"
 #include "SkUnPreMultiply.h"
 #include "SkWriteBuffer.h"
 
@@ -163,6 +165,29 @@ void SkColorMatrixFilterRowMajor255::onAppendStages(SkRasterPipeline* p,
     if (!willStayOpaque) { p->append(SkRasterPipeline::premul); }
 }
 
+bool SkColorMatrixFilterRowMajor255::AsTables(const SkScalar matrix[20],
+                                              const SkBitmap* innerTables,
+                                              uint8_t tables[4][256]) {
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            if (i != j && matrix[j*5 + i] != 0) {
+                return false;
+            }
+        }
+    }
+    for (int j = 0; j < 4; ++j) {
+        const SkScalar scale = matrix[j*5 + j],
+                       trans = matrix[j*5 + 4];
+        const int row = (j + 1) & 3;
+        const uint8_t* inner = innerTables ? innerTables->getAddr8(0, row) : nullptr;
+        for (int i = 0; i < 256; ++i) {
+            const int x = inner ? inner[i] : i;
+            tables[row][i] = SkScalarRoundToInt(SkTPin(scale * x + trans, 0.0f, 255.0f));
+        }
+    }
+    return true;
+}
+
 sk_sp<SkColorFilter>
 SkColorMatrixFilterRowMajor255::onMakeComposed(sk_sp<SkColorFilter> innerFilter) const {
     SkScalar innerMatrix[20];
@@ -171,6 +196,14 @@ SkColorMatrixFilterRowMajor255::onMakeComposed(sk_sp<SkColorFilter> innerFilter)
         set_concat(concat, fMatrix, innerMatrix);
         return sk_make_sp<SkColorMatrixFilterRowMajor255>(concat);
     }
+
+    // If we scale and translate each component independently, we can fold into a table inner.
+    SkBitmap innerTables;
+    uint8_t tables[4][256];
+    if (innerFilter->asComponentTable(&innerTables) && innerTables.getPixels() &&
+        AsTables(fMatrix, &innerTables, tables)) {
+        return SkTableColorFilter::MakeARGB(tables[0], tables[1], tables[2], tables[3]);
+    }
     return nullptr;
 }
 
@@ -19,6 +19,14 @@ public:
     /** Creates a color matrix filter that returns the same value in all four channels. */
     static sk_sp<SkColorFilter> MakeSingleChannelOutput(const SkScalar row[5]);
 
+    /**
+     *  If matrix only scales and translates each component independently, fills tables[] in
+     *  A,R,G,B order, as asComponentTable() does, with matrix applied to innerTables (or to the
+     *  identity if innerTables is null), and returns true.
+     */
+    static bool AsTables(const SkScalar matrix[20], const SkBitmap* innerTables,
+                         uint8_t tables[4][256]);
+
     uint32_t getFlags() const override;
     bool asColorMatrix(SkScalar matrix[20]) const override;
     sk_sp<SkColorFilter> onMakeComposed(sk_sp<SkColorFilter>) const override;
@@ -8,6 +8,7 @@
 #include "SkDeferredDisplayList.h"
 
 #include "SkCanvas.h"
+#include "SkLiteDL.h"
 #include "SkSurface.h"
 
 SkDeferredDisplayList::SkDeferredDisplayList(const SkSurfaceCharacterization& characterization,
@@ -15,3 +16,11 @@ SkDeferredDisplayList::SkDeferredDisplayList(const SkSurfaceCharacterization& ch
         : fCharacterization(characterization)
         , fLazyProxyData(std::move(lazyProxyData)) {
 }
+
+SkDeferredDisplayList::SkDeferredDisplayList(const SkSurfaceCharacterization& characterization,
+                                             std::unique_ptr<SkLiteDL> rasterDL)
+        : fCharacterization(characterization)
+        , fRasterDL(std::move(rasterDL)) {
+}
+
+SkDeferredDisplayList::~SkDeferredDisplayList() {}
@@ -8,19 +8,165 @@
 #include "SkDeferredDisplayListRecorder.h"
 
 #include "SkDeferredDisplayList.h"
+#include "SkDraw.h"
+#include "SkFindAndPlaceGlyph.h"
+#include "SkImage_Base.h"
+#include "SkLiteDL.h"
+#include "SkLiteRecorder.h"
+#include "SkNoDrawCanvas.h"
+#include "SkStrikeCache.h"
 #include "SkSurface.h"
 #include "SkSurfaceCharacterization.h"
+#include "SkTextBlobRunIterator.h"
+
+namespace {
+
+// Plays a raster DDL's display list back before it is handed over, to do the parts of rasterization
+// that don't depend on the destination pixels on the recording thread: decoding lazy images and
+// rendering glyph masks.  Both end up in global caches that the real playback hits.
+class RasterDDLPrewarmer final : public SkNoDrawCanvas {
+public:
+    explicit RasterDDLPrewarmer(const SkSurfaceCharacterization& characterization)
+        : SkNoDrawCanvas(characterization.width(), characterization.height())
+        , fCharacterization(characterization) {}
+
+protected:
+    void onDrawText(const void* text, size_t len, SkScalar x, SkScalar y,
+                    const SkPaint& paint) override {
+        this->warmGlyphs(paint, [&](const SkMatrix& ctm, SkGlyphCache* cache) {
+            SkFindAndPlaceGlyph::ProcessText(paint.getTextEncoding(), (const char*)text, len,
+                                             {x, y}, ctm, paint.getTextAlign(), cache,
+                                             WarmOneGlyph{cache});
+        });
+    }
+    void onDrawPosText(const void* text, size_t len, const SkPoint pos[],
+                       const SkPaint& paint) override {
+        this->warmPosText(text, len, &pos->fX, 2, {0, 0}, paint);
+    }
+    void onDrawPosTextH(const void* text, size_t len, const SkScalar xpos[], SkScalar constY,
+                        const SkPaint& paint) override {
+        this->warmPosText(text, len, xpos, 1, {0, constY}, paint);
+    }
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                        const SkPaint& paint) override {
+        SkPaint runPaint = paint;
+        for (SkTextBlobRunIterator it(blob); !it.done(); it.next()) {
+            size_t len = it.glyphCount() * sizeof(uint16_t);
+            it.applyFontToPaint(&runPaint);
+            switch (it.positioning()) {
+                case SkTextBlob::kDefault_Positioning:
+                    this->onDrawText(it.glyphs(), len,
+                                     x + it.offset().x(), y + it.offset().y(), runPaint);
+                    break;
+                case SkTextBlob::kHorizontal_Positioning:
+                    this->warmPosText(it.glyphs(), len, it.pos(), 1,
+                                      {x, y + it.offset().y()}, runPaint);
+                    break;
+                case SkTextBlob::kFull_Positioning:
+                    this->warmPosText(it.glyphs(), len, it.pos(), 2, {x, y}, runPaint);
+                    break;
+            }
+        }
+    }
+
+    void onDrawImage(const SkImage* image, SkScalar, SkScalar, const SkPaint*) override {
+        this->warmImage(image);
+    }
+    void onDrawImageRect(const SkImage* image, const SkRect*, const SkRect&, const SkPaint*,
+                         SrcRectConstraint) override {
+        this->warmImage(image);
+    }
+    void onDrawImageNine(const SkImage* image, const SkIRect&, const SkRect&,
+                         const SkPaint*) override {
+        this->warmImage(image);
+    }
+    void onDrawImageLattice(const SkImage* image, const Lattice&, const SkRect&,
+                            const SkPaint*) override {
+        this->warmImage(image);
+    }
+
+private:
+    struct WarmOneGlyph {
+        void operator()(const SkGlyph& glyph, SkPoint, SkPoint) { (void)fCache->findImage(glyph); }
+        SkGlyphCache* fCache;
+    };
+
+    template <typename Fn>
+    void warmGlyphs(const SkPaint& paint, Fn&& fn) {
+        const SkMatrix& ctm = this->getTotalMatrix();
+        if (SkDraw::ShouldDrawTextAsPaths(paint, ctm)) {
+            return;
+        }
+        // Match SkDraw::scalerContextFlags() for a destination in our color space.
+        SkScalerContextFlags flags = fCharacterization.colorSpace()
+                                   ? SkScalerContextFlags::kBoostContrast
+                                   : SkScalerContextFlags::kFakeGammaAndBoostContrast;
+        auto cache = SkStrikeCache::FindOrCreateStrikeExclusive(
+                paint, &fCharacterization.surfaceProps(), flags, &ctm);
+        fn(ctm, cache.get());
+    }
+
+    void warmPosText(const void* text, size_t len, const SkScalar pos[], int scalarsPerPos,
+                     SkPoint offset, const SkPaint& paint) {
+        this->warmGlyphs(paint, [&](const SkMatrix& ctm, SkGlyphCache* cache) {
+            SkFindAndPlaceGlyph::ProcessPosText(paint.getTextEncoding(), (const char*)text, len,
+                                                offset, ctm, pos, scalarsPerPos, cache,
+                                                WarmOneGlyph{cache});
+        });
+    }
+
+    void warmImage(const SkImage* image) {
+        if (image->isLazyGenerated()) {
+            SkBitmap bm;
+            (void)as_IB(image)->getROPixels(&bm, fCharacterization.colorSpace());
+        }
+    }
+
+    const SkSurfaceCharacterization& fCharacterization;
+};
+
+}  // namespace
+
+SkCanvas* SkDeferredDisplayListRecorder::getRasterCanvas() {
+    SkASSERT(fCharacterization.isRaster());
+    if (!fRasterRecorder) {
+        fRasterDL.reset(new SkLiteDL);
+        fRasterRecorder.reset(new SkLiteRecorder);
+        fRasterRecorder->reset(fRasterDL.get(),
+                               SkIRect::MakeWH(fCharacterization.width(),
+                                               fCharacterization.height()));
+    }
+    // Once detached, fRasterDL belongs to the SkDeferredDisplayList.
+    return fRasterDL ? fRasterRecorder.get() : nullptr;
+}
+
+std::unique_ptr<SkDeferredDisplayList> SkDeferredDisplayListRecorder::detachRaster() {
+    if (!this->getRasterCanvas()) {
+        return nullptr;
+    }
+
+    RasterDDLPrewarmer prewarmer(fCharacterization);
+    fRasterDL->draw(&prewarmer);
+
+    return std::unique_ptr<SkDeferredDisplayList>(
+                           new SkDeferredDisplayList(fCharacterization, std::move(fRasterDL)));
+}
 
 #if !SK_SUPPORT_GPU
-SkDeferredDisplayListRecorder::SkDeferredDisplayListRecorder(const SkSurfaceCharacterization&) {}
+SkDeferredDisplayListRecorder::SkDeferredDisplayListRecorder(const SkSurfaceCharacterization& c)
+        : fCharacterization(c) {}
 
 SkDeferredDisplayListRecorder::~SkDeferredDisplayListRecorder() {}
 
 bool SkDeferredDisplayListRecorder::init() { return false; }
 
-SkCanvas* SkDeferredDisplayListRecorder::getCanvas() { return nullptr; }
+SkCanvas* SkDeferredDisplayListRecorder::getCanvas() {
+    return fCharacterization.isRaster() ? this->getRasterCanvas() : nullptr;
+}
 
-std::unique_ptr<SkDeferredDisplayList> SkDeferredDisplayListRecorder::detach() { return nullptr; }
+std::unique_ptr<SkDeferredDisplayList> SkDeferredDisplayListRecorder::detach() {
+    return fCharacterization.isRaster() ? this->detachRaster() : nullptr;
+}
 
 sk_sp<SkImage> SkDeferredDisplayListRecorder::makePromiseTexture(
         const GrBackendFormat& backendFormat,
@@ -50,7 +196,7 @@ sk_sp<SkImage> SkDeferredDisplayListRecorder::makePromiseTexture(
 
 SkDeferredDisplayListRecorder::SkDeferredDisplayListRecorder(const SkSurfaceCharacterization& c)
         : fCharacterization(c) {
-    if (fCharacterization.isValid()) {
+    if (fCharacterization.isValid() && !fCharacterization.isRaster()) {
         fContext = GrContextPriv::MakeDDL(fCharacterization.refContextInfo());
     }
 }
@@ -143,6 +289,9 @@ bool SkDeferredDisplayListRecorder::init() {
 }
 
 SkCanvas* SkDeferredDisplayListRecorder::getCanvas() {
+    if (fCharacterization.isRaster()) {
+        return this->getRasterCanvas();
+    }
     if (!fContext) {
         return nullptr;
     }
@@ -155,6 +304,9 @@ SkCanvas* SkDeferredDisplayListRecorder::getCanvas() {
 }
 
 std::unique_ptr<SkDeferredDisplayList> SkDeferredDisplayListRecorder::detach() {
+    if (fCharacterization.isRaster()) {
+        return this->detachRaster();
+    }
     if (!fContext) {
         return nullptr;
     }
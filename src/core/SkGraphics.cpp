@@ -7,6 +7,7 @@
 
 #include "SkGraphics.h"
 
+#include "SkBitmapDevice.h"
 #include "SkBlitter.h"
 #include "SkCanvas.h"
 #include "SkCpu.h"
@@ -59,6 +60,19 @@ void SkGraphics::PurgeAllCaches() {
     SkGraphics::PurgeFontCache();
     SkGraphics::PurgeResourceCache();
     SkImageFilter::PurgeCache();
+    SkBitmapDevice::PurgeLayerPools();
+}
+
+size_t SkGraphics::GetLayerPoolTotalByteLimit() {
+    return SkBitmapDevice::GetLayerPoolTotalByteLimit();
+}
+
+size_t SkGraphics::SetLayerPoolTotalByteLimit(size_t newLimit) {
+    return SkBitmapDevice::SetLayerPoolTotalByteLimit(newLimit);
+}
+
+size_t SkGraphics::GetLayerPoolTotalBytesUsed() {
+    return SkBitmapDevice::GetLayerPoolTotalBytesUsed();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
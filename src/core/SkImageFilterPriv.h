@@ -8,7 +8,9 @@
 #ifndef SkImageFilterPriv_DEFINED
 #define SkImageFilterPriv_DEFINED
 
+#include "SkExecutor.h"
 #include "SkImageFilter.h"
+#include "SkTaskGroup.h"
 
 /**
  *  Helper to unflatten the common data, and return nullptr if we fail.
@@ -21,4 +23,36 @@
         }                                                           \
     } while (0)
 
+class SkImageFilterPriv {
+public:
+    /**
+     *  For filters whose output lines (rows, or columns) can be computed independently of each
+     *  other: calls fn(first, last) over bands of lines that together cover [0, lines), on the
+     *  context's executor (or the default one) when there are enough pixels to make that
+     *  worthwhile, or once for all the lines on the calling thread otherwise.  Bands start at
+     *  multiples of alignment lines, for filters that work on several lines at once.
+     */
+    template <typename Fn>
+    static void ForEachBand(const SkImageFilter::Context& ctx, int lines, int lineLength,
+                            const Fn& fn, int alignment = 1) {
+        // Fewer pixels than this are filtered on the calling thread.
+        constexpr int64_t kMinPixelsToThread = 512 * 512;
+        constexpr int kMinLinesPerBand = 32;
+
+        const int bands = lines / SkTMax(kMinLinesPerBand, alignment);
+        if (bands < 2 || (int64_t)lines * lineLength < kMinPixelsToThread) {
+            fn(0, lines);
+            return;
+        }
+
+        SkExecutor& executor = ctx.executor() ? *ctx.executor() : SkExecutor::GetDefault();
+        SkTaskGroup(executor).batch(bands, [&](int i) {
+            const int first = lines *  i      / bands / alignment * alignment,
+                      last  = i + 1 == bands ? lines
+                                             : lines * (i + 1) / bands / alignment * alignment;
+            fn(first, last);
+        });
+    }
+};
+
 #endif
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkBBHFactory.h"
 #include "SkCanvas.h"
 #include "SkData.h"
 #include "SkDrawFilter.h"
@@ -46,6 +47,16 @@ static const D* pod(const T* op, size_t offset = 0) {
     return SkTAddOffset<const D>(op+1, offset);
 }
 
+// SkPath bounds and SkMatrix type masks are computed lazily and cached on first use.  We warm
+// those caches while recording so that concurrent calls to draw() only ever read them.
+static void precache(const SkPath& path) {
+    path.updateBoundsCache();
+    (void)path.getGenerationID();
+}
+static void precache(const SkMatrix& matrix) {
+    (void)matrix.getType();
+}
+
 namespace {
 #define TYPES(M)                                                               \
     M(SetDrawFilter) M(Flush) M(Save) M(Restore) M(SaveLayer)                   \
@@ -105,6 +116,7 @@ namespace {
             this->clipMask = sk_ref_sp(clipMask);
             this->clipMatrix = clipMatrix ? *clipMatrix : SkMatrix::I();
             this->flags = flags;
+            precache(this->clipMatrix);
         }
         SkRect                     bounds = kUnset;
         SkPaint                    paint;
@@ -120,13 +132,13 @@ namespace {
 
     struct Concat final : Op {
         static const auto kType = Type::Concat;
-        Concat(const SkMatrix& matrix) : matrix(matrix) {}
+        Concat(const SkMatrix& matrix) : matrix(matrix) { precache(this->matrix); }
         SkMatrix matrix;
         void draw(SkCanvas* c, const SkMatrix&) const { c->concat(matrix); }
     };
     struct SetMatrix final : Op {
         static const auto kType = Type::SetMatrix;
-        SetMatrix(const SkMatrix& matrix) : matrix(matrix) {}
+        SetMatrix(const SkMatrix& matrix) : matrix(matrix) { precache(this->matrix); }
         SkMatrix matrix;
         void draw(SkCanvas* c, const SkMatrix& original) const {
             c->setMatrix(SkMatrix::Concat(original, matrix));
@@ -143,7 +155,9 @@ namespace {
 
     struct ClipPath final : Op {
         static const auto kType = Type::ClipPath;
-        ClipPath(const SkPath& path, SkClipOp op, bool aa) : path(path), op(op), aa(aa) {}
+        ClipPath(const SkPath& path, SkClipOp op, bool aa) : path(path), op(op), aa(aa) {
+            precache(this->path);
+        }
         SkPath   path;
         SkClipOp op;
         bool     aa;
@@ -181,7 +195,9 @@ namespace {
     };
     struct DrawPath final : Op {
         static const auto kType = Type::DrawPath;
-        DrawPath(const SkPath& path, const SkPaint& paint) : path(path), paint(paint) {}
+        DrawPath(const SkPath& path, const SkPaint& paint) : path(path), paint(paint) {
+            precache(this->path);
+        }
         SkPath  path;
         SkPaint paint;
         void draw(SkCanvas* c, const SkMatrix&) const { c->drawPath(path, paint); }
@@ -250,6 +266,7 @@ namespace {
         static const auto kType = Type::DrawDrawable;
         DrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) : drawable(sk_ref_sp(drawable)) {
             if (matrix) { this->matrix = *matrix; }
+            precache(this->matrix);
         }
         sk_sp<SkDrawable> drawable;
         SkMatrix          matrix = SkMatrix::I();
@@ -263,6 +280,7 @@ namespace {
             : picture(sk_ref_sp(picture)) {
             if (matrix) { this->matrix = *matrix; }
             if (paint)  { this->paint  = *paint; has_paint = true; }
+            precache(this->matrix);
         }
         sk_sp<const SkPicture> picture;
         SkMatrix               matrix = SkMatrix::I();
@@ -384,6 +402,8 @@ namespace {
                        const SkMatrix* matrix, const SkPaint& paint)
             : bytes(bytes), path(path), paint(paint) {
             if (matrix) { this->matrix = *matrix; }
+            precache(this->path);
+            precache(this->matrix);
         }
         size_t   bytes;
         SkPath   path;
@@ -496,7 +516,9 @@ namespace {
         static const auto kType = Type::DrawShadowRec;
         DrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec)
             : fPath(path), fRec(rec)
-        {}
+        {
+            precache(fPath);
+        }
         SkPath          fPath;
         SkDrawShadowRec fRec;
         void draw(SkCanvas* c, const SkMatrix&) const {
@@ -505,8 +527,230 @@ namespace {
     };
 }
 
+// Computes conservative recording-space bounds for each op, in the same spirit as the FillBounds
+// visitor in SkRecordDraw.cpp: draws are bounded by their geometry adjusted for paint, and the
+// bounds of control ops (save, restore, matrix and clip changes) are the union of the bounds of
+// all draws inside their Save/Restore block.
+class LiteFillBounds : SkNoncopyable {
+public:
+    LiteFillBounds(const SkRect& cullRect, SkRect bounds[]) : fCullRect(cullRect), fBounds(bounds) {
+        // An extra save block tracks the bounds of any top-level control ops.
+        fSaveStack.push({ 0, SkRect::MakeEmpty(), nullptr, fCTM });
+    }
+
+    void cleanUp() {
+        // Simulate restores for any unbalanced saves, then let leftover control ops draw anywhere.
+        while (!fSaveStack.isEmpty()) {
+            this->popSaveBlock();
+        }
+        while (!fControlIndices.isEmpty()) {
+            this->popControl(fCullRect);
+        }
+    }
+
+    void setCurrentOp(int op) { fCurrentOp = op; }
+
+    void visit(const SetDrawFilter&) { this->pushControl(); }
+    void visit(const Save&)          { this->pushSaveBlock(nullptr); }
+    void visit(const SaveLayer& op)  { this->pushSaveBlock(&op.paint); }
+    void visit(const Restore&)       { fBounds[fCurrentOp] = this->popSaveBlock(); }
+
+    void visit(const Concat& op)     { fCTM.preConcat(op.matrix);        this->pushControl(); }
+    void visit(const SetMatrix& op)  { fCTM = op.matrix;                 this->pushControl(); }
+    void visit(const Translate& op)  { fCTM.preTranslate(op.dx, op.dy);  this->pushControl(); }
+    void visit(const ClipPath&)      { this->pushControl(); }
+    void visit(const ClipRect&)      { this->pushControl(); }
+    void visit(const ClipRRect&)     { this->pushControl(); }
+    void visit(const ClipRegion&)    { this->pushControl(); }
+
+    // Everything else draws, and we can compute its bounds right away.
+    template <typename T> void visit(const T& op) {
+        fBounds[fCurrentOp] = this->bounds(op);
+        this->updateSaveBounds(fBounds[fCurrentOp]);
+    }
+
+private:
+    struct SaveBounds {
+        int            controlOps;  // Number of control ops in this block, including the Save.
+        SkRect         bounds;      // Bounds of everything drawn in the block.
+        const SkPaint* paint;       // If set, adjusts the bounds of all ops in the block.
+        SkMatrix       ctm;         // The CTM at the Save, restored at the Restore.
+    };
+
+    // By default, assume an op can draw anywhere.
+    template <typename T> SkRect bounds(const T&) const { return fCullRect; }
+
+    SkRect bounds(const DrawRect&   op) const { return this->adjustAndMap(op.rect, &op.paint); }
+    SkRect bounds(const DrawOval&   op) const { return this->adjustAndMap(op.oval, &op.paint); }
+    SkRect bounds(const DrawArc&    op) const { return this->adjustAndMap(op.oval, &op.paint); }
+    SkRect bounds(const DrawRRect&  op) const {
+        return this->adjustAndMap(op.rrect.rect(), &op.paint);
+    }
+    SkRect bounds(const DrawDRRect& op) const {
+        return this->adjustAndMap(op.outer.rect(), &op.paint);
+    }
+    SkRect bounds(const DrawRegion& op) const {
+        return this->adjustAndMap(SkRect::Make(op.region.getBounds()), &op.paint);
+    }
+    SkRect bounds(const DrawPath& op) const {
+        return op.path.isInverseFillType() ? fCullRect
+                                           : this->adjustAndMap(op.path.getBounds(), &op.paint);
+    }
+    SkRect bounds(const DrawAnnotation& op) const { return this->adjustAndMap(op.rect, nullptr); }
+    SkRect bounds(const DrawDrawable& op) const {
+        SkRect dst = op.drawable->getBounds();
+        op.matrix.mapRect(&dst);
+        return this->adjustAndMap(dst, nullptr);
+    }
+    SkRect bounds(const DrawPicture& op) const {
+        SkRect dst = op.picture->cullRect();
+        op.matrix.mapRect(&dst);
+        return this->adjustAndMap(dst, op.has_paint ? &op.paint : nullptr);
+    }
+    SkRect bounds(const DrawImage& op) const {
+        SkRect dst = SkRect::MakeXYWH(op.x, op.y, op.image->width(), op.image->height());
+        return this->adjustAndMap(dst, &op.paint);
+    }
+    SkRect bounds(const DrawImageNine& op) const { return this->adjustAndMap(op.dst, &op.paint); }
+    SkRect bounds(const DrawImageRect& op) const { return this->adjustAndMap(op.dst, &op.paint); }
+    SkRect bounds(const DrawImageLattice& op) const {
+        return this->adjustAndMap(op.dst, &op.paint);
+    }
+    SkRect bounds(const DrawTextBlob& op) const {
+        SkRect dst = op.blob->bounds();
+        dst.offset(op.x, op.y);
+        return this->adjustAndMap(dst, &op.paint);
+    }
+    SkRect bounds(const DrawPatch& op) const {
+        SkRect dst;
+        dst.set(op.cubics, 12);
+        return this->adjustAndMap(dst, &op.paint);
+    }
+    SkRect bounds(const DrawPoints& op) const {
+        SkRect dst;
+        dst.set(pod<SkPoint>(&op), SkToInt(op.count));
+        // Pad a little so hairline points don't have empty bounds.
+        SkScalar stroke = SkMaxScalar(op.paint.getStrokeWidth(), 0.01f);
+        dst.outset(stroke/2, stroke/2);
+        return this->adjustAndMap(dst, &op.paint);
+    }
+    SkRect bounds(const DrawVertices& op) const {
+        return this->adjustAndMap(op.vertices->bounds(), &op.paint);
+    }
+    SkRect bounds(const DrawAtlas& op) const {
+        return maybe_unset(op.cull) ? this->adjustAndMap(op.cull, &op.paint) : fCullRect;
+    }
+
+    // Adjust a local-space rect for the paints that may affect it, then map it to recording space.
+    SkRect adjustAndMap(SkRect rect, const SkPaint* paint) const {
+        rect.sort();
+        if (!AdjustForPaint(paint, &rect)) {
+            return fCullRect;
+        }
+        fCTM.mapRect(&rect);
+
+        // Adjust for the paints of any save layers we're inside, each in its own space.
+        for (int i = fSaveStack.count() - 1; i >= 0; i--) {
+            const SaveBounds& sb = fSaveStack[i];
+            if (!sb.paint) {
+                continue;
+            }
+            SkMatrix inverse;
+            if (!sb.ctm.invert(&inverse)) {
+                return fCullRect;
+            }
+            inverse.mapRect(&rect);
+            if (!AdjustForPaint(sb.paint, &rect)) {
+                return fCullRect;
+            }
+            sb.ctm.mapRect(&rect);
+        }
+
+        if (!rect.intersect(fCullRect)) {
+            return SkRect::MakeEmpty();
+        }
+        return rect;
+    }
+
+    static bool AdjustForPaint(const SkPaint* paint, SkRect* rect) {
+        if (paint) {
+            if (!paint->canComputeFastBounds()) {
+                return false;
+            }
+            *rect = paint->computeFastBounds(*rect, rect);
+        }
+        return true;
+    }
+
+    static bool PaintMayAffectTransparentBlack(const SkPaint* paint) {
+        if (!paint) {
+            return false;
+        }
+        if (paint->getImageFilter() || paint->getColorFilter()) {
+            return true;
+        }
+        switch (paint->getBlendMode()) {
+            case SkBlendMode::kClear:
+            case SkBlendMode::kSrc:
+            case SkBlendMode::kSrcIn:
+            case SkBlendMode::kDstIn:
+            case SkBlendMode::kSrcOut:
+            case SkBlendMode::kDstATop:
+            case SkBlendMode::kModulate:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void pushSaveBlock(const SkPaint* paint) {
+        fSaveStack.push({ 0,
+                          PaintMayAffectTransparentBlack(paint) ? fCullRect : SkRect::MakeEmpty(),
+                          paint,
+                          fCTM });
+        this->pushControl();
+    }
+
+    SkRect popSaveBlock() {
+        SaveBounds sb;
+        fSaveStack.pop(&sb);
+        while (sb.controlOps --> 0) {
+            this->popControl(sb.bounds);
+        }
+        fCTM = sb.ctm;
+        this->updateSaveBounds(sb.bounds);
+        return sb.bounds;
+    }
+
+    void pushControl() {
+        fControlIndices.push(fCurrentOp);
+        if (!fSaveStack.isEmpty()) {
+            fSaveStack.top().controlOps++;
+        }
+    }
+
+    void popControl(const SkRect& bounds) {
+        fBounds[fControlIndices.top()] = bounds;
+        fControlIndices.pop();
+    }
+
+    void updateSaveBounds(const SkRect& bounds) {
+        if (!fSaveStack.isEmpty()) {
+            fSaveStack.top().bounds.join(bounds);
+        }
+    }
+
+    const SkRect         fCullRect;
+    SkRect*              fBounds;
+    int                  fCurrentOp = 0;
+    SkMatrix             fCTM = SkMatrix::I();
+    SkTDArray<SaveBounds> fSaveStack;
+    SkTDArray<int>        fControlIndices;
+};
+
 template <typename T, typename... Args>
 void* SkLiteDL::push(size_t pod, Args&&... args) {
+    this->dropBBH();
     size_t skip = SkAlignPtr(sizeof(T) + pod);
     SkASSERT(skip < (1<<24));
     if (fUsed + skip > fReserved) {
@@ -698,6 +942,7 @@ void SkLiteDL::drawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
 
 typedef void(*draw_fn)(const void*,  SkCanvas*, const SkMatrix&);
 typedef void(*void_fn)(const void*);
+typedef void(*bounds_fn)(const void*, LiteFillBounds*);
 
 // All ops implement draw().
 #define M(T) [](const void* op, SkCanvas* c, const SkMatrix& original) { \
@@ -719,9 +964,62 @@ static const draw_fn draw_fns[] = { TYPES(M) };
 static const void_fn dtor_fns[] = { TYPES(M) };
 #undef M
 
+#define M(T) [](const void* op, LiteFillBounds* fill) { fill->visit(*(const T*)op); },
+static const bounds_fn bounds_fns[] = { TYPES(M) };
+#undef M
+
 void SkLiteDL::draw(SkCanvas* canvas) const {
     SkAutoCanvasRestore acr(canvas, false);
-    this->map(draw_fns, canvas, canvas->getTotalMatrix());
+    const SkMatrix original = canvas->getTotalMatrix();
+
+    if (fBBH) {
+        // Like SkRecordDraw(), draw only the ops that may affect pixels inside the canvas' clip.
+        // getLocalClipBounds() maps that clip back into the space we recorded in.
+        SkTDArray<int> ops;
+        fBBH->search(canvas->getLocalClipBounds(), &ops);
+        for (int i : ops) {
+            auto op = (const Op*)(fBytes.get() + fOffsets[i]);
+            draw_fns[op->type](op, canvas, original);
+        }
+        return;
+    }
+    this->map(draw_fns, canvas, original);
+}
+
+void SkLiteDL::finish(const SkRect& cullRect, const SkBBHFactory* factory) {
+    this->dropBBH();
+    if (!factory) {
+        return;
+    }
+
+    auto end = fBytes.get() + fUsed;
+    for (const uint8_t* ptr = fBytes.get(); ptr < end; ) {
+        fOffsets.push(SkToU32(ptr - fBytes.get()));
+        ptr += ((const Op*)ptr)->skip;
+    }
+    if (fOffsets.isEmpty()) {
+        return;
+    }
+
+    SkAutoTMalloc<SkRect> bounds(fOffsets.count());
+    LiteFillBounds fill(cullRect, bounds.get());
+    for (int i = 0; i < fOffsets.count(); i++) {
+        auto op = (const Op*)(fBytes.get() + fOffsets[i]);
+        fill.setCurrentOp(i);
+        bounds_fns[op->type](op, &fill);
+    }
+    fill.cleanUp();
+
+    fBBH.reset((*factory)(cullRect));
+    SkASSERT(fBBH);
+    fBBH->insert(bounds.get(), fOffsets.count());
+}
+
+void SkLiteDL::dropBBH() {
+    if (fBBH) {
+        fBBH.reset();
+        fOffsets.reset();
+    }
 }
 
 SkLiteDL::~SkLiteDL() {
@@ -730,6 +1028,7 @@ SkLiteDL::~SkLiteDL() {
 
 void SkLiteDL::reset() {
     this->map(dtor_fns);
+    this->dropBBH();
 
     // Leave fBytes and fReserved alone.
     fUsed   = 0;
@@ -8,6 +8,7 @@
 #ifndef SkLiteDL_DEFINED
 #define SkLiteDL_DEFINED
 
+#include "SkBBoxHierarchy.h"
 #include "SkCanvas.h"
 #include "SkPaint.h"
 #include "SkPath.h"
@@ -16,14 +17,24 @@
 #include "SkTDArray.h"
 #include "SkTemplates.h"
 
+class SkBBHFactory;
+
 class SkLiteDL final {
 public:
     ~SkLiteDL();
 
+    // draw() does not modify the SkLiteDL, so one SkLiteDL may be drawn into several canvases
+    // from different threads at once, provided any SkDrawables it holds are safe to draw that way.
     void draw(SkCanvas* canvas) const;
 
+    // Optionally call once recording is done.  With a factory, builds a bounding box hierarchy
+    // over the ops (in recording space, limited to cullRect) so draw() can skip ops that land
+    // outside the canvas' clip.  Recording anything else or reset() discards the hierarchy.
+    void finish(const SkRect& cullRect, const SkBBHFactory* factory);
+
     void reset();
     bool empty() const { return fUsed == 0; }
+    bool hasBBH() const { return fBBH != nullptr; }
 
 #ifdef SK_SUPPORT_LEGACY_DRAWFILTER
     void setDrawFilter(SkDrawFilter*);
@@ -88,9 +99,15 @@ private:
     template <typename Fn, typename... Args>
     void map(const Fn[], Args...) const;
 
+    void dropBBH();
+
     SkAutoTMalloc<uint8_t> fBytes;
     size_t                 fUsed = 0;
     size_t                 fReserved = 0;
+
+    // Set by finish(): the BBH indexes ops by their position in fOffsets.
+    sk_sp<SkBBoxHierarchy> fBBH;
+    SkTDArray<uint32_t>    fOffsets;
 };
 
 #endif//SkLiteDL_DEFINED
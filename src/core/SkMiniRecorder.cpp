@@ -58,6 +58,12 @@ public:
     int    approximateOpCount()   const override { return 1; }
     SkRect cullRect()             const override { return fCull; }
 
+    Cost approximateCost(const SkRect& region) const override {
+        Cost cost;
+        SkOpCostCounter()(fOp).addTo(bounds(fOp), region, &cost);
+        return cost;
+    }
+
 private:
     SkRect fCull;
     T      fOp;
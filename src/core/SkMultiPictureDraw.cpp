@@ -9,6 +9,9 @@
 #include "SkCanvasPriv.h"
 #include "SkMultiPictureDraw.h"
 #include "SkPicture.h"
+#include "SkPixmap.h"
+#include "SkTArray.h"
+#include "SkTSort.h"
 #include "SkTaskGroup.h"
 
 void SkMultiPictureDraw::DrawData::draw() {
@@ -66,6 +69,61 @@ void SkMultiPictureDraw::add(SkCanvas* canvas,
     array.append()->init(canvas, picture, matrix, paint);
 }
 
+namespace {
+    // The range of memory a raster draw writes to.  Draws whose targets overlap must stay in order.
+    struct RasterTarget {
+        uintptr_t fBegin, fEnd;
+        int       fIndex;
+
+        bool operator<(const RasterTarget& that) const { return fBegin < that.fBegin; }
+    };
+}
+
+static RasterTarget find_raster_target(SkCanvas* canvas, int index) {
+    SkPixmap pm;
+    if (canvas->peekPixels(&pm) && pm.addr()) {
+        uintptr_t begin = (uintptr_t)pm.addr();
+        return { begin, begin + pm.computeByteSize(), index };
+    }
+    // Without access to the pixels, the best we can do is treat each canvas as its own target.
+    uintptr_t begin = (uintptr_t)canvas;
+    return { begin, begin + 1, index };
+}
+
+// Partitions draws into groups whose target pixels don't overlap, each listing its draws in order.
+static void group_by_raster_target(const SkTDArray<SkCanvas*>& canvases,
+                                   SkTArray<SkTDArray<int>>* groups) {
+    const int count = canvases.count();
+    if (0 == count) {
+        return;
+    }
+
+    SkAutoSTMalloc<32, RasterTarget> targets(count);
+    for (int i = 0; i < count; ++i) {
+        targets[i] = find_raster_target(canvases[i], i);
+    }
+    SkTQSort(targets.get(), targets.get() + count - 1);
+
+    // Sweep the sorted targets, starting a new group whenever a target begins past the end of
+    // everything we've seen so far.
+    SkAutoSTMalloc<32, int> groupOf(count);
+    int group = 0;
+    uintptr_t end = targets[0].fEnd;
+    for (int i = 0; i < count; ++i) {
+        if (targets[i].fBegin >= end) {
+            group++;
+        }
+        end = SkTMax(end, targets[i].fEnd);
+        groupOf[targets[i].fIndex] = group;
+    }
+
+    // Within a group, draws keep the order they were added in.
+    groups->reset(group + 1);
+    for (int i = 0; i < count; ++i) {
+        (*groups)[groupOf[i]].push(i);
+    }
+}
+
 class AutoMPDReset : SkNoncopyable {
     SkMultiPictureDraw* fMPD;
 public:
@@ -81,10 +139,26 @@ void SkMultiPictureDraw::draw(bool flush) {
 #ifdef FORCE_SINGLE_THREAD_DRAWING_FOR_TESTING
     for (int i = 0; i < fThreadSafeDrawData.count(); ++i) {
         fThreadSafeDrawData[i].draw();
+        if (flush) {
+            fThreadSafeDrawData[i].fCanvas->flush();
+        }
     }
 #else
-    SkTaskGroup().batch(fThreadSafeDrawData.count(), [&](int i) {
-        fThreadSafeDrawData[i].draw();
+    // Raster draws into independent pixels run concurrently on the default SkExecutor.
+    // Draws sharing a target are played back on one thread, in order.
+    SkTDArray<SkCanvas*> canvases;
+    for (const DrawData& data : fThreadSafeDrawData) {
+        *canvases.append() = data.fCanvas;
+    }
+    SkTArray<SkTDArray<int>> groups;
+    group_by_raster_target(canvases, &groups);
+    SkTaskGroup().batch(groups.count(), [&](int g) {
+        for (int i : groups[g]) {
+            fThreadSafeDrawData[i].draw();
+            if (flush) {
+                fThreadSafeDrawData[i].fCanvas->flush();
+            }
+        }
     });
 #endif
 
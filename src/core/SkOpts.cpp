@@ -73,6 +73,11 @@ namespace SkOpts {
     DEFINE_DEFAULT(grayA_to_rgbA);
     DEFINE_DEFAULT(inverted_CMYK_to_RGB1);
     DEFINE_DEFAULT(inverted_CMYK_to_BGR1);
+    DEFINE_DEFAULT(strip_16_to_8);
+    DEFINE_DEFAULT(index_to_n32);
+    DEFINE_DEFAULT(RGBA_to_565);
+    DEFINE_DEFAULT(BGRA_to_565);
+    DEFINE_DEFAULT(gather_32);
 
     DEFINE_DEFAULT(memset16);
     DEFINE_DEFAULT(memset32);
@@ -45,6 +45,16 @@ namespace SkOpts {
                         inverted_CMYK_to_RGB1, // i.e. convert color space
                         inverted_CMYK_to_BGR1; // i.e. convert color space
 
+    // Keep the most significant byte of each big-endian 16-bit component.
+    extern void (*strip_16_to_8)(uint8_t[], const void*, int);
+    // Look up each 8-bit index in a 256 entry color table.
+    extern void (*index_to_n32)(uint32_t[], const uint8_t[], int, const uint32_t ctable[]);
+    // Pack 8888 pixels into 565, dropping alpha.
+    extern void (*RGBA_to_565)(uint16_t[], const uint32_t[], int),
+                (*BGRA_to_565)(uint16_t[], const uint32_t[], int);
+    // Copy 32-bit pixels that are stride bytes apart to consecutive pixels.
+    extern void (*gather_32)(uint32_t[], const void*, int, int stride);
+
     extern void (*memset16)(uint16_t[], uint16_t, int);
     extern void SK_API (*memset32)(uint32_t[], uint32_t, int);
     extern void (*memset64)(uint64_t[], uint64_t, int);
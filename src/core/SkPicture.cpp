@@ -48,6 +48,10 @@ uint32_t SkPicture::uniqueID() const {
     return id;
 }
 
+SkPicture::Cost SkPicture::approximateCost(const SkRect&) const {
+    return Cost();
+}
+
 static const char kMagic[] = { 's', 'k', 'i', 'a', 'p', 'i', 'c', 't' };
 
 SkPictInfo SkPicture::createHeader() const {
@@ -11,8 +11,11 @@
 // Some shared code used by both SkBigPicture and SkMiniPicture.
 //   SkTextHunter   -- SkRecord visitor that returns true when the op draws text.
 //   SkPathCounter  -- SkRecord visitor that counts paths that draw slowly on the GPU.
+//   SkOpCostCounter -- SkRecord visitor that returns an SkOpCost describing each op.
 
+#include "SkMaskFilterBase.h"
 #include "SkPathEffect.h"
+#include "SkPicture.h"
 #include "SkRecords.h"
 #include "SkShader.h"
 #include "SkTLogic.h"
@@ -85,6 +88,143 @@ struct SkPathCounter {
     int fNumSlowPathsAndDashEffects;
 };
 
+// The software rasterization cost of a single op, independent of where it draws.
+struct SkOpCost {
+    int   fOps             = 0;  // Drawing ops, counting nested pictures' ops.
+    float fOverdraw        = 0;  // How many times each pixel in the op's bounds is touched.
+    int   fSaveLayers      = 0;
+    int   fBlurMaskFilters = 0;
+    int   fImageFilters    = 0;
+    int   fComplexPaths    = 0;
+    int   fPerspective     = 0;
+
+    // Accumulate this op's cost into cost, given its bounds and the region of interest.
+    void addTo(const SkRect& bounds, const SkRect& region, SkPicture::Cost* cost) const {
+        SkRect r;
+        if (!r.intersect(bounds, region)) {
+            return;
+        }
+        cost->fPixels          += (double)r.width() * (double)r.height() * fOverdraw;
+        cost->fOps             += fOps;
+        cost->fSaveLayers      += fSaveLayers;
+        cost->fBlurMaskFilters += fBlurMaskFilters;
+        cost->fImageFilters    += fImageFilters;
+        cost->fComplexPaths    += fComplexPaths;
+        cost->fPerspective     += fPerspective;
+    }
+};
+
+// Visit ops in order: we track the CTM to notice ops drawn with perspective.
+class SkOpCostCounter {
+public:
+    SkOpCost operator()(const SkRecords::Restore& op) {
+        fCTM = op.matrix;
+        return SkOpCost();
+    }
+    SkOpCost operator()(const SkRecords::SetMatrix& op) {
+        fCTM = op.matrix;
+        return SkOpCost();
+    }
+    SkOpCost operator()(const SkRecords::Concat& op) {
+        fCTM.preConcat(op.matrix);
+        return SkOpCost();
+    }
+    SkOpCost operator()(const SkRecords::Translate& op) {
+        fCTM.preTranslate(op.dx, op.dy);
+        return SkOpCost();
+    }
+
+    SkOpCost operator()(const SkRecords::ClipPath& op) {
+        SkOpCost cost;
+        cost.fComplexPaths = !op.path.isConvex();
+        return cost;
+    }
+
+    SkOpCost operator()(const SkRecords::SaveLayer& op) {
+        // The layer's contents are costed by the ops inside it; this is the final composite.
+        SkOpCost cost = this->paintCost(SkPathCounter::AsPtr(op.paint));
+        cost.fSaveLayers++;
+        if (op.backdrop) {
+            cost.fImageFilters++;
+        }
+        return cost;
+    }
+
+    SkOpCost operator()(const SkRecords::DrawPath& op) {
+        SkOpCost cost = this->paintCost(&op.paint);
+        if (!op.path.isConvex() && !cost.fComplexPaths) {
+            cost.fComplexPaths++;
+        }
+        return cost;
+    }
+
+    SkOpCost operator()(const SkRecords::DrawShadowRec& op) {
+        // Shadows are blurred, and their geometry is as complex as the occluder's.
+        SkOpCost cost = this->paintCost(nullptr);
+        cost.fBlurMaskFilters++;
+        cost.fComplexPaths = !op.path.isConvex();
+        return cost;
+    }
+
+    SkOpCost operator()(const SkRecords::DrawPicture& op) {
+        SkOpCost cost = this->paintCost(SkPathCounter::AsPtr(op.paint));
+        if (op.matrix.hasPerspective()) {
+            cost.fPerspective = 1;
+        }
+
+        const SkRect cull = op.picture->cullRect();
+        const SkPicture::Cost sub = op.picture->approximateCost(cull);
+        const double area = (double)cull.width() * (double)cull.height();
+        cost.fOps             = SkTMax(sub.fOps, 1);
+        cost.fOverdraw        = area > 0 ? (float)(sub.fPixels / area) : 1.0f;
+        cost.fSaveLayers      += sub.fSaveLayers;
+        cost.fBlurMaskFilters += sub.fBlurMaskFilters;
+        cost.fImageFilters    += sub.fImageFilters;
+        cost.fComplexPaths    += sub.fComplexPaths;
+        cost.fPerspective     += sub.fPerspective;
+        return cost;
+    }
+
+    template <typename T>
+    SK_WHEN((T::kTags & SkRecords::kDrawWithPaint_Tag) == SkRecords::kDrawWithPaint_Tag, SkOpCost)
+    operator()(const T& op) {
+        return this->paintCost(SkPathCounter::AsPtr(op.paint));
+    }
+
+    template <typename T>
+    SK_WHEN((T::kTags & SkRecords::kDrawWithPaint_Tag) == SkRecords::kDraw_Tag, SkOpCost)
+    operator()(const T&) {
+        return this->paintCost(nullptr);
+    }
+
+    template <typename T>
+    SK_WHEN(!(T::kTags & SkRecords::kDraw_Tag), SkOpCost) operator()(const T&) {
+        return SkOpCost();
+    }
+
+private:
+    SkOpCost paintCost(const SkPaint* paint) const {
+        SkOpCost cost;
+        cost.fOps = 1;
+        cost.fOverdraw = 1;
+        cost.fPerspective = fCTM.hasPerspective();
+        if (paint) {
+            if (paint->getMaskFilter() && as_MFB(paint->getMaskFilter())->asABlur(nullptr)) {
+                cost.fBlurMaskFilters++;
+            }
+            if (paint->getImageFilter()) {
+                cost.fImageFilters++;
+            }
+            if (paint->getPathEffect()) {
+                cost.fComplexPaths++;
+            }
+        }
+        return cost;
+    }
+
+    SkMatrix fCTM = SkMatrix::I();
+};
+
 sk_sp<SkImage> ImageDeserializer_SkDeserialImageProc(const void*, size_t, void* imagedeserializer);
 
 bool SkPicture_StreamIsSKP(SkStream*, SkPictInfo*);
@@ -37,6 +37,16 @@ public:
     SkCanvas* beginWrite(const SkRect& cullBounds, SkWStream*);
     void endWrite();
 
+    /**
+     *  Like beginWrite()/endWrite(), but the frame's ops are buffered until endFrame(), and then
+     *  written as copy/patch records against the previous frame written this way. Consecutive
+     *  frames of an animation are usually nearly identical, so this can be much smaller.
+     *
+     *  The deserializer must play back every frame, in order, to be able to reconstruct the next.
+     */
+    SkCanvas* beginFrame(const SkRect& cullBounds, SkWStream*);
+    void endFrame();
+
 private:
     class Impl;
     std::unique_ptr<Impl> fImpl;
@@ -86,6 +86,7 @@
     M(clamp_x_1) M(mirror_x_1) M(repeat_x_1)                       \
     M(evenly_spaced_gradient)                                      \
     M(gradient)                                                    \
+    M(binary_search_gradient)                                      \
     M(evenly_spaced_2_stop_gradient)                               \
     M(xy_to_unit_angle)                                            \
     M(xy_to_radius)                                                \
@@ -101,7 +102,8 @@
     M(byte_tables) M(byte_tables_rgb)                              \
     M(rgb_to_hsl) M(hsl_to_rgb)                                    \
     M(clut_3D) M(clut_4D)                                          \
-    M(gauss_a_to_rgba)
+    M(gauss_a_to_rgba)                                             \
+    M(perlin_noise)
 
 class SkRasterPipeline {
 public:
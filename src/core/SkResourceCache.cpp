@@ -9,10 +9,12 @@
 #include "SkMessageBus.h"
 #include "SkMipMap.h"
 #include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkOpts.h"
 #include "SkResourceCache.h"
 #include "SkTraceMemoryDump.h"
 
+#include <atomic>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -190,20 +192,19 @@ void SkResourceCache::remove(Rec* rec) {
 }
 
 void SkResourceCache::purgeAsNeeded(bool forcePurge) {
-    size_t byteLimit;
-    int    countLimit;
-
-    if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
-        byteLimit = SK_MaxU32;  // no limit based on bytes
+    if (forcePurge) {
+        this->purgeToLimits(0, 0);
+    } else if (fDiscardableFactory) {
+        this->purgeToLimits(SK_MaxU32, SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT);
     } else {
-        countLimit = SK_MaxS32; // no limit based on count
-        byteLimit = fTotalByteLimit;
+        this->purgeToLimits(fTotalByteLimit, SK_MaxS32);
     }
+}
 
+void SkResourceCache::purgeToLimits(size_t byteLimit, int countLimit) {
     Rec* rec = fTail;
     while (rec) {
-        if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
+        if (fTotalBytesUsed < byteLimit && fCount < countLimit) {
             break;
         }
 
@@ -440,91 +441,225 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkResourceCache* gResourceCache = nullptr;
+// The global cache is split into kSegmentCount independently locked SkResourceCaches, chosen by
+// key hash. Each segment has a slice of the global budget, but may borrow unused budget from the
+// others: segments are only trimmed back to their slice once the cache as a whole is over budget.
+namespace {
 
-/** Must hold gMutex when calling. */
-static SkResourceCache* get_cache() {
-    // gMutex is always held when this is called, so we don't need to be fancy in here.
-    gMutex.assertHeld();
-    if (nullptr == gResourceCache) {
+class GlobalCache {
+public:
+    GlobalCache() {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        fDiscardableFactory = SkDiscardableMemory::Create;
+        fTotalByteLimit = 0;
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        fDiscardableFactory = nullptr;
+        fTotalByteLimit = SK_DEFAULT_IMAGE_CACHE_LIMIT;
 #endif
+        fSingleAllocationByteLimit = 0;
+        fTotalBytesUsed = 0;
+        fCount = 0;
+        for (Segment& segment : fSegments) {
+            segment.fCache = fDiscardableFactory ? new SkResourceCache(fDiscardableFactory)
+                                                 : new SkResourceCache(fTotalByteLimit);
+        }
     }
+
+    // Calls fn(SkResourceCache*) on the segment holding key, and returns what it returns.
+    template <typename Fn>
+    auto withSegment(const SkResourceCache::Key& key, Fn&& fn) -> decltype(fn(nullptr)) {
+        // SkTHashTable indexes with the low bits of the hash, so select with the high bits.
+        return this->withSegment(key.hash() >> (32 - kSegmentBits), std::forward<Fn>(fn));
+    }
+
+    template <typename Fn>
+    auto withSegment(int index, Fn&& fn) -> decltype(fn(nullptr)) {
+        Segment& segment = fSegments[index];
+        SkAutoMutexAcquire am(segment.fMutex);
+        Accounting accounting(this, segment.fCache);
+        return fn(segment.fCache);
+    }
+
+    template <typename Fn>
+    void forEachSegment(Fn&& fn) {
+        for (int i = 0; i < kSegmentCount; ++i) {
+            this->withSegment(i, fn);
+        }
+    }
+
+    // Trims segments back to their slices until the cache as a whole is within budget.
+    void purgeAsNeeded() {
+        for (int i = 0; i < kSegmentCount && this->isOverBudget(); ++i) {
+            size_t byteSlice = SK_MaxU32;
+            int countSlice = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / kSegmentCount;
+            if (!fDiscardableFactory) {
+                byteSlice = fTotalByteLimit.load() / kSegmentCount;
+                countSlice = SK_MaxS32;
+            }
+            this->withSegment(i, [=](SkResourceCache* cache) {
+                cache->purgeToLimits(byteSlice, countSlice);
+            });
+        }
+    }
+
+    size_t setTotalByteLimit(size_t newLimit) {
+        size_t prevLimit = fTotalByteLimit.exchange(newLimit);
+        // No single segment may use more than the whole budget.
+        this->forEachSegment([=](SkResourceCache* cache) {
+            cache->setTotalByteLimit(newLimit);
+        });
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+    size_t getEffectiveSingleAllocationByteLimit() const {
+        size_t limit = fSingleAllocationByteLimit;
+        if (nullptr == fDiscardableFactory) {
+            limit = 0 == limit ? fTotalByteLimit.load() : SkTMin(limit, fTotalByteLimit.load());
+        }
+        return limit;
+    }
+
+    SkResourceCache::DiscardableFactory fDiscardableFactory;
+    std::atomic<size_t> fTotalByteLimit;
+    std::atomic<size_t> fSingleAllocationByteLimit;
+    std::atomic<size_t> fTotalBytesUsed;
+    std::atomic<int>    fCount;
+
+private:
+    static constexpr int kSegmentBits = 3;
+    static constexpr int kSegmentCount = 1 << kSegmentBits;
+
+    struct Segment {
+        SkMutex          fMutex;
+        SkResourceCache* fCache;
+    };
+
+    // Folds any change in a segment's usage into the global totals.
+    class Accounting {
+    public:
+        Accounting(GlobalCache* global, const SkResourceCache* cache)
+            : fGlobal(global)
+            , fCache(cache)
+            , fBytesUsed(cache->getTotalBytesUsed())
+            , fCount(cache->getCount()) {}
+
+        ~Accounting() {
+            // Most finds change nothing, so skip the atomics when we can.
+            if (fCache->getCount() != fCount || fCache->getTotalBytesUsed() != fBytesUsed) {
+                fGlobal->fTotalBytesUsed += fCache->getTotalBytesUsed() - fBytesUsed;
+                fGlobal->fCount += fCache->getCount() - fCount;
+            }
+        }
+
+    private:
+        GlobalCache*           fGlobal;
+        const SkResourceCache* fCache;
+        size_t                 fBytesUsed;
+        int                    fCount;
+    };
+
+    bool isOverBudget() const {
+        if (fDiscardableFactory) {
+            return fCount >= SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+        }
+        return fTotalBytesUsed >= fTotalByteLimit;
+    }
+
+    Segment fSegments[kSegmentCount];
+};
+
+}  // namespace
+
+// Set when a shared ID purge is posted, until the next Add() has every segment read its inbox.
+static std::atomic<bool> gPurgeSharedIDPending{false};
+
+static GlobalCache* get_cache() {
+    static GlobalCache* gResourceCache;
+    static SkOnce once;
+    once([] { gResourceCache = new GlobalCache; });
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->getTotalBytesUsed();
+    return get_cache()->fTotalBytesUsed;
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->getTotalByteLimit();
+    return get_cache()->fTotalByteLimit;
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->discardableFactory();
+    return get_cache()->fDiscardableFactory;
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->newCachedData(bytes);
+    // Allocating doesn't touch any segment, so there's no need to lock one.
+    if (auto factory = get_cache()->fDiscardableFactory) {
+        SkDiscardableMemory* dm = factory(bytes);
+        return dm ? new SkCachedData(bytes, dm) : nullptr;
+    }
+    return new SkCachedData(sk_malloc_throw(bytes), bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->dump();
+    GlobalCache* global = get_cache();
+    global->forEachSegment([](SkResourceCache* cache) { cache->dump(); });
+    SkDebugf("SkResourceCache: total count=%d bytes=%zu\n",
+             global->fCount.load(), global->fTotalBytesUsed.load());
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->setSingleAllocationByteLimit(size);
+    return get_cache()->fSingleAllocationByteLimit.exchange(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->getSingleAllocationByteLimit();
+    return get_cache()->fSingleAllocationByteLimit;
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->purgeAll();
+    get_cache()->forEachSegment([](SkResourceCache* cache) { cache->purgeAll(); });
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->find(key, visitor, context);
+    return get_cache()->withSegment(key, [&](SkResourceCache* cache) {
+        return cache->find(key, visitor, context);
+    });
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->add(rec, payload);
+    GlobalCache* global = get_cache();
+    global->withSegment(rec->getKey(), [=](SkResourceCache* cache) {
+        cache->add(rec, payload);
+    });
+    // Each segment only reads its inbox when it's used.  Purge posted shared IDs from all of them
+    // on the next add, as the unsegmented cache did, so no segment holds onto them indefinitely.
+    if (gPurgeSharedIDPending.exchange(false)) {
+        global->forEachSegment([](SkResourceCache* cache) { cache->checkMessages(); });
+    }
+    global->purgeAsNeeded();
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->visitAll(visitor, context);
+    get_cache()->forEachSegment([=](SkResourceCache* cache) {
+        cache->visitAll(visitor, context);
+    });
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
     if (sharedID) {
         SkMessageBus<PurgeSharedIDMessage>::Post(PurgeSharedIDMessage(sharedID));
+        gPurgeSharedIDPending.store(true);
     }
 }
 
@@ -25,6 +25,8 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is split by key hash into independently locked segments,
+ *  so threads working on unrelated keys do not contend with each other.
  */
 class SkResourceCache {
 public:
@@ -223,6 +225,7 @@ public:
 
     size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
     size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    int getCount() const { return fCount; }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -244,10 +247,22 @@ public:
 
     void purgeSharedID(uint64_t sharedID);
 
+    /**
+     *  Purge the Recs whose shared IDs were posted with PostPurgeSharedID() since the last call.
+     *  find() and add() do this first themselves.
+     */
+    void checkMessages();
+
     void purgeAll() {
         this->purgeAsNeeded(true);
     }
 
+    /**
+     *  Purge the least recently used Recs until fewer than byteLimit bytes and fewer than
+     *  countLimit Recs remain (or until only Recs that cannot be purged are left).
+     */
+    void purgeToLimits(size_t byteLimit, int countLimit);
+
     DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
 
     SkCachedData* newCachedData(size_t bytes);
@@ -273,7 +288,6 @@ private:
 
     SkMessageBus<PurgeSharedIDMessage>::Inbox fPurgeSharedIDInbox;
 
-    void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
 
     // linklist management
@@ -33,6 +33,14 @@ bool SkSurfaceCharacterization::operator==(const SkSurfaceCharacterization& othe
 }
 
 SkSurfaceCharacterization SkSurfaceCharacterization::createResized(int width, int height) const {
+    if (this->isRaster()) {
+        SkSurfaceCharacterization resized;
+        if (width > 0 && height > 0) {
+            resized.setRaster(fImageInfo.makeWH(width, height), fSurfaceProps);
+        }
+        return resized;
+    }
+
     const GrCaps* caps = fContextInfo->priv().caps();
     if (!caps) {
         return SkSurfaceCharacterization();
@@ -49,4 +57,22 @@ SkSurfaceCharacterization SkSurfaceCharacterization::createResized(int width, in
                                      fSurfaceProps);
 }
 
+#else
+
+bool SkSurfaceCharacterization::operator==(const SkSurfaceCharacterization& other) const {
+    if (!this->isValid() || !other.isValid()) {
+        return false;
+    }
+
+    return fImageInfo == other.fImageInfo && fSurfaceProps == other.fSurfaceProps;
+}
+
+SkSurfaceCharacterization SkSurfaceCharacterization::createResized(int width, int height) const {
+    SkSurfaceCharacterization resized;
+    if (this->isValid() && width > 0 && height > 0) {
+        resized.setRaster(fImageInfo.makeWH(width, height), fSurfaceProps);
+    }
+    return resized;
+}
+
 #endif
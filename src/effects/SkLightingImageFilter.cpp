@@ -11,9 +11,11 @@
 #include "SkColorSpaceXformer.h"
 #include "SkFlattenablePriv.h"
 #include "SkImageFilterPriv.h"
+#include "SkNx.h"
 #include "SkPoint3.h"
 #include "SkReadBuffer.h"
 #include "SkSpecialImage.h"
+#include "SkTemplates.h"
 #include "SkTypes.h"
 #include "SkWriteBuffer.h"
 
@@ -59,16 +61,6 @@ static void setUniformNormal3(const GrGLSLProgramDataManager& pdman, UniformHand
 }
 #endif
 
-// Shift matrix components to the left, as we advance pixels to the right.
-static inline void shiftMatrixLeft(int m[9]) {
-    m[0] = m[1];
-    m[3] = m[4];
-    m[6] = m[7];
-    m[1] = m[2];
-    m[4] = m[5];
-    m[7] = m[8];
-}
-
 static inline void fast_normalize(SkPoint3* vector) {
     // add a tiny bit so we don't have to worry about divide-by-zero
     SkScalar magSq = vector->dot(*vector) + SK_ScalarNearlyZero;
@@ -78,6 +70,56 @@ static inline void fast_normalize(SkPoint3* vector) {
     vector->fZ *= scale;
 }
 
+// Four SkPoint3s, one per lane, for lighting four adjacent pixels at once.
+struct Point3x4 {
+    Sk4f fX, fY, fZ;
+
+    Sk4f dot(const Point3x4& v) const { return fX * v.fX + fY * v.fY + fZ * v.fZ; }
+};
+
+// Lane for lane the same as sk_float_rsqrt(): with SSE both are the rsqrtps estimate, and with
+// NEON both refine the vrsqrte estimate with one vrsqrts step.  SkNx's portable fallback takes an
+// exact 1/sqrt instead, so there we call sk_float_rsqrt() a lane at a time.
+static inline Sk4f rsqrt(const Sk4f& x) {
+#if !defined(SKNX_NO_SIMD) && \
+    (SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2 || defined(SK_ARM_HAS_NEON))
+    return x.rsqrt();
+#else
+    return { sk_float_rsqrt(x[0]), sk_float_rsqrt(x[1]),
+             sk_float_rsqrt(x[2]), sk_float_rsqrt(x[3]) };
+#endif
+}
+
+static inline void fast_normalize(Point3x4* vector) {
+    Sk4f scale = rsqrt(vector->dot(*vector) + SK_ScalarNearlyZero);
+    vector->fX *= scale;
+    vector->fY *= scale;
+    vector->fZ *= scale;
+}
+
+// There's no vector pow, so these are computed a lane at a time.
+static inline Sk4f pow4(const Sk4f& x, SkScalar y) {
+    return { SkScalarPow(x[0], y), SkScalarPow(x[1], y),
+             SkScalarPow(x[2], y), SkScalarPow(x[3], y) };
+}
+
+// These match SkScalarClampMax() and SkClampMax(SkScalarRoundToInt(), 255) lane for lane,
+// NaNs included.
+static inline Sk4f clamp_max(const Sk4f& x, SkScalar max) {
+    Sk4f v = (x < max).thenElse(x, max);
+    return (v > 0).thenElse(v, 0);
+}
+
+static inline Sk4f round_to_byte(const Sk4f& x) {
+    return clamp_max((x + 0.5f).floor(), 255);
+}
+
+static inline Sk4u pack_pixels(const Sk4f& a, const Sk4f& r, const Sk4f& g, const Sk4f& b) {
+    auto byte = [](const Sk4f& v) { return SkNx_cast<uint32_t>(SkNx_cast<uint8_t>(v)); };
+    return byte(a) << SK_A32_SHIFT | byte(r) << SK_R32_SHIFT |
+           byte(g) << SK_G32_SHIFT | byte(b) << SK_B32_SHIFT;
+}
+
 static SkPoint3 read_point3(SkReadBuffer& buffer) {
     SkPoint3 point;
     point.fX = buffer.readScalar();
@@ -165,6 +207,14 @@ public:
                             SkClampMax(SkScalarRoundToInt(color.fY), 255),
                             SkClampMax(SkScalarRoundToInt(color.fZ), 255));
     }
+    Sk4u light(const Point3x4& normal, const Point3x4& surfaceTolight,
+               const Point3x4& lightColor) const {
+        Sk4f colorScale = clamp_max(fKD * normal.dot(surfaceTolight), SK_Scalar1);
+        return pack_pixels(255,
+                           round_to_byte(lightColor.fX * colorScale),
+                           round_to_byte(lightColor.fY * colorScale),
+                           round_to_byte(lightColor.fZ * colorScale));
+    }
 private:
     SkScalar fKD;
 };
@@ -190,6 +240,19 @@ public:
                             SkClampMax(SkScalarRoundToInt(color.fY), 255),
                             SkClampMax(SkScalarRoundToInt(color.fZ), 255));
     }
+    Sk4u light(const Point3x4& normal, const Point3x4& surfaceTolight,
+               const Point3x4& lightColor) const {
+        Point3x4 halfDir(surfaceTolight);
+        halfDir.fZ = halfDir.fZ + SK_Scalar1;
+        fast_normalize(&halfDir);
+        Sk4f colorScale = clamp_max(fKS * pow4(normal.dot(halfDir), fShininess), SK_Scalar1);
+        Sk4f r = lightColor.fX * colorScale,
+             g = lightColor.fY * colorScale,
+             b = lightColor.fZ * colorScale;
+        Sk4f max = (r > g).thenElse((r > b).thenElse(r, b), (g > b).thenElse(g, b));
+        return pack_pixels(round_to_byte(max), round_to_byte(r), round_to_byte(g),
+                           round_to_byte(b));
+    }
 private:
     SkScalar fKS;
     SkScalar fShininess;
@@ -261,128 +324,105 @@ static inline SkPoint3 bottomRightNormal(int m[9], SkScalar surfaceScale) {
 }
 
 
-class UncheckedPixelFetcher {
-public:
-    static inline uint32_t Fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
-        return SkGetPackedA32(*src.getAddr32(x, y));
-    }
-};
+typedef SkPoint3 (*NormalProc)(int m[9], SkScalar surfaceScale);
 
-// The DecalPixelFetcher is used when the destination crop rect exceeds the input bitmap bounds.
-class DecalPixelFetcher {
-public:
-    static inline uint32_t Fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
-        if (x < bounds.fLeft || x >= bounds.fRight || y < bounds.fTop || y >= bounds.fBottom) {
-            return 0;
-        } else {
-            return SkGetPackedA32(*src.getAddr32(x, y));
-        }
-    }
+// Indexed by the kind of row (top, interior, bottom) then column (left, interior, right).
+static const NormalProc gNormalProcs[3][3] = {
+    { topLeftNormal,    topNormal,      topRightNormal    },
+    { leftNormal,       interiorNormal, rightNormal       },
+    { bottomLeftNormal, bottomNormal,   bottomRightNormal },
 };
 
-template <class PixelFetcher>
-static void lightBitmap(const BaseLightingType& lightingType,
-                 const SkImageFilterLight* l,
-                 const SkBitmap& src,
-                 SkBitmap* dst,
-                 SkScalar surfaceScale,
-                 const SkIRect& bounds) {
-    SkASSERT(dst->width() == bounds.width() && dst->height() == bounds.height());
-    int left = bounds.left(), right = bounds.right();
-    int bottom = bounds.bottom();
-    int y = bounds.top();
-    SkIRect srcBounds = src.bounds();
-    SkPMColor* dptr = dst->getAddr32(0, 0);
-    {
-        int x = left;
-        int m[9];
-        m[4] = PixelFetcher::Fetch(src, x,     y,     srcBounds);
-        m[5] = PixelFetcher::Fetch(src, x + 1, y,     srcBounds);
-        m[7] = PixelFetcher::Fetch(src, x,     y + 1, srcBounds);
-        m[8] = PixelFetcher::Fetch(src, x + 1, y + 1, srcBounds);
-        SkPoint3 surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(topLeftNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-        for (++x; x < right - 1; ++x)
-        {
-            shiftMatrixLeft(m);
-            m[5] = PixelFetcher::Fetch(src, x + 1, y,     srcBounds);
-            m[8] = PixelFetcher::Fetch(src, x + 1, y + 1, srcBounds);
-            surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-            *dptr++ = lightingType.light(topNormal(m, surfaceScale), surfaceToLight,
-                                         l->lightColor(surfaceToLight));
+// Reads the alpha of count pixels of row y starting at left.  Pixels outside src are transparent.
+static void fetch_alpha_row(const SkBitmap& src, int y, int left, int count, SkScalar* row) {
+    if (y < 0 || y >= src.height()) {
+        memset(row, 0, count * sizeof(SkScalar));
+        return;
+    }
+    const SkPMColor* pixels = src.getAddr32(0, y);
+    for (int i = 0; i < count; ++i) {
+        int x = left + i;
+        row[i] = x >= 0 && x < src.width() ? SkIntToScalar(SkGetPackedA32(pixels[x])) : 0;
+    }
+}
+
+// Lights rows [top, bottom) of bounds.  The left and right columns go through the scalar
+// normal procs above; everything between is lit four pixels at a time.
+template <typename LightingType, typename LightType>
+static void lightRows(const LightingType& lightingType,
+                      const LightType& light,
+                      const SkBitmap& src,
+                      SkBitmap* dst,
+                      SkScalar surfaceScale,
+                      const SkIRect& bounds,
+                      int top, int bottom) {
+    const int left = bounds.left(), right = bounds.right();
+    // Each row holds the alpha of every column of bounds, and of one more on either side.
+    const int rowWidth = bounds.width() + 2;
+    SkAutoTMalloc<SkScalar> rows(3 * rowWidth);
+    SkScalar* up   = rows.get();
+    SkScalar* mid  = up + rowWidth;
+    SkScalar* down = mid + rowWidth;
+    fetch_alpha_row(src, top - 1, left - 1, rowWidth, up);
+    fetch_alpha_row(src, top,     left - 1, rowWidth, mid);
+
+    for (int y = top; y < bottom; ++y) {
+        fetch_alpha_row(src, y + 1, left - 1, rowWidth, down);
+
+        // The top and bottom rows ignore the row beyond them, and weigh the rest differently.
+        const int rowKind = y == bounds.top() ? 0 : y == bounds.bottom() - 1 ? 2 : 1;
+        const SkScalar* u = rowKind == 0 ? mid : up;
+        const SkScalar* d = rowKind == 2 ? mid : down;
+        const SkScalar upWeight   = rowKind == 0 ? 0 : SK_Scalar1;
+        const SkScalar downWeight = rowKind == 2 ? 0 : SK_Scalar1;
+        const SkScalar scaleX = rowKind == 1 ? gOneQuarter : gOneThird;
+        const SkScalar scaleY = rowKind == 1 ? gOneQuarter : gOneHalf;
+        SkPMColor* dptr = dst->getAddr32(0, y - bounds.top());
+
+        auto lightPixel = [&](int x, int columnKind) {
+            const int i = x - left + 1;
+            int m[9];
+            for (int j = 0; j < 3; ++j) {
+                m[j]     = SkScalarTruncToInt(u[i - 1 + j]);
+                m[3 + j] = SkScalarTruncToInt(mid[i - 1 + j]);
+                m[6 + j] = SkScalarTruncToInt(d[i - 1 + j]);
+            }
+            SkPoint3 normal = gNormalProcs[rowKind][columnKind](m, surfaceScale);
+            SkPoint3 surfaceToLight = light.surfaceToLight(x, y, m[4], surfaceScale);
+            dptr[x - left] = lightingType.light(normal, surfaceToLight,
+                                                light.lightColor(surfaceToLight));
+        };
+
+        lightPixel(left, 0);
+        int x = left + 1;
+        for (; x + 4 <= right - 1; x += 4) {
+            const int i = x - left + 1;
+            const SkScalar* ui = u + i;
+            const SkScalar* mi = mid + i;
+            const SkScalar* di = d + i;
+            Sk4f ul = Sk4f::Load(ui - 1), uc = Sk4f::Load(ui), ur = Sk4f::Load(ui + 1),
+                 ml = Sk4f::Load(mi - 1), mc = Sk4f::Load(mi), mr = Sk4f::Load(mi + 1),
+                 dl = Sk4f::Load(di - 1), dc = Sk4f::Load(di), dr = Sk4f::Load(di + 1);
+            // The same Sobel sums as the normal procs; they're small integers, so exact.
+            Sk4f nx = ((ur - ul) * upWeight + (mr - ml) * 2 + (dr - dl) * downWeight) * scaleX;
+            Sk4f ny = ((dl - ul) + (dc - uc) * 2 + (dr - ur)) * scaleY;
+            Point3x4 normal = { -nx * surfaceScale, -ny * surfaceScale, SK_Scalar1 };
+            fast_normalize(&normal);
+
+            Sk4f xs = SkIntToScalar(x) + Sk4f(0, 1, 2, 3);
+            Point3x4 surfaceToLight = light.surfaceToLight(xs, y, mc, surfaceScale);
+            lightingType.light(normal, surfaceToLight, light.lightColor(surfaceToLight))
+                        .store(dptr + x - left);
         }
-        shiftMatrixLeft(m);
-        surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(topRightNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-    }
-
-    for (++y; y < bottom - 1; ++y) {
-        int x = left;
-        int m[9];
-        m[1] = PixelFetcher::Fetch(src, x,     y - 1, srcBounds);
-        m[2] = PixelFetcher::Fetch(src, x + 1, y - 1, srcBounds);
-        m[4] = PixelFetcher::Fetch(src, x,     y,     srcBounds);
-        m[5] = PixelFetcher::Fetch(src, x + 1, y,     srcBounds);
-        m[7] = PixelFetcher::Fetch(src, x,     y + 1, srcBounds);
-        m[8] = PixelFetcher::Fetch(src, x + 1, y + 1, srcBounds);
-        SkPoint3 surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(leftNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-        for (++x; x < right - 1; ++x) {
-            shiftMatrixLeft(m);
-            m[2] = PixelFetcher::Fetch(src, x + 1, y - 1, srcBounds);
-            m[5] = PixelFetcher::Fetch(src, x + 1, y,     srcBounds);
-            m[8] = PixelFetcher::Fetch(src, x + 1, y + 1, srcBounds);
-            surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-            *dptr++ = lightingType.light(interiorNormal(m, surfaceScale), surfaceToLight,
-                                         l->lightColor(surfaceToLight));
+        for (; x < right - 1; ++x) {
+            lightPixel(x, 1);
         }
-        shiftMatrixLeft(m);
-        surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(rightNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-    }
+        lightPixel(right - 1, 2);
 
-    {
-        int x = left;
-        int m[9];
-        m[1] = PixelFetcher::Fetch(src, x,     bottom - 2, srcBounds);
-        m[2] = PixelFetcher::Fetch(src, x + 1, bottom - 2, srcBounds);
-        m[4] = PixelFetcher::Fetch(src, x,     bottom - 1, srcBounds);
-        m[5] = PixelFetcher::Fetch(src, x + 1, bottom - 1, srcBounds);
-        SkPoint3 surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(bottomLeftNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-        for (++x; x < right - 1; ++x)
-        {
-            shiftMatrixLeft(m);
-            m[2] = PixelFetcher::Fetch(src, x + 1, bottom - 2, srcBounds);
-            m[5] = PixelFetcher::Fetch(src, x + 1, bottom - 1, srcBounds);
-            surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-            *dptr++ = lightingType.light(bottomNormal(m, surfaceScale), surfaceToLight,
-                                         l->lightColor(surfaceToLight));
-        }
-        shiftMatrixLeft(m);
-        surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-        *dptr++ = lightingType.light(bottomRightNormal(m, surfaceScale), surfaceToLight,
-                                     l->lightColor(surfaceToLight));
-    }
-}
-
-static void lightBitmap(const BaseLightingType& lightingType,
-                 const SkImageFilterLight* light,
-                 const SkBitmap& src,
-                 SkBitmap* dst,
-                 SkScalar surfaceScale,
-                 const SkIRect& bounds) {
-    if (src.bounds().contains(bounds)) {
-        lightBitmap<UncheckedPixelFetcher>(
-            lightingType, light, src, dst, surfaceScale, bounds);
-    } else {
-        lightBitmap<DecalPixelFetcher>(
-            lightingType, light, src, dst, surfaceScale, bounds);
+        SkScalar* recycled = up;
+        up = mid;
+        mid = down;
+        down = recycled;
     }
 }
 
@@ -841,6 +881,12 @@ public:
         return fDirection;
     }
     SkPoint3 lightColor(const SkPoint3&) const override { return this->color(); }
+    Point3x4 surfaceToLight(const Sk4f& x, int y, const Sk4f& z, SkScalar surfaceScale) const {
+        return { fDirection.fX, fDirection.fY, fDirection.fZ };
+    }
+    Point3x4 lightColor(const Point3x4&) const {
+        return { this->color().fX, this->color().fY, this->color().fZ };
+    }
     LightType type() const override { return kDistant_LightType; }
     const SkPoint3& direction() const { return fDirection; }
     GrGLLight* createGLLight() const override {
@@ -902,6 +948,16 @@ public:
         return direction;
     }
     SkPoint3 lightColor(const SkPoint3&) const override { return this->color(); }
+    Point3x4 surfaceToLight(const Sk4f& x, int y, const Sk4f& z, SkScalar surfaceScale) const {
+        Point3x4 direction = { fLocation.fX - x,
+                               fLocation.fY - SkIntToScalar(y),
+                               fLocation.fZ - z * surfaceScale };
+        fast_normalize(&direction);
+        return direction;
+    }
+    Point3x4 lightColor(const Point3x4&) const {
+        return { this->color().fX, this->color().fY, this->color().fZ };
+    }
     LightType type() const override { return kPoint_LightType; }
     const SkPoint3& location() const { return fLocation; }
     GrGLLight* createGLLight() const override {
@@ -1016,15 +1072,20 @@ public:
         return direction;
     }
     SkPoint3 lightColor(const SkPoint3& surfaceToLight) const override {
-        SkScalar cosAngle = -surfaceToLight.dot(fS);
-        SkScalar scale = 0;
-        if (cosAngle >= fCosOuterConeAngle) {
-            scale = SkScalarPow(cosAngle, fSpecularExponent);
-            if (cosAngle < fCosInnerConeAngle) {
-                scale *= (cosAngle - fCosOuterConeAngle) * fConeScale;
-            }
-        }
-        return this->color().makeScale(scale);
+        return this->color().makeScale(this->coneFalloff(-surfaceToLight.dot(fS)));
+    }
+    Point3x4 surfaceToLight(const Sk4f& x, int y, const Sk4f& z, SkScalar surfaceScale) const {
+        Point3x4 direction = { fLocation.fX - x,
+                               fLocation.fY - SkIntToScalar(y),
+                               fLocation.fZ - z * surfaceScale };
+        fast_normalize(&direction);
+        return direction;
+    }
+    Point3x4 lightColor(const Point3x4& surfaceToLight) const {
+        Sk4f cosAngle = -surfaceToLight.dot({ fS.fX, fS.fY, fS.fZ });
+        Sk4f scale = { this->coneFalloff(cosAngle[0]), this->coneFalloff(cosAngle[1]),
+                       this->coneFalloff(cosAngle[2]), this->coneFalloff(cosAngle[3]) };
+        return { this->color().fX * scale, this->color().fY * scale, this->color().fZ * scale };
     }
     GrGLLight* createGLLight() const override {
 #if SK_SUPPORT_GPU
@@ -1099,6 +1160,17 @@ protected:
     }
 
 private:
+    SkScalar coneFalloff(SkScalar cosAngle) const {
+        SkScalar scale = 0;
+        if (cosAngle >= fCosOuterConeAngle) {
+            scale = SkScalarPow(cosAngle, fSpecularExponent);
+            if (cosAngle < fCosInnerConeAngle) {
+                scale *= (cosAngle - fCosOuterConeAngle) * fConeScale;
+            }
+        }
+        return scale;
+    }
+
     static const SkScalar kSpecularExponentMin;
     static const SkScalar kSpecularExponentMax;
 
@@ -1119,6 +1191,37 @@ private:
 const SkScalar SkSpotLight::kSpecularExponentMin = 1.0f;
 const SkScalar SkSpotLight::kSpecularExponentMax = 128.0f;
 
+template <typename LightingType>
+static void lightBitmap(const LightingType& lightingType,
+                        const SkImageFilterLight* light,
+                        const SkBitmap& src,
+                        SkBitmap* dst,
+                        SkScalar surfaceScale,
+                        const SkIRect& bounds,
+                        const SkImageFilter::Context& ctx) {
+    SkASSERT(dst->width() == bounds.width() && dst->height() == bounds.height());
+    SkASSERT(bounds.width() >= 2 && bounds.height() >= 2);
+
+    // Every row is independent, so light the rows in bands.
+    SkImageFilterPriv::ForEachBand(ctx, bounds.height(), bounds.width(), [&](int first, int last) {
+        const int top = bounds.fTop + first, bottom = bounds.fTop + last;
+        switch (light->type()) {
+            case SkImageFilterLight::kDistant_LightType:
+                lightRows(lightingType, static_cast<const SkDistantLight&>(*light),
+                          src, dst, surfaceScale, bounds, top, bottom);
+                break;
+            case SkImageFilterLight::kPoint_LightType:
+                lightRows(lightingType, static_cast<const SkPointLight&>(*light),
+                          src, dst, surfaceScale, bounds, top, bottom);
+                break;
+            case SkImageFilterLight::kSpot_LightType:
+                lightRows(lightingType, static_cast<const SkSpotLight&>(*light),
+                          src, dst, surfaceScale, bounds, top, bottom);
+                break;
+        }
+    });
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkImageFilterLight::flattenLight(SkWriteBuffer& buffer) const {
@@ -1349,12 +1452,7 @@ sk_sp<SkSpecialImage> SkDiffuseLightingImageFilter::onFilterImage(SkSpecialImage
     sk_sp<SkImageFilterLight> transformedLight(light()->transform(matrix));
 
     DiffuseLightingType lightingType(fKD);
-    lightBitmap(lightingType,
-                                                             transformedLight.get(),
-                                                             inputBM,
-                                                             &dst,
-                                                             surfaceScale(),
-                                                             bounds);
+    lightBitmap(lightingType, transformedLight.get(), inputBM, &dst, surfaceScale(), bounds, ctx);
 
     return SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(bounds.width(), bounds.height()),
                                           dst);
@@ -1503,12 +1601,7 @@ sk_sp<SkSpecialImage> SkSpecularLightingImageFilter::onFilterImage(SkSpecialImag
 
     sk_sp<SkImageFilterLight> transformedLight(light()->transform(matrix));
 
-    lightBitmap(lightingType,
-                                                              transformedLight.get(),
-                                                              inputBM,
-                                                              &dst,
-                                                              surfaceScale(),
-                                                              bounds);
+    lightBitmap(lightingType, transformedLight.get(), inputBM, &dst, surfaceScale(), bounds, ctx);
 
     return SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(bounds.width(), bounds.height()), dst);
 }
@@ -11,8 +11,10 @@
 #include "SkColorSpaceXformer.h"
 #include "SkFlattenablePriv.h"
 #include "SkImageFilterPriv.h"
+#include "SkNx.h"
 #include "SkReadBuffer.h"
 #include "SkSpecialImage.h"
+#include "SkTemplates.h"
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
 #include "SkUnPreMultiply.h"
@@ -27,6 +29,45 @@
 // by the size of a scalar to know how many scalars we can read.
 static const int32_t gMaxKernelSize = SK_MaxS32 / sizeof(SkScalar);
 
+// If the kernel is the outer product of a row and a column divided by some amount, write the
+// row's kernelSize.width() weights to separated, followed by the column's kernelSize.height()
+// weights and then that divisor, and return true.  Otherwise return false.
+static bool separate_kernel(const SkISize& kernelSize, const SkScalar* kernel,
+                            SkScalar* separated) {
+    const int w = kernelSize.width(), h = kernelSize.height();
+    int pivot = 0;
+    for (int i = 1; i < w * h; ++i) {
+        if (SkScalarAbs(kernel[i]) > SkScalarAbs(kernel[pivot])) {
+            pivot = i;
+        }
+    }
+    if (kernel[pivot] == 0) {
+        return false;
+    }
+
+    // Take the row and column through the largest weight as they are, and divide by that weight
+    // at the end; integer kernels then sum exactly, as they do when not separated.
+    SkScalar* row = separated;
+    SkScalar* col = separated + w;
+    for (int x = 0; x < w; ++x) {
+        row[x] = kernel[pivot / w * w + x];
+    }
+    for (int y = 0; y < h; ++y) {
+        col[y] = kernel[y * w + pivot % w];
+    }
+    separated[w + h] = kernel[pivot];
+
+    const SkScalar tolerance = SkScalarAbs(kernel[pivot]) * 1e-6f;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (SkScalarAbs(col[y] * row[x] / kernel[pivot] - kernel[y * w + x]) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 SkMatrixConvolutionImageFilter::SkMatrixConvolutionImageFilter(const SkISize& kernelSize,
                                                                const SkScalar* kernel,
                                                                SkScalar gain,
@@ -46,6 +87,14 @@ SkMatrixConvolutionImageFilter::SkMatrixConvolutionImageFilter(const SkISize& ke
     size_t size = (size_t) sk_64_mul(fKernelSize.width(), fKernelSize.height());
     fKernel = new SkScalar[size];
     memcpy(fKernel, kernel, size * sizeof(SkScalar));
+    fSeparableKernel = nullptr;
+    if (kernelSize.fWidth > 1 && kernelSize.fHeight > 1) {
+        fSeparableKernel = new SkScalar[kernelSize.fWidth + kernelSize.fHeight + 1];
+        if (!separate_kernel(kernelSize, kernel, fSeparableKernel)) {
+            delete[] fSeparableKernel;
+            fSeparableKernel = nullptr;
+        }
+    }
     SkASSERT(kernelSize.fWidth >= 1 && kernelSize.fHeight >= 1);
     SkASSERT(kernelOffset.fX >= 0 && kernelOffset.fX < kernelSize.fWidth);
     SkASSERT(kernelOffset.fY >= 0 && kernelOffset.fY < kernelSize.fHeight);
@@ -129,15 +178,9 @@ void SkMatrixConvolutionImageFilter::flatten(SkWriteBuffer& buffer) const {
 
 SkMatrixConvolutionImageFilter::~SkMatrixConvolutionImageFilter() {
     delete[] fKernel;
+    delete[] fSeparableKernel;
 }
 
-class UncheckedPixelFetcher {
-public:
-    static inline SkPMColor fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
-        return *src.getAddr32(x, y);
-    }
-};
-
 class ClampPixelFetcher {
 public:
     static inline SkPMColor fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
@@ -231,21 +274,143 @@ void SkMatrixConvolutionImageFilter::filterPixels(const SkBitmap& src,
     }
 }
 
+// The interior loops below work on all four channels of a pixel at once, in memory order.
+static constexpr int kA = SK_A32_SHIFT / 8,
+                     kR = SK_R32_SHIFT / 8,
+                     kG = SK_G32_SHIFT / 8,
+                     kB = SK_B32_SHIFT / 8;
+
+static inline Sk4f load_pixel(const SkPMColor* p) {
+    return SkNx_cast<float>(Sk4b::Load(p));
+}
+
+// Matches the rounding and clamping of filterPixels().
+template <bool convolveAlpha>
+static inline SkPMColor pack_sum(const Sk4f& sum, SkScalar gain, SkScalar bias, SkPMColor src) {
+    Sk4f v = Sk4f::Min(Sk4f::Max((sum * gain + bias).floor(), 0.0f), 255.0f);
+    int a = convolveAlpha ? (int)v[kA] : 255;
+    int r = SkTMin((int)v[kR], a),
+        g = SkTMin((int)v[kG], a),
+        b = SkTMin((int)v[kB], a);
+    if (!convolveAlpha) {
+        return SkPreMultiplyARGB(SkGetPackedA32(src), r, g, b);
+    }
+    return SkPackARGB32(a, r, g, b);
+}
+
+// Convolve pixels whose kernel lies entirely within the source.
+template <bool convolveAlpha>
+static void convolve_interior(const SkBitmap& src, SkBitmap* result, const SkIVector& offset,
+                              const SkIRect& rect, const SkISize& kernelSize,
+                              const SkScalar* kernel, const SkIPoint& kernelOffset,
+                              SkScalar gain, SkScalar bias) {
+    for (int y = rect.fTop; y < rect.fBottom; ++y) {
+        SkPMColor* dptr = result->getAddr32(rect.fLeft - offset.fX, y - offset.fY);
+        for (int x = rect.fLeft; x < rect.fRight; ++x) {
+            Sk4f sum(0.0f);
+            for (int cy = 0; cy < kernelSize.fHeight; cy++) {
+                const SkPMColor* sptr = src.getAddr32(x - kernelOffset.fX,
+                                                      y + cy - kernelOffset.fY);
+                const SkScalar* k = kernel + cy * kernelSize.fWidth;
+                for (int cx = 0; cx < kernelSize.fWidth; cx++) {
+                    sum = sum + load_pixel(sptr + cx) * k[cx];
+                }
+            }
+            *dptr++ = pack_sum<convolveAlpha>(sum, gain, bias, *src.getAddr32(x, y));
+        }
+    }
+}
+
+// As convolve_interior(), for a kernel that is the outer product of kernelX and kernelY divided
+// by divisor.  Each source row is convolved with kernelX once, and the last kernelSize.height()
+// of those results are kept in a ring, which is convolved with kernelY for each output row.
+template <bool convolveAlpha>
+static void convolve_interior_separable(const SkBitmap& src, SkBitmap* result,
+                                        const SkIVector& offset, const SkIRect& rect,
+                                        const SkISize& kernelSize, const SkScalar* kernelX,
+                                        const SkScalar* kernelY, SkScalar divisor,
+                                        const SkIPoint& kernelOffset,
+                                        SkScalar gain, SkScalar bias) {
+    const int width = rect.width(),
+              kw = kernelSize.fWidth,
+              kh = kernelSize.fHeight;
+    SkAutoTMalloc<Sk4f> rows(kh * width), sums(width);
+
+    auto convolveRow = [&](int y, Sk4f* row) {
+        const SkPMColor* sptr = src.getAddr32(rect.fLeft - kernelOffset.fX, y);
+        for (int x = 0; x < width; ++x) {
+            Sk4f sum(0.0f);
+            for (int cx = 0; cx < kw; cx++) {
+                sum = sum + load_pixel(sptr + x + cx) * kernelX[cx];
+            }
+            row[x] = sum;
+        }
+    };
+
+    // Source row y - kernelOffset.fY + cy lives at index (y - rect.fTop + cy) % kh of the ring.
+    for (int cy = 0; cy < kh - 1; ++cy) {
+        convolveRow(rect.fTop - kernelOffset.fY + cy, rows.get() + cy * width);
+    }
+    for (int y = rect.fTop; y < rect.fBottom; ++y) {
+        const int i = y - rect.fTop;
+        convolveRow(y - kernelOffset.fY + kh - 1, rows.get() + (i + kh - 1) % kh * width);
+
+        for (int x = 0; x < width; ++x) {
+            sums[x] = 0.0f;
+        }
+        for (int cy = 0; cy < kh; cy++) {
+            const Sk4f* row = rows.get() + (i + cy) % kh * width;
+            for (int x = 0; x < width; ++x) {
+                sums[x] = sums[x] + row[x] * kernelY[cy];
+            }
+        }
+
+        SkPMColor* dptr = result->getAddr32(rect.fLeft - offset.fX, y - offset.fY);
+        const SkPMColor* sptr = src.getAddr32(rect.fLeft, y);
+        for (int x = 0; x < width; ++x) {
+            dptr[x] = pack_sum<convolveAlpha>(sums[x] / divisor, gain, bias, sptr[x]);
+        }
+    }
+}
+
 void SkMatrixConvolutionImageFilter::filterInteriorPixels(const SkBitmap& src,
                                                           SkBitmap* result,
                                                           SkIVector& offset,
-                                                          const SkIRect& rect,
-                                                          const SkIRect& bounds) const {
-    switch (fTileMode) {
-        case kRepeat_TileMode:
-            // In repeat mode, we still need to wrap the samples around the src
-            filterPixels<RepeatPixelFetcher>(src, result, offset, rect, bounds);
-            break;
-        case kClamp_TileMode:
-        case kClampToBlack_TileMode:
-            filterPixels<UncheckedPixelFetcher>(src, result, offset, rect, bounds);
-            break;
+                                                          const SkIRect& r,
+                                                          const SkIRect& bounds,
+                                                          const Context& ctx) const {
+    SkIRect rect(r);
+    if (!rect.intersect(bounds)) {
+        return;
     }
+
+    // Every row is independent, so filter the rows in bands.
+    SkImageFilterPriv::ForEachBand(ctx, rect.height(), rect.width(), [&](int first, int last) {
+        const SkIRect band = SkIRect::MakeLTRB(rect.fLeft, rect.fTop + first,
+                                               rect.fRight, rect.fTop + last);
+        if (fSeparableKernel) {
+            const SkScalar* kernelX = fSeparableKernel;
+            const SkScalar* kernelY = fSeparableKernel + fKernelSize.fWidth;
+            const SkScalar divisor = kernelY[fKernelSize.fHeight];
+            if (fConvolveAlpha) {
+                convolve_interior_separable<true>(src, result, offset, band, fKernelSize,
+                                                  kernelX, kernelY, divisor, fKernelOffset,
+                                                  fGain, fBias);
+            } else {
+                convolve_interior_separable<false>(src, result, offset, band, fKernelSize,
+                                                   kernelX, kernelY, divisor, fKernelOffset,
+                                                   fGain, fBias);
+            }
+        } else {
+            if (fConvolveAlpha) {
+                convolve_interior<true>(src, result, offset, band, fKernelSize, fKernel,
+                                        fKernelOffset, fGain, fBias);
+            } else {
+                convolve_interior<false>(src, result, offset, band, fKernelSize, fKernel,
+                                         fKernelOffset, fGain, fBias);
+            }
+        }
+    });
 }
 
 void SkMatrixConvolutionImageFilter::filterBorderPixels(const SkBitmap& src,
@@ -406,9 +571,15 @@ sk_sp<SkSpecialImage> SkMatrixConvolutionImageFilter::onFilterImage(SkSpecialIma
 
     SkIRect interior;
     if (kRepeat_TileMode == fTileMode) {
-        // In repeat mode, the filterPixels calls will wrap around
-        // so we just need to render 'dstBounds'
-        interior = dstBounds;
+        // In repeat mode, the border filterPixels calls will wrap around, so the interior is
+        // just where the kernel stays within 'srcBounds'.
+        interior = SkIRect::MakeXYWH(srcBounds.left() + fKernelOffset.fX,
+                                     srcBounds.top() + fKernelOffset.fY,
+                                     srcBounds.width() - fKernelSize.fWidth + 1,
+                                     srcBounds.height() - fKernelSize.fHeight + 1);
+        if (!interior.intersect(dstBounds)) {
+            interior = SkIRect::MakeXYWH(dstBounds.left(), dstBounds.top(), 0, 0);
+        }
     } else {
         interior = SkIRect::MakeXYWH(dstBounds.left() + fKernelOffset.fX,
                                      dstBounds.top() + fKernelOffset.fY,
@@ -429,7 +600,7 @@ sk_sp<SkSpecialImage> SkMatrixConvolutionImageFilter::onFilterImage(SkSpecialIma
 
     this->filterBorderPixels(inputBM, &dst, dstContentOffset, top, srcBounds);
     this->filterBorderPixels(inputBM, &dst, dstContentOffset, left, srcBounds);
-    this->filterInteriorPixels(inputBM, &dst, dstContentOffset, interior, srcBounds);
+    this->filterInteriorPixels(inputBM, &dst, dstContentOffset, interior, srcBounds, ctx);
     this->filterBorderPixels(inputBM, &dst, dstContentOffset, right, srcBounds);
     this->filterBorderPixels(inputBM, &dst, dstContentOffset, bottom, srcBounds);
 
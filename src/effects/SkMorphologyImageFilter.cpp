@@ -70,20 +70,37 @@ void SkMorphologyImageFilter::flatten(SkWriteBuffer& buffer) const {
     buffer.writeInt(fRadius.fHeight);
 }
 
+// Each line (a row for procX, a column for procY) is filtered independently of the others, so
+// filter the lines in bands.  Band edges are kept to multiples of 16 lines, the most any proc
+// filters at once.
+static void call_proc_in_bands(const SkImageFilter::Context& ctx,
+                               SkMorphologyImageFilter::Proc proc,
+                               const SkPMColor* src, int srcLineStride, int srcStride,
+                               SkPMColor* dst, int dstLineStride, int dstStride,
+                               int radius, int width, int lines) {
+    SkImageFilterPriv::ForEachBand(ctx, lines, width, [&](int first, int last) {
+        proc(src + first * srcLineStride, dst + first * dstLineStride,
+             radius, width, last - first, srcStride, dstStride);
+    }, 16);
+}
+
 static void call_proc_X(SkMorphologyImageFilter::Proc procX,
                         const SkBitmap& src, SkBitmap* dst,
-                        int radiusX, const SkIRect& bounds) {
-    procX(src.getAddr32(bounds.left(), bounds.top()), dst->getAddr32(0, 0),
-          radiusX, bounds.width(), bounds.height(),
-          src.rowBytesAsPixels(), dst->rowBytesAsPixels());
+                        int radiusX, const SkIRect& bounds, const SkImageFilter::Context& ctx) {
+    call_proc_in_bands(ctx, procX,
+                       src.getAddr32(bounds.left(), bounds.top()), src.rowBytesAsPixels(),
+                       src.rowBytesAsPixels(),
+                       dst->getAddr32(0, 0), dst->rowBytesAsPixels(), dst->rowBytesAsPixels(),
+                       radiusX, bounds.width(), bounds.height());
 }
 
 static void call_proc_Y(SkMorphologyImageFilter::Proc procY,
                         const SkPMColor* src, int srcRowBytesAsPixels, SkBitmap* dst,
-                        int radiusY, const SkIRect& bounds) {
-    procY(src, dst->getAddr32(0, 0),
-          radiusY, bounds.height(), bounds.width(),
-          srcRowBytesAsPixels, dst->rowBytesAsPixels());
+                        int radiusY, const SkIRect& bounds, const SkImageFilter::Context& ctx) {
+    call_proc_in_bands(ctx, procY,
+                       src, 1, srcRowBytesAsPixels,
+                       dst->getAddr32(0, 0), 1, dst->rowBytesAsPixels(),
+                       radiusY, bounds.height(), bounds.width());
 }
 
 SkRect SkMorphologyImageFilter::computeFastBounds(const SkRect& src) const {
@@ -625,18 +642,18 @@ sk_sp<SkSpecialImage> SkMorphologyImageFilter::onFilterImage(SkSpecialImage* sou
             return nullptr;
         }
 
-        call_proc_X(procX, inputBM, &tmp, width, srcBounds);
+        call_proc_X(procX, inputBM, &tmp, width, srcBounds, ctx);
         SkIRect tmpBounds = SkIRect::MakeWH(srcBounds.width(), srcBounds.height());
         call_proc_Y(procY,
                     tmp.getAddr32(tmpBounds.left(), tmpBounds.top()), tmp.rowBytesAsPixels(),
-                    &dst, height, tmpBounds);
+                    &dst, height, tmpBounds, ctx);
     } else if (width > 0) {
-        call_proc_X(procX, inputBM, &dst, width, srcBounds);
+        call_proc_X(procX, inputBM, &dst, width, srcBounds, ctx);
     } else if (height > 0) {
         call_proc_Y(procY,
                     inputBM.getAddr32(srcBounds.left(), srcBounds.top()),
                     inputBM.rowBytesAsPixels(),
-                    &dst, height, srcBounds);
+                    &dst, height, srcBounds, ctx);
     }
     offset->fX = bounds.left();
     offset->fY = bounds.top();
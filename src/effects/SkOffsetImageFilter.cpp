@@ -30,6 +30,13 @@ sk_sp<SkImageFilter> SkOffsetImageFilter::Make(SkScalar dx, SkScalar dy,
         return nullptr;
     }
 
+    // Uncropped offsets just move their input's origin, so an offset of one is a single offset.
+    if (!cropRect && input && input->getFactory() == CreateProc && !input->cropRectIsSet()) {
+        const SkVector& inputOffset = static_cast<const SkOffsetImageFilter*>(input.get())->fOffset;
+        return Make(dx + inputOffset.fX, dy + inputOffset.fY, sk_ref_sp(input->getInput(0)),
+                    nullptr);
+    }
+
     return sk_sp<SkImageFilter>(new SkOffsetImageFilter(dx, dy, std::move(input), cropRect));
 }
 
@@ -10,6 +10,7 @@
 #include "SkArenaAlloc.h"
 #include "SkBitmap.h"
 #include "SkColorData.h"
+#include "SkColorMatrixFilterRowMajor255.h"
 #include "SkRasterPipeline.h"
 #include "SkReadBuffer.h"
 #include "SkString.h"
@@ -271,11 +272,16 @@ static void combine_tables(uint8_t res[256], const uint8_t outer[256], const uin
 
 sk_sp<SkColorFilter> SkTable_ColorFilter::onMakeComposed(sk_sp<SkColorFilter> innerFilter) const {
     SkBitmap innerBM;
-    if (!innerFilter->asComponentTable(&innerBM)) {
-        return nullptr;
-    }
-
-    if (nullptr == innerBM.getPixels()) {
+    uint8_t innerTables[4][256];
+    SkScalar innerMatrix[20];
+    if (innerFilter->asComponentTable(&innerBM)) {
+        if (nullptr == innerBM.getPixels()) {
+            return nullptr;
+        }
+    } else if (innerFilter->asColorMatrix(innerMatrix) &&
+               SkColorMatrixFilterRowMajor255::AsTables(innerMatrix, nullptr, innerTables)) {
+        innerBM.installPixels(SkImageInfo::MakeA8(256, 4), innerTables, 256);
+    } else {
         return nullptr;
     }
 
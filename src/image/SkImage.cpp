@@ -295,6 +295,11 @@ bool SkImage::isLazyGenerated() const {
     return as_IB(this)->onIsLazyGenerated();
 }
 
+sk_sp<SkImage::PrefetchHandle> SkImage::prefetchDecode(SkExecutor& executor,
+                                                       SkColorSpace* dstColorSpace) const {
+    return as_IB(this)->onPrefetchDecode(executor, dstColorSpace);
+}
+
 bool SkImage::isAlphaOnly() const {
     return as_IB(this)->onImageInfo().colorType() == kAlpha_8_SkColorType;
 }
@@ -80,6 +80,10 @@ public:
     // True only for generators that operate directly on gpu (e.g. picture-generators)
     virtual bool onCanLazyGenerateOnGPU() const { return false; }
 
+    virtual sk_sp<SkImage::PrefetchHandle> onPrefetchDecode(SkExecutor&, SkColorSpace*) const {
+        return nullptr;
+    }
+
     // Call when this image is part of the key to a resourcecache entry. This allows the cache
     // to know automatically those entries can be purged when this SkImage deleted.
     void notifyAddedToCache() const {
@@ -11,10 +11,14 @@
 #include "SkBitmap.h"
 #include "SkBitmapCache.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkImageGenerator.h"
 #include "SkImagePriv.h"
 #include "SkNextID.h"
 #include "SkPixelRef.h"
+#include "SkSemaphore.h"
+
+#include <atomic>
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -90,6 +94,7 @@ public:
     bool getROPixels(SkBitmap*, SkColorSpace* dstColorSpace, CachingHint) const override;
     bool onIsLazyGenerated() const override { return true; }
     bool onCanLazyGenerateOnGPU() const override;
+    sk_sp<SkImage::PrefetchHandle> onPrefetchDecode(SkExecutor&, SkColorSpace*) const override;
     sk_sp<SkImage> onMakeColorSpace(sk_sp<SkColorSpace>, SkColorType,
                                     SkTransferFunctionBehavior) const override;
 
@@ -520,6 +525,10 @@ bool SkImage_Lazy::lockAsBitmap(SkBitmap* bitmap, SkImage::CachingHint chint, Ca
     }
 
     ScopedGenerator generator(fSharedGenerator);
+    // Whoever held the generator before us (e.g. a prefetchDecode()) may have just cached it.
+    if (this->lockAsBitmapOnlyIfAlreadyCached(bitmap, format)) {
+        return true;
+    }
     if (!generate_pixels(generator, pmap, fOrigin.x(), fOrigin.y(), behavior)) {
         return false;
     }
@@ -596,6 +605,70 @@ bool SkImage_Lazy::onCanLazyGenerateOnGPU() const {
 #endif
 }
 
+namespace {
+class LazyPrefetch final : public SkImage::PrefetchHandle {
+public:
+    explicit LazyPrefetch(sk_sp<SkColorSpace> dstColorSpace)
+        : fDstColorSpace(std::move(dstColorSpace))
+        , fState(kPending) {}
+
+    void cancel() override {
+        int pending = kPending;
+        if (fState.compare_exchange_strong(pending, kCanceled)) {
+            fDone.signal();
+        }
+    }
+
+    bool isDone() const override {
+        return fState.load() >= kDone;
+    }
+
+    void wait() override {
+        // Pass the signal on to any other waiters.
+        fDone.wait();
+        fDone.signal();
+    }
+
+    void run(const SkImage_Base* image) {
+        int pending = kPending;
+        if (!fState.compare_exchange_strong(pending, kRunning)) {
+            return;
+        }
+
+        SkBitmap bitmap;
+        image->getROPixels(&bitmap, fDstColorSpace.get(), SkImage::kAllow_CachingHint);
+        fState.store(kDone);
+        fDone.signal();
+    }
+
+private:
+    enum State {
+        kPending,
+        kRunning,
+        kDone,
+        kCanceled,
+    };
+
+    sk_sp<SkColorSpace> fDstColorSpace;
+    std::atomic<int>    fState;
+    SkSemaphore         fDone;
+};
+}
+
+sk_sp<SkImage::PrefetchHandle> SkImage_Lazy::onPrefetchDecode(SkExecutor& executor,
+                                                              SkColorSpace* dstColorSpace) const {
+    SkBitmap bitmap;
+    if (this->lockAsBitmapOnlyIfAlreadyCached(&bitmap, this->chooseCacheFormat(dstColorSpace))) {
+        return nullptr;
+    }
+
+    // Draws look for the decode in the cache, and wait on the generator while it is running.
+    sk_sp<LazyPrefetch> prefetch(new LazyPrefetch(sk_ref_sp(dstColorSpace)));
+    sk_sp<const SkImage_Lazy> image = sk_ref_sp(this);
+    executor.add([image, prefetch] { prefetch->run(image.get()); });
+    return prefetch;
+}
+
 SkTransferFunctionBehavior SkImage_Lazy::getGeneratorBehaviorAndInfo(SkImageInfo* generatorImageInfo) const {
     if (generatorImageInfo->colorSpace()) {
         return SkTransferFunctionBehavior::kRespect;
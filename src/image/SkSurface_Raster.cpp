@@ -9,8 +9,11 @@
 #include "SkImageInfoPriv.h"
 #include "SkImagePriv.h"
 #include "SkCanvas.h"
+#include "SkDeferredDisplayList.h"
 #include "SkDevice.h"
+#include "SkLiteDL.h"
 #include "SkMallocPixelRef.h"
+#include "SkSurfaceCharacterization.h"
 
 class SkSurface_Raster : public SkSurface_Base {
 public:
@@ -26,6 +29,8 @@ public:
     void onDraw(SkCanvas*, SkScalar x, SkScalar y, const SkPaint*) override;
     void onCopyOnWrite(ContentChangeMode) override;
     void onRestoreBackingMutability() override;
+    bool onCharacterize(SkSurfaceCharacterization*) const override;
+    bool onDraw(const SkDeferredDisplayList*) override;
 
 private:
     SkBitmap    fBitmap;
@@ -181,6 +186,28 @@ void SkSurface_Raster::onCopyOnWrite(ContentChangeMode mode) {
     }
 }
 
+bool SkSurface_Raster::onCharacterize(SkSurfaceCharacterization* characterization) const {
+    characterization->setRaster(fBitmap.info(), this->props());
+    return true;
+}
+
+bool SkSurface_Raster::onDraw(const SkDeferredDisplayList* ddl) {
+    if (!ddl || !ddl->fRasterDL) {
+        return false;
+    }
+    SkSurfaceCharacterization characterization;
+    this->onCharacterize(&characterization);
+    if (ddl->characterization() != characterization) {
+        return false;
+    }
+
+    // Like the GPU DDL, playback ignores any matrix or clip set on our own canvas.
+    this->notifyContentWillChange(kRetain_ContentChangeMode);
+    SkCanvas canvas(fBitmap, this->props());
+    ddl->fRasterDL->draw(&canvas);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 sk_sp<SkSurface> SkSurface::MakeRasterDirectReleaseProc(const SkImageInfo& info, void* pixels,
@@ -15,6 +15,10 @@ bool SkJpegEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+bool SkJpegEncoder::EncodeYUV(SkWStream*, const SkYUVSizeInfo&, const void* const[3],
+                              SkYUVColorSpace, SkColorSpace*, const Options&) {
+    return false;
+}
 #endif
 
 #ifndef SK_HAS_PNG_LIBRARY
@@ -36,6 +36,7 @@ public:
     }
 
     bool setParams(const SkImageInfo& srcInfo, const SkJpegEncoder::Options& options);
+    void setYUVParams(const SkYUVSizeInfo& sizeInfo, int hSampFactor, int vSampFactor);
 
     jpeg_compress_struct* cinfo() { return &fCInfo; }
 
@@ -179,6 +180,43 @@ bool SkJpegEncoderMgr::setParams(const SkImageInfo& srcInfo, const SkJpegEncoder
     return true;
 }
 
+void SkJpegEncoderMgr::setYUVParams(const SkYUVSizeInfo& sizeInfo, int hSampFactor,
+                                    int vSampFactor) {
+    fCInfo.image_width = sizeInfo.fSizes[SkYUVSizeInfo::kY].width();
+    fCInfo.image_height = sizeInfo.fSizes[SkYUVSizeInfo::kY].height();
+    fCInfo.in_color_space = JCS_YCbCr;
+    fCInfo.input_components = 3;
+    jpeg_set_defaults(&fCInfo);
+
+    // We will hand libjpeg the downsampled planes ourselves.
+    fCInfo.raw_data_in = TRUE;
+    fCInfo.comp_info[0].h_samp_factor = hSampFactor;
+    fCInfo.comp_info[0].v_samp_factor = vSampFactor;
+    for (int i = 1; i < 3; i++) {
+        fCInfo.comp_info[i].h_samp_factor = 1;
+        fCInfo.comp_info[i].v_samp_factor = 1;
+    }
+
+    fCInfo.optimize_coding = TRUE;
+}
+
+static void write_icc_marker(jpeg_compress_struct* cinfo, const SkImageInfo& info) {
+    sk_sp<SkData> icc = icc_from_color_space(info);
+    if (icc) {
+        // Create a contiguous block of memory with the icc signature followed by the profile.
+        sk_sp<SkData> markerData =
+                SkData::MakeUninitialized(kICCMarkerHeaderSize + icc->size());
+        uint8_t* ptr = (uint8_t*) markerData->writable_data();
+        memcpy(ptr, kICCSig, sizeof(kICCSig));
+        ptr += sizeof(kICCSig);
+        *ptr++ = 1; // This is the first marker.
+        *ptr++ = 1; // Out of one total markers.
+        memcpy(ptr, icc->data(), icc->size());
+
+        jpeg_write_marker(cinfo, kICCMarker, markerData->bytes(), markerData->size());
+    }
+}
+
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                                const Options& options) {
     if (!SkPixmapIsValid(src, options.fBlendBehavior)) {
@@ -199,20 +237,7 @@ std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& s
     jpeg_set_quality(encoderMgr->cinfo(), options.fQuality, TRUE);
     jpeg_start_compress(encoderMgr->cinfo(), TRUE);
 
-    sk_sp<SkData> icc = icc_from_color_space(src.info());
-    if (icc) {
-        // Create a contiguous block of memory with the icc signature followed by the profile.
-        sk_sp<SkData> markerData =
-                SkData::MakeUninitialized(kICCMarkerHeaderSize + icc->size());
-        uint8_t* ptr = (uint8_t*) markerData->writable_data();
-        memcpy(ptr, kICCSig, sizeof(kICCSig));
-        ptr += sizeof(kICCSig);
-        *ptr++ = 1; // This is the first marker.
-        *ptr++ = 1; // Out of one total markers.
-        memcpy(ptr, icc->data(), icc->size());
-
-        jpeg_write_marker(encoderMgr->cinfo(), kICCMarker, markerData->bytes(), markerData->size());
-    }
+    write_icc_marker(encoderMgr->cinfo(), src.info());
 
     return std::unique_ptr<SkJpegEncoder>(new SkJpegEncoder(std::move(encoderMgr), src));
 }
@@ -256,4 +281,97 @@ bool SkJpegEncoder::Encode(SkWStream* dst, const SkPixmap& src, const Options& o
     return encoder.get() && encoder->encodeRows(src.height());
 }
 
+// Returns the factor by which the plane of size |sub| is subsampled from |full|, or 0.
+static int samp_factor(int full, int sub) {
+    for (int factor : { 1, 2 }) {
+        if (sub == (full + factor - 1) / factor) {
+            return factor;
+        }
+    }
+    return 0;
+}
+
+bool SkJpegEncoder::EncodeYUV(SkWStream* dst, const SkYUVSizeInfo& sizeInfo,
+                              const void* const planes[3], SkYUVColorSpace yuvColorSpace,
+                              SkColorSpace* colorSpace, const Options& options) {
+    // Jpegs hold full range BT.601.
+    if (kJPEG_SkYUVColorSpace != yuvColorSpace) {
+        return false;
+    }
+
+    const SkISize& ySize = sizeInfo.fSizes[SkYUVSizeInfo::kY];
+    const SkISize& uvSize = sizeInfo.fSizes[SkYUVSizeInfo::kU];
+    if (ySize.isEmpty() || uvSize != sizeInfo.fSizes[SkYUVSizeInfo::kV]) {
+        return false;
+    }
+    const int hSampFactor = samp_factor(ySize.width(), uvSize.width()),
+              vSampFactor = samp_factor(ySize.height(), uvSize.height());
+    if (!hSampFactor || !vSampFactor) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!planes[i] || sizeInfo.fWidthBytes[i] < (size_t) sizeInfo.fSizes[i].width()) {
+            return false;
+        }
+    }
+
+    // libjpeg reads whole 8x8 blocks.  Below the last row of a plane we repeat that row.  If
+    // a plane's width is not a multiple of 8, we copy each row, repeating its last pixel, like
+    // libjpeg does when it downsamples for us.
+    JSAMPROW rows[3][2 * DCTSIZE];
+    JSAMPARRAY image[3] = { rows[0], rows[1], rows[2] };
+    SkAutoTMalloc<uint8_t> padded[3];
+    for (int i = 0; i < 3; i++) {
+        const int width = sizeInfo.fSizes[i].width();
+        if (0 != width % DCTSIZE) {
+            padded[i].reset(2 * DCTSIZE * SkAlign8(width));
+        }
+    }
+
+    std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(dst);
+
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return false;
+    }
+
+    jpeg_compress_struct* cinfo = encoderMgr->cinfo();
+    encoderMgr->setYUVParams(sizeInfo, hSampFactor, vSampFactor);
+    jpeg_set_quality(cinfo, options.fQuality, TRUE);
+    jpeg_start_compress(cinfo, TRUE);
+    write_icc_marker(cinfo, SkImageInfo::Make(ySize.width(), ySize.height(),
+                                              kRGBA_8888_SkColorType, kOpaque_SkAlphaType,
+                                              sk_ref_sp(colorSpace)));
+
+    // Each call to jpeg_write_raw_data() takes one row of MCUs.
+    const int mcuHeight = vSampFactor * DCTSIZE;
+    for (int mcuRow = 0; mcuRow * mcuHeight < ySize.height(); mcuRow++) {
+        for (int i = 0; i < 3; i++) {
+            const int width = sizeInfo.fSizes[i].width(),
+                      height = sizeInfo.fSizes[i].height(),
+                      rowCount = (0 == i ? vSampFactor : 1) * DCTSIZE;
+            const size_t paddedWidth = SkAlign8(width);
+            for (int r = 0; r < rowCount; r++) {
+                const int y = SkTMin(mcuRow * rowCount + r, height - 1);
+                const uint8_t* src = SkTAddOffset<const uint8_t>(planes[i],
+                                                                 y * sizeInfo.fWidthBytes[i]);
+                if (!padded[i]) {
+                    rows[i][r] = const_cast<uint8_t*>(src);
+                    continue;
+                }
+
+                uint8_t* row = padded[i].get() + r * paddedWidth;
+                memcpy(row, src, width);
+                memset(row + width, src[width - 1], paddedWidth - width);
+                rows[i][r] = row;
+            }
+        }
+
+        jpeg_write_raw_data(cinfo, image, mcuHeight);
+    }
+
+    jpeg_finish_compress(cinfo);
+    return true;
+}
+
 #endif
@@ -16,8 +16,10 @@
 #include "SkString.h"
 #include "SkPngEncoder.h"
 #include "SkPngPriv.h"
+#include "SkTaskGroup.h"
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -43,6 +45,26 @@ static void sk_write_fn(png_structp png_ptr, png_bytep data, png_size_t len) {
     }
 }
 
+// When encoding in parallel, each band of rows is filtered and deflated on its own.
+static constexpr size_t kBandBytes = 256 * 1024;
+// Deflate looks back at most 32K, so this much of the previous band is all a band needs to
+// compress as well as it would have as part of one long stream.
+static constexpr size_t kDictionaryBytes = 32 * 1024;
+// Bands are written out in order as they finish; at most this many are deflated ahead of the
+// one being written, which bounds the compressed output held at once.
+static constexpr int kMaxBandsInFlight = 8;
+
+namespace {
+struct DeflatedBand {
+    SkAutoTMalloc<uint8_t> fData;
+    size_t                 fSize = 0;
+    uLong                  fAdler = 0;         // Of the filtered rows, as zlib wants.
+    size_t                 fFilteredSize = 0;
+    bool                   fSuccess = false;
+    std::atomic<bool>      fDone{false};
+};
+}
+
 class SkPngEncoderMgr final : SkNoncopyable {
 public:
 
@@ -56,11 +78,20 @@ public:
     bool setColorSpace(const SkImageInfo& info);
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo, SkTransferFunctionBehavior unpremulBehavior);
+    void setExecutor(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options);
+
+    /*
+     *  Writes the image data for rows [startRow, startRow + numRows) ourselves, rather than
+     *  through libpng, filtering and deflating bands of them on fExecutor.  Writes the IEND
+     *  chunk after the last row.
+     */
+    bool encodeRowsInParallel(const SkPixmap& src, int startRow, int numRows);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    SkExecutor* executor() const { return fExecutor; }
 
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
@@ -71,12 +102,24 @@ private:
     SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr)
         : fPngPtr(pngPtr)
         , fInfoPtr(infoPtr)
+        , fExecutor(nullptr)
     {}
 
+    void deflateBand(const SkPixmap& src, int startRow, int endRow, bool finish,
+                     DeflatedBand* band) const;
+    bool writeChunk(const char* name, const uint8_t* data, size_t size);
+
     png_structp             fPngPtr;
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+
+    // Only used when encoding in parallel.
+    SkExecutor*             fExecutor;
+    int                     fFilters;
+    int                     fZLibLevel;
+    int                     fZLibStrategy;
+    uLong                   fAdler;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -362,6 +405,253 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo,
     fProc = choose_proc(srcInfo, unpremulBehavior);
 }
 
+void SkPngEncoderMgr::setExecutor(const SkImageInfo& srcInfo,
+                                  const SkPngEncoder::Options& options) {
+    // We rely on libpng to drop the filler from opaque F16 rows, so those are encoded serially.
+    if (!options.fExecutor || (kRGBA_F16_SkColorType == srcInfo.colorType() &&
+                               kOpaque_SkAlphaType == srcInfo.alphaType())) {
+        return;
+    }
+
+    fExecutor = options.fExecutor;
+    fFilters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
+    if (!fFilters) {
+        fFilters = PNG_FILTER_NONE;
+    }
+    fZLibLevel = SkTMin(SkTMax(0, options.fZLibLevel), 9);
+    // Match the strategy libpng would choose.
+    fZLibStrategy = PNG_FILTER_NONE == fFilters ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    fAdler = adler32(0, nullptr, 0);
+}
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// libpng's heuristic for picking a filter is the sum of the filtered bytes, read as signed.
+static inline uint32_t cost(uint8_t filtered) {
+    return filtered < 128 ? filtered : 256 - filtered;
+}
+
+// Writes the filter type, followed by row filtered with it, and returns the cost of the row.
+// type is 0 (none) through 4 (paeth).
+static uint32_t filter_row(int type, uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                           size_t rowBytes, int bpp) {
+    *dst++ = type;
+    const size_t lead = SkTMin((size_t) bpp, rowBytes);
+    uint32_t sum = 0;
+    switch (type) {
+        case 0:
+            for (size_t i = 0; i < rowBytes; i++) {
+                sum += cost(dst[i] = row[i]);
+            }
+            break;
+        case 1:
+            for (size_t i = 0; i < lead; i++) {
+                sum += cost(dst[i] = row[i]);
+            }
+            for (size_t i = lead; i < rowBytes; i++) {
+                sum += cost(dst[i] = row[i] - row[i - bpp]);
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < rowBytes; i++) {
+                sum += cost(dst[i] = row[i] - prev[i]);
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < lead; i++) {
+                sum += cost(dst[i] = row[i] - (prev[i] >> 1));
+            }
+            for (size_t i = lead; i < rowBytes; i++) {
+                sum += cost(dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1));
+            }
+            break;
+        default:
+            for (size_t i = 0; i < lead; i++) {
+                sum += cost(dst[i] = row[i] - prev[i]);
+            }
+            for (size_t i = lead; i < rowBytes; i++) {
+                sum += cost(dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i],
+                                                                prev[i - bpp]));
+            }
+            break;
+    }
+    return sum;
+}
+
+// Filters row with whichever of the allowed filters yields the lowest cost.
+// scratch must hold rowBytes + 1 bytes.
+static void filter_best(int filters, uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                        size_t rowBytes, int bpp, uint8_t* scratch) {
+    uint8_t* best = nullptr;
+    uint32_t bestCost = 0;
+    for (int type = 0; type < 5; type++) {
+        if (!(filters & (PNG_FILTER_NONE << type))) {
+            continue;
+        }
+
+        uint8_t* trial = best == dst ? scratch : dst;
+        uint32_t trialCost = filter_row(type, trial, row, prev, rowBytes, bpp);
+        if (!best || trialCost < bestCost) {
+            best = trial;
+            bestCost = trialCost;
+        }
+    }
+
+    if (best != dst) {
+        memcpy(dst, best, rowBytes + 1);
+    }
+}
+
+void SkPngEncoderMgr::deflateBand(const SkPixmap& src, int startRow, int endRow, bool finish,
+                                  DeflatedBand* band) const {
+    const size_t rowBytes = fPngBytesPerPixel * src.width(),
+                 filteredRowBytes = rowBytes + 1;
+
+    // Filter the rows at the end of the previous band too, to prime the dictionary.
+    const int dictionaryRows = SkToInt((kDictionaryBytes + filteredRowBytes - 1) /
+                                       filteredRowBytes);
+    const int firstRow = SkTMax(0, startRow - dictionaryRows);
+    SkAutoTMalloc<uint8_t> filtered((endRow - firstRow) * filteredRowBytes);
+    SkAutoTMalloc<uint8_t> storage(2 * rowBytes + filteredRowBytes);
+    uint8_t* prev    = storage.get();
+    uint8_t* curr    = prev + rowBytes;
+    uint8_t* scratch = curr + rowBytes;
+
+    const int srcBPP = SkColorTypeBytesPerPixel(src.colorType());
+    if (firstRow > 0) {
+        fProc((char*) prev, (const char*) src.addr(0, firstRow - 1), src.width(), srcBPP,
+              nullptr);
+    } else {
+        sk_bzero(prev, rowBytes);
+    }
+    for (int y = firstRow; y < endRow; y++) {
+        fProc((char*) curr, (const char*) src.addr(0, y), src.width(), srcBPP, nullptr);
+        filter_best(fFilters, filtered.get() + (y - firstRow) * filteredRowBytes, curr, prev,
+                    rowBytes, fPngBytesPerPixel, scratch);
+        SkTSwap(prev, curr);
+    }
+
+    const uint8_t* input = filtered.get() + (startRow - firstRow) * filteredRowBytes;
+    const size_t inputSize = (endRow - startRow) * filteredRowBytes;
+    band->fAdler = adler32(adler32(0, nullptr, 0), input, inputSize);
+    band->fFilteredSize = inputSize;
+
+    // A raw deflate stream, so the bands can be concatenated.
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (Z_OK != deflateInit2(&stream, fZLibLevel, Z_DEFLATED, -MAX_WBITS, 8, fZLibStrategy)) {
+        return;
+    }
+    if (startRow > 0) {
+        const size_t dictionarySize = SkTMin(kDictionaryBytes,
+                                             (startRow - firstRow) * filteredRowBytes);
+        deflateSetDictionary(&stream, input - dictionarySize, dictionarySize);
+    }
+
+    // Leave room for the zlib header before the first band, and for a sync flush marker and
+    // the adler32 after the last.
+    static constexpr size_t kHeaderBytes = 2, kTrailerBytes = 16;
+    const size_t capacity = deflateBound(&stream, inputSize) + kTrailerBytes;
+    band->fData.reset(kHeaderBytes + capacity);
+    stream.next_in   = const_cast<uint8_t*>(input);
+    stream.avail_in  = inputSize;
+    stream.next_out  = band->fData.get() + kHeaderBytes;
+    stream.avail_out = capacity;
+    const int result = deflate(&stream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+    band->fSize = kHeaderBytes + capacity - stream.avail_out;
+    band->fSuccess = 0 == stream.avail_in && (finish ? Z_STREAM_END == result
+                                                     : Z_OK == result && stream.avail_out > 0);
+    deflateEnd(&stream);
+}
+
+bool SkPngEncoderMgr::writeChunk(const char* name, const uint8_t* data, size_t size) {
+    if (setjmp(png_jmpbuf(fPngPtr))) {
+        return false;
+    }
+
+    png_write_chunk(fPngPtr, (png_bytep) name, (png_bytep) data, size);
+    return true;
+}
+
+bool SkPngEncoderMgr::encodeRowsInParallel(const SkPixmap& src, int startRow, int numRows) {
+    SkASSERT(fExecutor);
+    const size_t filteredRowBytes = fPngBytesPerPixel * src.width() + 1;
+    const int bandRows = SkTMax(1, SkToInt(kBandBytes / filteredRowBytes));
+    const int bandCount = (numRows + bandRows - 1) / bandRows;
+    const int endRow = startRow + numRows;
+    const bool lastRows = endRow == src.height();
+
+    DeflatedBand bands[kMaxBandsInFlight];
+    SkTaskGroup taskGroup(*fExecutor);  // Waits for any bands still in flight if we fail.
+    auto deflate = [&](int i) {
+        DeflatedBand* band = &bands[i % kMaxBandsInFlight];
+        band->fSuccess = false;
+        band->fDone.store(false, std::memory_order_relaxed);
+        taskGroup.add([=] {
+            const int bandStart = startRow + i * bandRows,
+                      bandEnd   = SkTMin(bandStart + bandRows, endRow);
+            this->deflateBand(src, bandStart, bandEnd, lastRows && bandEnd == endRow, band);
+            band->fDone.store(true, std::memory_order_release);
+        });
+    };
+    for (int i = 0; i < SkTMin(bandCount, kMaxBandsInFlight); i++) {
+        deflate(i);
+    }
+
+    for (int i = 0; i < bandCount; i++) {
+        DeflatedBand& band = bands[i % kMaxBandsInFlight];
+        // Like SkTaskGroup::wait(), help out rather than block, in case we're on fExecutor.
+        while (!band.fDone.load(std::memory_order_acquire)) {
+            fExecutor->borrow();
+        }
+        if (!band.fSuccess) {
+            return false;
+        }
+
+        // Each band left room for the zlib header in front of it.
+        uint8_t* data = band.fData.get() + 2;
+        if (0 == startRow && 0 == i) {
+            int level = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : 6 == fZLibLevel ? 2 : 3;
+            int header = (0x78 << 8) | (level << 6);
+            header += 31 - header % 31;
+            data -= 2;
+            data[0] = header >> 8;
+            data[1] = header & 0xFF;
+        }
+
+        fAdler = adler32_combine(fAdler, band.fAdler, band.fFilteredSize);
+        uint8_t* end = band.fData.get() + band.fSize;
+        if (lastRows && bandCount - 1 == i) {
+            end[0] = (fAdler >> 24) & 0xFF;
+            end[1] = (fAdler >> 16) & 0xFF;
+            end[2] = (fAdler >>  8) & 0xFF;
+            end[3] = (fAdler >>  0) & 0xFF;
+            end += 4;
+        }
+
+        if (!this->writeChunk("IDAT", data, end - data)) {
+            return false;
+        }
+
+        band.fData.reset(0);
+        if (i + kMaxBandsInFlight < bandCount) {
+            deflate(i + kMaxBandsInFlight);
+        }
+    }
+
+    // libpng's png_write_end() would complain that it never saw any IDAT.
+    return !lastRows || this->writeChunk("IEND", nullptr, 0);
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src, options.fUnpremulBehavior)) {
@@ -386,6 +676,7 @@ std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& sr
     }
 
     encoderMgr->chooseProc(src.info(), options.fUnpremulBehavior);
+    encoderMgr->setExecutor(src.info(), options);
 
     return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
 }
@@ -398,6 +689,15 @@ SkPngEncoder::SkPngEncoder(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const Sk
 SkPngEncoder::~SkPngEncoder() {}
 
 bool SkPngEncoder::onEncodeRows(int numRows) {
+    if (fEncoderMgr->executor()) {
+        if (!fEncoderMgr->encodeRowsInParallel(fSrc, fCurrRow, numRows)) {
+            return false;
+        }
+
+        fCurrRow += numRows;
+        return true;
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
@@ -99,6 +99,17 @@ struct SkJumper_UniformColorCtx {
     uint16_t rgba[4];  // [0,255] in a 16-bit lane.
 };
 
+struct SkJumper_PerlinNoiseCtx {
+    const uint8_t* latticeSelector;  // 256 entries
+    const float*   gradients[4];     // 256 (x,y) pairs per channel
+    float          baseFrequency[2];
+    int            numOctaves;
+    int            fractalNoise;     // Otherwise turbulence.
+    int            stitchTiles;
+    int            stitchWidth,      // Initial stitch values, doubled at each octave.
+                   stitchHeight;
+};
+
 struct SkJumper_ColorLookupTableCtx {
     const float* table;
     int limits[4];
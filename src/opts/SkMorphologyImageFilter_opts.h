@@ -9,13 +9,21 @@
 #define SkMorphologyImageFilter_opts_DEFINED
 
 #include "SkColor.h"
+#include "SkNx.h"
+#include "SkTemplates.h"
 
 namespace SK_OPTS_NS {
 
 enum MorphType { kDilate, kErode };
 enum class MorphDirection { kX, kY };
 
-#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// van Herk/Gil-Werman: cut each line into blocks as long as the window, and find the running
+// extremes forward (g) and backward (h) from the edges of each block.  Every window then spans at
+// most two blocks, so its extreme is just that of h at its left end and g at its right end, a
+// constant cost per pixel whatever the radius.
+//
+// We work on several lines at once, a pixel from each in every Sk16b: 4 rows for kX, and 16
+// adjacent columns (a cache line's worth) for kY.
 template<MorphType type, MorphDirection direction>
 static void morph(const SkPMColor* src, SkPMColor* dst,
                   int radius, int width, int height, int srcStride, int dstStride) {
@@ -24,110 +32,82 @@ static void morph(const SkPMColor* src, SkPMColor* dst,
     const int srcStrideY = direction == MorphDirection::kX ? srcStride : 1;
     const int dstStrideY = direction == MorphDirection::kX ? dstStride : 1;
     radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            __m128i extreme = (type == kDilate) ? _mm_setzero_si128()
-                                                : _mm_set1_epi32(0xFFFFFFFF);
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                __m128i src_pixel = _mm_cvtsi32_si128(*p);
-                extreme = (type == kDilate) ? _mm_max_epu8(src_pixel, extreme)
-                                            : _mm_min_epu8(src_pixel, extreme);
-            }
-            *dptr = _mm_cvtsi128_si32(extreme);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
+    const int window = 2 * radius + 1;
+    const int lastBlock = (width - 1) / window * window;
+
+    constexpr int kLines = direction == MorphDirection::kX ? 4 : 16;
+    struct Pixels {
+        Sk16b v[kLines / 4];
+    };
+    auto extreme = [](const Pixels& a, const Pixels& b) {
+        Pixels e;
+        for (int i = 0; i < kLines / 4; ++i) {
+            e.v[i] = type == kDilate ? Sk16b::Max(a.v[i], b.v[i]) : Sk16b::Min(a.v[i], b.v[i]);
         }
-        if (x >= radius) { src += srcStrideX; }
-        if (x + radius < width - 1) { upperSrc += srcStrideX; }
-        dst += dstStrideX;
-    }
-}
+        return e;
+    };
 
-#elif defined(SK_ARM_HAS_NEON)
-template<MorphType type, MorphDirection direction>
-static void morph(const SkPMColor* src, SkPMColor* dst,
-                  int radius, int width, int height, int srcStride, int dstStride) {
-    const int srcStrideX = direction == MorphDirection::kX ? 1 : srcStride;
-    const int dstStrideX = direction == MorphDirection::kX ? 1 : dstStride;
-    const int srcStrideY = direction == MorphDirection::kX ? srcStride : 1;
-    const int dstStrideY = direction == MorphDirection::kX ? dstStride : 1;
-    radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            uint8x8_t extreme = vdup_n_u8(type == kDilate ? 0 : 255);
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                uint8x8_t src_pixel = vreinterpret_u8_u32(vdup_n_u32(*p));
-                extreme = (type == kDilate) ? vmax_u8(src_pixel, extreme)
-                                            : vmin_u8(src_pixel, extreme);
+    SkAutoTMalloc<Pixels> g(width), h(width);
+    for (int y = 0; y < height; y += kLines) {
+        const int lines = SkMin32(kLines, height - y);
+
+        for (int x = 0; x < width; ++x) {
+            const SkPMColor* p = src + x * srcStrideX;
+            SkPMColor px[kLines];
+            if (srcStrideY != 1 || lines != kLines) {
+                for (int i = 0; i < kLines; ++i) {
+                    px[i] = p[SkMin32(i, lines - 1) * srcStrideY];
+                }
+                p = px;
+            }
+            for (int i = 0; i < kLines / 4; ++i) {
+                h[x].v[i] = Sk16b::Load(p + 4 * i);
+            }
+        }
+        for (int start = 0; start < width; start += window) {
+            const int end = SkMin32(start + window, width) - 1;
+            g[start] = h[start];
+            for (int x = start + 1; x <= end; ++x) {
+                g[x] = extreme(g[x - 1], h[x]);
+            }
+            for (int x = end - 1; x >= start; --x) {
+                h[x] = extreme(h[x], h[x + 1]);
             }
-            *dptr = vget_lane_u32(vreinterpret_u32_u8(extreme), 0);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
         }
-        if (x >= radius) src += srcStrideX;
-        if (x + radius < width - 1) upperSrc += srcStrideX;
-        dst += dstStrideX;
-    }
-}
 
-#else
-template<MorphType type, MorphDirection direction>
-static void morph(const SkPMColor* src, SkPMColor* dst,
-                  int radius, int width, int height, int srcStride, int dstStride) {
-    const int srcStrideX = direction == MorphDirection::kX ? 1 : srcStride;
-    const int dstStrideX = direction == MorphDirection::kX ? 1 : dstStride;
-    const int srcStrideY = direction == MorphDirection::kX ? srcStride : 1;
-    const int dstStrideY = direction == MorphDirection::kX ? dstStride : 1;
-    radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            // If we're maxing (dilate), start from 0; if minning (erode), start from 255.
-            const int start = (type == kDilate) ? 0 : 255;
-            int B = start, G = start, R = start, A = start;
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                int b = SkGetPackedB32(*p),
-                    g = SkGetPackedG32(*p),
-                    r = SkGetPackedR32(*p),
-                    a = SkGetPackedA32(*p);
-                if (type == kDilate) {
-                    B = SkTMax(b, B);
-                    G = SkTMax(g, G);
-                    R = SkTMax(r, R);
-                    A = SkTMax(a, A);
-                } else {
-                    B = SkTMin(b, B);
-                    G = SkTMin(g, G);
-                    R = SkTMin(r, R);
-                    A = SkTMin(a, A);
+        for (int x = 0; x < width; ++x) {
+            Pixels e;
+            if (x <= radius) {
+                e = g[SkMin32(x + radius, width - 1)];      // Window starts at the first block.
+            } else if (x + radius < width) {
+                e = extreme(h[x - radius], g[x + radius]);
+            } else if (x - radius >= lastBlock) {
+                e = h[x - radius];                          // Window within the last block.
+            } else {
+                e = extreme(h[x - radius], g[width - 1]);
+            }
+
+            SkPMColor* p = dst + x * dstStrideX;
+            if (dstStrideY == 1 && lines == kLines) {
+                for (int i = 0; i < kLines / 4; ++i) {
+                    e.v[i].store(p + 4 * i);
+                }
+            } else {
+                SkPMColor px[kLines];
+                for (int i = 0; i < kLines / 4; ++i) {
+                    e.v[i].store(px + 4 * i);
+                }
+                for (int i = 0; i < lines; ++i) {
+                    p[i * dstStrideY] = px[i];
                 }
             }
-            *dptr = SkPackARGB32(A, R, G, B);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
         }
-        if (x >= radius) { src += srcStrideX; }
-        if (x + radius < width - 1) { upperSrc += srcStrideX; }
-        dst += dstStrideX;
+
+        src += kLines * srcStrideY;
+        dst += kLines * dstStrideY;
     }
 }
 
-#endif
-
 static auto dilate_x = &morph<kDilate, MorphDirection::kX>,
             dilate_y = &morph<kDilate, MorphDirection::kY>,
              erode_x = &morph<kErode,  MorphDirection::kX>,
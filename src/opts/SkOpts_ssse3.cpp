@@ -26,5 +26,8 @@ namespace SkOpts {
         grayA_to_rgbA         = ssse3::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = ssse3::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = ssse3::inverted_CMYK_to_BGR1;
+        strip_16_to_8         = ssse3::strip_16_to_8;
+        RGBA_to_565           = ssse3::RGBA_to_565;
+        BGRA_to_565           = ssse3::BGRA_to_565;
     }
 }
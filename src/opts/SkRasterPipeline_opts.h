@@ -1977,6 +1977,30 @@ STAGE(gradient, const SkJumper_GradientCtx* c) {
     gradient_lookup(c, idx, t, &r, &g, &b, &a);
 }
 
+// Finds the same idx as gradient, but with a branch-free binary search over ts[1..stopCount-1],
+// which are strictly increasing. That's log2(stopCount) gathers instead of stopCount compares.
+SI U32 gradient_search(const SkJumper_GradientCtx* c, F t) {
+    const uint32_t last = (uint32_t)c->stopCount - 1;
+    uint32_t step = 1;
+    while (step <= last / 2) {
+        step *= 2;
+    }
+
+    U32 idx = 0;
+    for (; step > 0; step /= 2) {
+        U32 probe   = idx + step;
+        I32 inRange = probe <= last;
+        F   ts      = gather(c->ts, if_then_else(inRange, probe, U32(last)));
+        idx = if_then_else(inRange & (t >= ts), probe, idx);
+    }
+    return idx;
+}
+
+STAGE(binary_search_gradient, const SkJumper_GradientCtx* c) {
+    auto t = r;
+    gradient_lookup(c, gradient_search(c, t), t, &r, &g, &b, &a);
+}
+
 STAGE(evenly_spaced_2_stop_gradient, const void* ctx) {
     // TODO: Rename Ctx SkJumper_EvenlySpaced2StopGradientCtx.
     struct Ctx { float f[4], b[4]; };
@@ -2263,6 +2287,89 @@ STAGE(gauss_a_to_rgba, Ctx::None) {
     b = a;
 }
 
+// Wraps integral lattice coordinate v into [0,256), all in float to avoid negative float->int.
+SI U32 perlin_lattice(F v) {
+    return trunc_(v - 256.0f * floor_(v * (1/256.0f)));
+}
+
+SI F perlin_dot(const float* gradients, U32 ix, F x, F y) {
+    return gather(gradients, 2*ix) * x + gather(gradients, 2*ix+1) * y;
+}
+
+// Turbulence and fractal noise as specified by SVG's feTurbulence, matching the tables built
+// by SkPerlinNoiseShader.  Expects x,y in r,g, already translated into noise space.
+STAGE(perlin_noise, const SkJumper_PerlinNoiseCtx* c) {
+    // SkPerlinNoiseShader rounds to whole noise-space coordinates; the +0.5 comes from seed_shader.
+    F nx = floor_(r) * c->baseFrequency[0],
+      ny = floor_(g) * c->baseFrequency[1];
+
+    F sum[4] = { 0, 0, 0, 0 };
+    float width  = (float)c->stitchWidth,
+          height = (float)c->stitchHeight,
+          ratio  = 1.0f;
+    const float kPerlinNoise = 4096.0f;
+    for (int octave = 0; octave < c->numOctaves; octave++) {
+        F px = nx + kPerlinNoise,
+          py = ny + kPerlinNoise,
+          x0 = floor_(px),
+          y0 = floor_(py),
+          x1 = x0 + 1.0f,
+          y1 = y0 + 1.0f,
+          tx = px - x0,
+          ty = py - y0;
+
+        if (c->stitchTiles) {
+            // Wrap lattice points that fall past the current stitch tile.
+            F wrapX = width  + kPerlinNoise,
+              wrapY = height + kPerlinNoise;
+            x0 = if_then_else(x0 >= wrapX, x0 - width , x0);
+            x1 = if_then_else(x1 >= wrapX, x1 - width , x1);
+            y0 = if_then_else(y0 >= wrapY, y0 - height, y0);
+            y1 = if_then_else(y1 >= wrapY, y1 - height, y1);
+        }
+
+        U32 i   = expand(gather(c->latticeSelector, perlin_lattice(x0))),
+            j   = expand(gather(c->latticeSelector, perlin_lattice(x1))),
+            iy0 = perlin_lattice(y0),
+            iy1 = perlin_lattice(y1),
+            b00 = (i + iy0) & 255,
+            b10 = (j + iy0) & 255,
+            b01 = (i + iy1) & 255,
+            b11 = (j + iy1) & 255;
+
+        F sx = tx * tx * (3 - 2 * tx),
+          sy = ty * ty * (3 - 2 * ty);
+        I32 pathological = (sx < 0) | (sy < 0) | (sx > 1) | (sy > 1);
+
+        for (int channel = 0; channel < 4; channel++) {
+            const float* gradients = c->gradients[channel];
+            F top = lerp(perlin_dot(gradients, b00, tx  , ty  ),
+                         perlin_dot(gradients, b10, tx-1, ty  ), sx),
+              bot = lerp(perlin_dot(gradients, b01, tx  , ty-1),
+                         perlin_dot(gradients, b11, tx-1, ty-1), sx),
+              n   = if_then_else(pathological, 0, lerp(top, bot, sy));
+            sum[channel] += (c->fractalNoise ? n : abs_(n)) * (1.0f / ratio);
+        }
+
+        nx *= 2.0f;
+        ny *= 2.0f;
+        ratio  *= 2.0f;
+        width  *= 2.0f;
+        height *= 2.0f;
+    }
+
+    for (int channel = 0; channel < 4; channel++) {
+        if (c->fractalNoise) {
+            sum[channel] = (sum[channel] + 1.0f) * 0.5f;
+        }
+        sum[channel] = min(max(0, sum[channel]), 1.0f);
+    }
+    r = sum[0];
+    g = sum[1];
+    b = sum[2];
+    a = sum[3];
+}
+
 // A specialized fused image shader for clamp-x, clamp-y, non-sRGB sampling.
 STAGE(bilerp_clamp_8888, const SkJumper_GatherCtx* ctx) {
     // (cx,cy) are the center of our sample.
@@ -3253,6 +3360,29 @@ STAGE_GP(gradient, const SkJumper_GradientCtx* c) {
     gradient_lookup(c, idx, t, &r, &g, &b, &a);
 }
 
+// See highp's gradient_search().
+SI U32 gradient_search(const SkJumper_GradientCtx* c, F t) {
+    const uint32_t last = (uint32_t)c->stopCount - 1;
+    uint32_t step = 1;
+    while (step <= last / 2) {
+        step *= 2;
+    }
+
+    U32 idx = 0;
+    for (; step > 0; step /= 2) {
+        U32 probe   = idx + step;
+        I32 inRange = probe <= last;
+        F   ts      = gather<F>(c->ts, if_then_else(inRange, probe, U32(last)));
+        idx = if_then_else(inRange & (t >= ts), probe, idx);
+    }
+    return idx;
+}
+
+STAGE_GP(binary_search_gradient, const SkJumper_GradientCtx* c) {
+    auto t = x;
+    gradient_lookup(c, gradient_search(c, t), t, &r, &g, &b, &a);
+}
+
 STAGE_GP(evenly_spaced_gradient, const SkJumper_GradientCtx* c) {
     auto t = x;
     auto idx = trunc_(t * (c->stopCount-1));
@@ -3407,7 +3537,7 @@ static NotImplemented
         table_r, table_g, table_b, table_a,
         gamma, gamma_dst,
         lab_to_xyz, rgb_to_hsl, hsl_to_rgb, clut_3D, clut_4D,
-        gauss_a_to_rgba,
+        gauss_a_to_rgba, perlin_noise,
         mirror_x, repeat_x,
         mirror_y, repeat_y,
         negate_x,
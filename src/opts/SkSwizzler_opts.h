@@ -166,6 +166,51 @@ static void inverted_CMYK_to_BGR1_portable(uint32_t* dst, const void* vsrc, int
     }
 }
 
+static void strip_16_to_8_portable(uint8_t dst[], const void* vsrc, int count) {
+    auto src = (const uint8_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        // Keep the most significant byte of each big-endian component.
+        dst[i] = src[2*i];
+    }
+}
+
+static void index_to_n32_portable(uint32_t dst[], const uint8_t src[], int count,
+                                  const uint32_t ctable[]) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = ctable[src[i]];
+    }
+}
+
+static void RGBA_to_565_portable(uint16_t dst[], const uint32_t src[], int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t b = src[i] >> 16,
+                g = src[i] >>  8,
+                r = src[i] >>  0;
+        dst[i] = (r >> 3) << 11
+               | (g >> 2) <<  5
+               | (b >> 3) <<  0;
+    }
+}
+
+static void BGRA_to_565_portable(uint16_t dst[], const uint32_t src[], int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[i] >> 16,
+                g = src[i] >>  8,
+                b = src[i] >>  0;
+        dst[i] = (r >> 3) << 11
+               | (g >> 2) <<  5
+               | (b >> 3) <<  0;
+    }
+}
+
+static void gather_32_portable(uint32_t dst[], const void* vsrc, int count, int stride) {
+    auto src = (const uint8_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        memcpy(dst + i, src, 4);
+        src += stride;
+    }
+}
+
 #if defined(SK_ARM_HAS_NEON)
 
 // Rounded divide by 255, (x + 127) / 255
@@ -490,6 +535,64 @@ static void inverted_cmyk_to(uint32_t* dst, const void* vsrc, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+/*not static*/ inline void strip_16_to_8(uint8_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+    while (count >= 16) {
+        // Load 16 components, splitting their high and low bytes.
+        uint8x16x2_t hilo = vld2q_u8(src);
+
+        // Store the high bytes.
+        vst1q_u8(dst, hilo.val[0]);
+        src += 16*2;
+        dst += 16;
+        count -= 16;
+    }
+
+    strip_16_to_8_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_n32(uint32_t dst[], const uint8_t src[], int count,
+                                        const uint32_t ctable[]) {
+    index_to_n32_portable(dst, src, count, ctable);
+}
+
+template <bool kSwapRB>
+static void pack_565(uint16_t dst[], const uint32_t src[], int count) {
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint8x8x4_t rgba = vld4_u8((const uint8_t*) src);
+        uint8x8_t r = kSwapRB ? rgba.val[2] : rgba.val[0],
+                  g = rgba.val[1],
+                  b = kSwapRB ? rgba.val[0] : rgba.val[2];
+
+        // Shift each channel into the top of a 16-bit lane, then insert them below each other.
+        uint16x8_t rgb = vshll_n_u8(r, 8);
+        rgb = vsriq_n_u16(rgb, vshll_n_u8(g, 8),  5);
+        rgb = vsriq_n_u16(rgb, vshll_n_u8(b, 8), 11);
+
+        // Store 8 pixels.
+        vst1q_u16(dst, rgb);
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? BGRA_to_565_portable : RGBA_to_565_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<false>(dst, src, count);
+}
+
+/*not static*/ inline void BGRA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<true>(dst, src, count);
+}
+
+/*not static*/ inline void gather_32(uint32_t dst[], const void* src, int count, int stride) {
+    gather_32_portable(dst, src, count, stride);
+}
+
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
 // Scale a byte by another.
@@ -797,6 +900,109 @@ static void inverted_cmyk_to(uint32_t* dst, const void* vsrc, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+/*not static*/ inline void strip_16_to_8(uint8_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+    // The components are big-endian, so the bytes we want are the low halves of 16-bit lanes.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    const __m256i lo8 = _mm256_set1_epi16(0x00FF);
+    while (count >= 32) {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (src +  0)), lo8),
+                b = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (src + 32)), lo8);
+
+        // packus works within 128-bit lanes, so put the quarters back in order after.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*) dst, packed);
+
+        src += 32*2;
+        dst += 32;
+        count -= 32;
+    }
+#endif
+    const __m128i lo8_128 = _mm_set1_epi16(0x00FF);
+    while (count >= 16) {
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*) (src +  0)), lo8_128),
+                b = _mm_and_si128(_mm_loadu_si128((const __m128i*) (src + 16)), lo8_128);
+        _mm_storeu_si128((__m128i*) dst, _mm_packus_epi16(a, b));
+
+        src += 16*2;
+        dst += 16;
+        count -= 16;
+    }
+
+    strip_16_to_8_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_n32(uint32_t dst[], const uint8_t src[], int count,
+                                        const uint32_t ctable[]) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    while (count >= 8) {
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) src));
+        __m256i colors  = _mm256_i32gather_epi32((const int*) ctable, indices, 4);
+        _mm256_storeu_si256((__m256i*) dst, colors);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+    index_to_n32_portable(dst, src, count, ctable);
+}
+
+template <bool kSwapRB>
+static void pack_565(uint16_t dst[], const uint32_t src[], int count) {
+    // Each 32-bit lane becomes rrrrrggg gggbbbbb in its low 16 bits.
+    auto pack = [](__m128i px) {
+        __m128i r, g = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x0000FC00)), 5), b;
+        if (kSwapRB) {
+            r = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x00F80000)), 8);
+            b = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x000000F8)), 3);
+        } else {
+            r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x000000F8)), 8);
+            b = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x00F80000)), 19);
+        }
+        // Sign extend, so that packs_epi32 doesn't saturate values with the high bit set.
+        return _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(_mm_or_si128(r, g), b), 16), 16);
+    };
+
+    while (count >= 8) {
+        __m128i lo = pack(_mm_loadu_si128((const __m128i*) (src + 0))),
+                hi = pack(_mm_loadu_si128((const __m128i*) (src + 4)));
+        _mm_storeu_si128((__m128i*) dst, _mm_packs_epi32(lo, hi));
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? BGRA_to_565_portable : RGBA_to_565_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<false>(dst, src, count);
+}
+
+/*not static*/ inline void BGRA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<true>(dst, src, count);
+}
+
+/*not static*/ inline void gather_32(uint32_t dst[], const void* vsrc, int count, int stride) {
+    auto src = (const uint8_t*)vsrc;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0,1,2,3,4,5,6,7),
+                                               _mm256_set1_epi32(stride));
+    while (count >= 8) {
+        __m256i px = _mm256_i32gather_epi32((const int*) src, offsets, 1);
+        _mm256_storeu_si256((__m256i*) dst, px);
+
+        src += 8*stride;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+    gather_32_portable(dst, src, count, stride);
+}
+
 #else
 
 /*not static*/ inline void RGBA_to_rgbA(uint32_t* dst, const void* src, int count) {
@@ -839,6 +1045,27 @@ static void inverted_cmyk_to(uint32_t* dst, const void* vsrc, int count) {
     inverted_CMYK_to_BGR1_portable(dst, src, count);
 }
 
+/*not static*/ inline void strip_16_to_8(uint8_t dst[], const void* src, int count) {
+    strip_16_to_8_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_n32(uint32_t dst[], const uint8_t src[], int count,
+                                        const uint32_t ctable[]) {
+    index_to_n32_portable(dst, src, count, ctable);
+}
+
+/*not static*/ inline void RGBA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    RGBA_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void BGRA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    BGRA_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void gather_32(uint32_t dst[], const void* src, int count, int stride) {
+    gather_32_portable(dst, src, count, stride);
+}
+
 #endif
 
 }
@@ -8,6 +8,7 @@
 #include "SkAutoMalloc.h"
 #include "SkCanvasPriv.h"
 #include "SkColorFilter.h"
+#include "SkOpts.h"
 #include "SkDrawable.h"
 #include "SkDrawLooper.h"
 #include "SkDrawShadowInfo.h"
@@ -19,6 +20,7 @@
 #include "SkRSXform.h"
 #include "SkShader.h"
 #include "SkStream.h"
+#include "SkTHash.h"
 #include "SkTextBlob.h"
 #include "SkTypeface.h"
 
@@ -938,6 +940,11 @@ class SkPipeSerializer::Impl {
 public:
     SkPipeDeduper   fDeduper;
     std::unique_ptr<SkPipeCanvas> fCanvas;
+
+    // Only used between beginFrame() and endFrame().
+    SkDynamicMemoryWStream  fFrameStream;
+    SkWStream*              fFrameDst = nullptr;
+    SkTDArray<uint32_t>     fPrevFrame;
 };
 
 SkPipeSerializer::SkPipeSerializer() : fImpl(new Impl) {}
@@ -998,3 +1005,103 @@ void SkPipeSerializer::endWrite() {
     fImpl->fCanvas.reset(nullptr);
     fImpl->fDeduper.setCanvas(nullptr);
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Runs shorter than this are cheaper to patch than to copy (a copy record is 2 words).
+static constexpr int kMinCopyWords = 4;
+
+static uint32_t hash_words(const uint32_t* words) {
+    return SkOpts::hash(words, kMinCopyWords * sizeof(uint32_t));
+}
+
+static void write_patch(SkWStream* stream, const uint32_t* words, int count) {
+    if (count > 0) {
+        stream->write32(count << kCount_FrameDeltaShift);
+        stream->write(words, count * sizeof(uint32_t));
+    }
+}
+
+static void write_copy(SkWStream* stream, int prevOffset, int count) {
+    stream->write32((count << kCount_FrameDeltaShift) | kIsCopy_FrameDeltaMask);
+    stream->write32(prevOffset);
+}
+
+/*
+ *  Greedy block matching: every kMinCopyWords-word window of the previous frame is hashed, and
+ *  we walk the new frame looking for the longest run we can copy from each position. Most edits
+ *  between frames are in-place (a changed matrix or color), so before consulting the hash we try
+ *  to resume at the same shift as the last copy.
+ */
+static void write_frame_delta(const SkTDArray<uint32_t>& prev, const SkTDArray<uint32_t>& curr,
+                              SkWStream* stream) {
+    const int prevCount = prev.count();
+    const int currCount = curr.count();
+
+    stream->write32(pack_verb(SkPipeVerb::kFrameDelta));
+    stream->write32(currCount);
+
+    SkTHashMap<uint32_t, int> windows;
+    for (int i = 0; i + kMinCopyWords <= prevCount; ++i) {
+        uint32_t hash = hash_words(&prev[i]);
+        if (!windows.find(hash)) {
+            windows.set(hash, i);
+        }
+    }
+
+    auto matches = [&](int p, int c) {
+        return p >= 0 && p + kMinCopyWords <= prevCount &&
+               !memcmp(&prev[p], &curr[c], kMinCopyWords * sizeof(uint32_t));
+    };
+
+    int patchStart = 0;
+    int shift = 0;      // prev offset - curr offset of the last copy
+    int i = 0;
+    while (i + kMinCopyWords <= currCount) {
+        int src = i + shift;
+        if (!matches(src, i)) {
+            const int* found = windows.find(hash_words(&curr[i]));
+            src = (found && matches(*found, i)) ? *found : -1;
+        }
+        if (src < 0) {
+            i += 1;
+            continue;
+        }
+
+        int count = kMinCopyWords;
+        while (i + count < currCount && src + count < prevCount &&
+               curr[i + count] == prev[src + count]) {
+            count += 1;
+        }
+
+        write_patch(stream, curr.begin() + patchStart, i - patchStart);
+        write_copy(stream, src, count);
+        shift = src - i;
+        i += count;
+        patchStart = i;
+    }
+    write_patch(stream, curr.begin() + patchStart, currCount - patchStart);
+}
+
+SkCanvas* SkPipeSerializer::beginFrame(const SkRect& cull, SkWStream* stream) {
+    SkASSERT(nullptr == fImpl->fFrameDst);
+    fImpl->fFrameDst = stream;
+    fImpl->fFrameStream.reset();
+    return this->beginWrite(cull, &fImpl->fFrameStream);
+}
+
+void SkPipeSerializer::endFrame() {
+    SkASSERT(fImpl->fFrameDst);
+    this->endWrite();
+
+    // Everything the pipe writes is 4-byte aligned.
+    SkASSERT(SkIsAlign4(fImpl->fFrameStream.bytesWritten()));
+    SkTDArray<uint32_t> frame;
+    frame.setCount(SkToInt(fImpl->fFrameStream.bytesWritten() >> 2));
+    fImpl->fFrameStream.copyTo(frame.begin());
+    fImpl->fFrameStream.reset();
+
+    write_frame_delta(fImpl->fPrevFrame, frame, fImpl->fFrameDst);
+    fImpl->fPrevFrame.swap(frame);
+    fImpl->fFrameDst = nullptr;
+}
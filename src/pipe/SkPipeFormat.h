@@ -59,6 +59,8 @@ enum class SkPipeVerb : uint8_t {
     kEndPicture,        // extra == picture_index
     kWriteImage,        // extra == image_index
     kWritePicture,      // extra == picture_index
+
+    kFrameDelta,        // extra == 0, followed by frame length (in 32bit words) and delta records
 };
 
 enum PaintUsage {
@@ -186,6 +188,17 @@ enum {
     kMatrixType_DrawTextOnPathMask      = 0xF << kMatrixType_DrawTextOnPathShift,
 };
 
+/*
+ *  A kFrameDelta frame is a sequence of records, each starting with a 32bit header
+ *      count:31 | is_copy:1
+ *  A copy record is followed by the offset (in words) of the first of count words to take from
+ *  the previous frame. A patch record is followed by count literal words.
+ */
+enum {
+    kIsCopy_FrameDeltaMask          = 1 << 0,
+    kCount_FrameDeltaShift          = 1,
+};
+
 enum {
     kHasPaint_DrawImageLatticeMask  = 1 << 0,
     kHasFlags_DrawImageLatticeMask  = 1 << 1,
@@ -30,11 +30,12 @@ class SkPipeInflator : public SkInflator {
 public:
     SkPipeInflator(SkRefSet<SkImage>* images, SkRefSet<SkPicture>* pictures,
                    SkRefSet<SkTypeface>* typefaces, SkTDArray<SkFlattenable::Factory>* factories,
-                   const SkDeserialProcs& procs)
+                   SkTDArray<uint32_t>* prevFrame, const SkDeserialProcs& procs)
         : fImages(images)
         , fPictures(pictures)
         , fTypefaces(typefaces)
         , fFactories(factories)
+        , fPrevFrame(prevFrame)
         , fProcs(procs)
     {}
 
@@ -80,6 +81,8 @@ public:
         fProcs = procs;
     }
 
+    SkTDArray<uint32_t>* prevFrame() { return fPrevFrame; }
+
     sk_sp<SkTypeface> makeTypeface(const void* data, size_t size);
     sk_sp<SkImage> makeImage(const sk_sp<SkData>&);
 
@@ -88,6 +91,7 @@ private:
     SkRefSet<SkPicture>*                fPictures;
     SkRefSet<SkTypeface>*               fTypefaces;
     SkTDArray<SkFlattenable::Factory>*  fFactories;
+    SkTDArray<uint32_t>*                fPrevFrame;
     SkDeserialProcs                     fProcs;
 };
 
@@ -195,6 +199,7 @@ public:
     {}
 
     SkPipeDeserializer* fSink;
+    bool                fInFrameDelta = false;  // A frame delta can't hold another.
 
     SkFlattenable::Factory findFactory(const char name[]) {
         SkFlattenable::Factory factory;
@@ -710,6 +715,58 @@ static void endPicture_handler(SkPipeReader& reader, uint32_t packedVerb, SkCanv
     SK_ABORT("not reached");  // never call me
 }
 
+// These are only valid as the tail of a readImage() or readPicture() buffer.
+static void writeImage_handler(SkPipeReader& reader, uint32_t packedVerb, SkCanvas* canvas) {
+    reader.validate(false);
+}
+
+static void writePicture_handler(SkPipeReader& reader, uint32_t packedVerb, SkCanvas* canvas) {
+    reader.validate(false);
+}
+
+static void frameDelta_handler(SkPipeReader& reader, uint32_t packedVerb, SkCanvas* canvas) {
+    SkASSERT(SkPipeVerb::kFrameDelta == unpack_verb(packedVerb));
+    if (!reader.validate(!reader.fInFrameDelta)) {
+        return;
+    }
+    SkPipeInflator* inflator = (SkPipeInflator*)reader.getInflator();
+    const SkTDArray<uint32_t>& prev = *inflator->prevFrame();
+
+    const uint32_t frameCount = reader.readUInt();
+    const uint32_t prevCount = prev.count();
+
+    SkTDArray<uint32_t> frame;
+    while (reader.isValid() && (uint32_t)frame.count() < frameCount) {
+        uint32_t header = reader.readUInt();
+        uint32_t count = header >> kCount_FrameDeltaShift;
+        if (!reader.validate(count > 0 && count <= frameCount - frame.count())) {
+            return;
+        }
+        if (header & kIsCopy_FrameDeltaMask) {
+            uint32_t offset = reader.readUInt();
+            if (!reader.validate(offset <= prevCount && count <= prevCount - offset)) {
+                return;
+            }
+            frame.append(SkToInt(count), &prev[offset]);
+        } else {
+            const uint32_t* words = reader.skipT<uint32_t>(count);
+            if (!words) {
+                return;
+            }
+            frame.append(SkToInt(count), words);
+        }
+    }
+    if (!reader.isValid()) {
+        return;
+    }
+
+    SkPipeReader frameReader(reader.fSink, frame.begin(), frame.count() * sizeof(uint32_t));
+    frameReader.setInflator(inflator);
+    frameReader.fInFrameDelta = true;
+    reader.validate(do_playback(frameReader, canvas));
+    inflator->prevFrame()->swap(frame);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 struct HandlerRec {
@@ -763,6 +820,10 @@ const HandlerRec gPipeHandlers[] = {
     HANDLER(defineFactory),
     HANDLER(definePicture),
     HANDLER(endPicture),        // handled special -- should never be called
+    HANDLER(writeImage),
+    HANDLER(writePicture),
+
+    HANDLER(frameDelta),
 };
 #undef HANDLER
 
@@ -774,6 +835,7 @@ public:
     SkRefSet<SkPicture>                 fPictures;
     SkRefSet<SkTypeface>                fTypefaces;
     SkTDArray<SkFlattenable::Factory>   fFactories;
+    SkTDArray<uint32_t>                 fPrevFrame;
     SkDeserialProcs                     fProcs;
 };
 
@@ -797,7 +859,7 @@ sk_sp<SkImage> SkPipeDeserializer::readImage(const void* data, size_t size) {
     if (SkPipeVerb::kDefineImage == unpack_verb(packedVerb)) {
         SkPipeInflator inflator(&fImpl->fImages, &fImpl->fPictures,
                                 &fImpl->fTypefaces, &fImpl->fFactories,
-                                fImpl->fProcs);
+                                &fImpl->fPrevFrame, fImpl->fProcs);
         SkPipeReader reader(this, ptr, size);
         reader.setInflator(&inflator);
         defineImage_handler(reader, packedVerb, nullptr);
@@ -827,7 +889,7 @@ sk_sp<SkPicture> SkPipeDeserializer::readPicture(const void* data, size_t size)
     if (SkPipeVerb::kDefinePicture == unpack_verb(packedVerb)) {
         SkPipeInflator inflator(&fImpl->fImages, &fImpl->fPictures,
                                 &fImpl->fTypefaces, &fImpl->fFactories,
-                                fImpl->fProcs);
+                                &fImpl->fPrevFrame, fImpl->fProcs);
         SkPipeReader reader(this, ptr, size);
         reader.setInflator(&inflator);
         definePicture_handler(reader, packedVerb, nullptr);
@@ -896,7 +958,7 @@ static bool do_playback(SkPipeReader& reader, SkCanvas* canvas, int* endPictureI
 bool SkPipeDeserializer::playback(const void* data, size_t size, SkCanvas* canvas) {
     SkPipeInflator inflator(&fImpl->fImages, &fImpl->fPictures,
                             &fImpl->fTypefaces, &fImpl->fFactories,
-                            fImpl->fProcs);
+                            &fImpl->fPrevFrame, fImpl->fProcs);
     SkPipeReader reader(this, data, size);
     reader.setInflator(&inflator);
     return do_playback(reader, canvas);
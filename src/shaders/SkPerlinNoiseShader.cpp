@@ -11,11 +11,14 @@
 #include "SkDither.h"
 #include "SkColorFilter.h"
 #include "SkMakeUnique.h"
+#include "SkRasterPipeline.h"
 #include "SkReadBuffer.h"
+#include "SkResourceCache.h"
 #include "SkShader.h"
 #include "SkString.h"
 #include "SkUnPreMultiply.h"
 #include "SkWriteBuffer.h"
+#include "../jumper/SkJumper.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -65,6 +68,48 @@ static uint8_t improved_noise_permutations[] = {
     141, 128, 195,  78,  66, 215,  61, 156, 180
 };
 
+namespace {
+
+// The lattice selector and gradient tables depend only on the seed, but are costly enough to
+// build that we cache them, e.g. for noise animated by its base frequency or matrix.
+struct PerlinNoiseTables {
+    uint8_t     fLatticeSelector[kBlockSize];
+    uint16_t    fNoise[4][kBlockSize][2];
+    SkPoint     fGradient[4][kBlockSize];
+};
+
+static unsigned gPerlinNoiseTablesKeyNamespaceLabel;
+
+struct PerlinNoiseTablesKey : public SkResourceCache::Key {
+    explicit PerlinNoiseTablesKey(int seed) : fSeed(seed) {
+        this->init(&gPerlinNoiseTablesKeyNamespaceLabel, 0, sizeof(fSeed));
+    }
+
+    int32_t fSeed;
+};
+
+struct PerlinNoiseTablesRec : public SkResourceCache::Rec {
+    PerlinNoiseTablesRec(const PerlinNoiseTablesKey& key, const PerlinNoiseTables& tables)
+        : fKey(key)
+        , fTables(tables) {}
+
+    PerlinNoiseTablesKey fKey;
+    PerlinNoiseTables    fTables;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this); }
+    const char* getCategory() const override { return "perlin-noise"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const PerlinNoiseTablesRec& rec = static_cast<const PerlinNoiseTablesRec&>(baseRec);
+        *(PerlinNoiseTables*)contextData = rec.fTables;
+        return true;
+    }
+};
+
+} // namespace
+
 class SkPerlinNoiseShaderImpl : public SkShaderBase {
 public:
     struct StitchData {
@@ -105,41 +150,6 @@ public:
             if (!fTileSize.isEmpty()) {
                 this->stitch();
             }
-
-    #if SK_SUPPORT_GPU
-            SkImageInfo info = SkImageInfo::MakeA8(kBlockSize, 1);
-            SkPixmap permutationsPixmap(info, fLatticeSelector, info.minRowBytes());
-            fPermutationsImage = SkImage::MakeFromRaster(permutationsPixmap, nullptr, nullptr);
-
-            info = SkImageInfo::MakeN32Premul(kBlockSize, 4);
-            SkPixmap noisePixmap(info, fNoise[0][0], info.minRowBytes());
-            fNoiseImage = SkImage::MakeFromRaster(noisePixmap, nullptr, nullptr);
-
-            info = SkImageInfo::MakeA8(256, 1);
-            SkPixmap impPermutationsPixmap(info, improved_noise_permutations, info.minRowBytes());
-            fImprovedPermutationsImage = SkImage::MakeFromRaster(impPermutationsPixmap, nullptr,
-                                                                 nullptr);
-
-            static uint8_t gradients[] = { 2, 2, 1, 0,
-                                           0, 2, 1, 0,
-                                           2, 0, 1, 0,
-                                           0, 0, 1, 0,
-                                           2, 1, 2, 0,
-                                           0, 1, 2, 0,
-                                           2, 1, 0, 0,
-                                           0, 1, 0, 0,
-                                           1, 2, 2, 0,
-                                           1, 0, 2, 0,
-                                           1, 2, 0, 0,
-                                           1, 0, 0, 0,
-                                           2, 2, 1, 0,
-                                           1, 0, 2, 0,
-                                           0, 2, 1, 0,
-                                           1, 0, 0, 0 };
-            info = SkImageInfo::MakeN32Premul(16, 1);
-            SkPixmap gradPixmap(info, gradients, info.minRowBytes());
-            fGradientImage = SkImage::MakeFromRaster(gradPixmap, nullptr, nullptr);
-    #endif
         }
 
     #if SK_SUPPORT_GPU
@@ -201,6 +211,16 @@ public:
             if (fSeed > kRandMaximum - 1) {
                 fSeed = kRandMaximum - 1;
             }
+
+            PerlinNoiseTablesKey key(fSeed);
+            PerlinNoiseTables tables;
+            if (SkResourceCache::Find(key, PerlinNoiseTablesRec::Visitor, &tables)) {
+                memcpy(fLatticeSelector, tables.fLatticeSelector, sizeof(fLatticeSelector));
+                memcpy(fNoise, tables.fNoise, sizeof(fNoise));
+                memcpy(fGradient, tables.fGradient, sizeof(fGradient));
+                return;
+            }
+
             for (int channel = 0; channel < 4; ++channel) {
                 for (int i = 0; i < kBlockSize; ++i) {
                     fLatticeSelector[i] = i;
@@ -255,6 +275,11 @@ public:
                                                    (fGradient[channel][i].fY + 1) * gHalfMax16bits);
                 }
             }
+
+            memcpy(tables.fLatticeSelector, fLatticeSelector, sizeof(fLatticeSelector));
+            memcpy(tables.fNoise, fNoise, sizeof(fNoise));
+            memcpy(tables.fGradient, fGradient, sizeof(fGradient));
+            SkResourceCache::Add(new PerlinNoiseTablesRec(key, tables));
         }
 
         // Only called once. Could be part of the constructor.
@@ -301,6 +326,43 @@ public:
     public:
 
 #if SK_SUPPORT_GPU
+        // Wraps the tables in images for the GPU effects.  The raster pipeline reads the tables
+        // directly, so only asFragmentProcessor() calls this.
+        void makeImages() {
+            SkImageInfo info = SkImageInfo::MakeA8(kBlockSize, 1);
+            SkPixmap permutationsPixmap(info, fLatticeSelector, info.minRowBytes());
+            fPermutationsImage = SkImage::MakeFromRaster(permutationsPixmap, nullptr, nullptr);
+
+            info = SkImageInfo::MakeN32Premul(kBlockSize, 4);
+            SkPixmap noisePixmap(info, fNoise[0][0], info.minRowBytes());
+            fNoiseImage = SkImage::MakeFromRaster(noisePixmap, nullptr, nullptr);
+
+            info = SkImageInfo::MakeA8(256, 1);
+            SkPixmap impPermutationsPixmap(info, improved_noise_permutations, info.minRowBytes());
+            fImprovedPermutationsImage = SkImage::MakeFromRaster(impPermutationsPixmap, nullptr,
+                                                                 nullptr);
+
+            static uint8_t gradients[] = { 2, 2, 1, 0,
+                                           0, 2, 1, 0,
+                                           2, 0, 1, 0,
+                                           0, 0, 1, 0,
+                                           2, 1, 2, 0,
+                                           0, 1, 2, 0,
+                                           2, 1, 0, 0,
+                                           0, 1, 0, 0,
+                                           1, 2, 2, 0,
+                                           1, 0, 2, 0,
+                                           1, 2, 0, 0,
+                                           1, 0, 0, 0,
+                                           2, 2, 1, 0,
+                                           1, 0, 2, 0,
+                                           0, 2, 1, 0,
+                                           1, 0, 0, 0 };
+            info = SkImageInfo::MakeN32Premul(16, 1);
+            SkPixmap gradPixmap(info, gradients, info.minRowBytes());
+            fGradientImage = SkImage::MakeFromRaster(gradPixmap, nullptr, nullptr);
+        }
+
         const sk_sp<SkImage> getPermutationsImage() const { return fPermutationsImage; }
 
         const sk_sp<SkImage> getNoiseImage() const { return fNoiseImage; }
@@ -339,6 +401,8 @@ public:
                       SkScalar baseFrequencyY, int numOctaves, SkScalar seed,
                       const SkISize* tileSize);
 
+    // Fractal noise and turbulence are drawn by onAppendStages(); only improved noise still
+    // has a legacy context.
     class PerlinNoiseShaderContext : public Context {
     public:
         PerlinNoiseShaderContext(const SkPerlinNoiseShaderImpl& shader, const ContextRec&);
@@ -346,16 +410,10 @@ public:
         void shadeSpan(int x, int y, SkPMColor[], int count) override;
 
     private:
-        SkPMColor shade(const SkPoint& point, StitchData& stitchData) const;
-        SkScalar calculateTurbulenceValueForPoint(
-                                                  int channel,
-                                                  StitchData& stitchData, const SkPoint& point) const;
+        SkPMColor shade(const SkPoint& point) const;
         SkScalar calculateImprovedNoiseValueForPoint(int channel, const SkPoint& point) const;
-        SkScalar noise2D(int channel,
-                         const StitchData& stitchData, const SkPoint& noiseVector) const;
 
         SkMatrix     fMatrix;
-        PaintingData fPaintingData;
 
         typedef Context INHERITED;
     };
@@ -370,6 +428,7 @@ public:
 protected:
     void flatten(SkWriteBuffer&) const override;
     Context* onMakeContext(const ContextRec&, SkArenaAlloc*) const override;
+    bool onAppendStages(const StageRec&) const override;
 
 private:
     const SkPerlinNoiseShaderImpl::Type fType;
@@ -385,27 +444,6 @@ private:
     typedef SkShaderBase INHERITED;
 };
 
-namespace {
-
-// noiseValue is the color component's value (or color)
-// limitValue is the maximum perlin noise array index value allowed
-// newValue is the current noise dimension (either width or height)
-inline int checkNoise(int noiseValue, int limitValue, int newValue) {
-    // If the noise value would bring us out of bounds of the current noise array while we are
-    // stiching noise tiles together, wrap the noise around the current dimension of the noise to
-    // stay within the array bounds in a continuous fashion (so that tiling lines are not visible)
-    if (noiseValue >= limitValue) {
-        noiseValue -= newValue;
-    }
-    return noiseValue;
-}
-
-inline SkScalar smoothCurve(SkScalar t) {
-    return t * t * (3 - 2 * t);
-}
-
-} // end namespace
-
 SkPerlinNoiseShaderImpl::SkPerlinNoiseShaderImpl(SkPerlinNoiseShaderImpl::Type type,
                                                  SkScalar baseFrequencyX,
                                                  SkScalar baseFrequencyY,
@@ -461,109 +499,6 @@ void SkPerlinNoiseShaderImpl::flatten(SkWriteBuffer& buffer) const {
     buffer.writeInt(fTileSize.fHeight);
 }
 
-SkScalar SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::noise2D(
-        int channel, const StitchData& stitchData, const SkPoint& noiseVector) const {
-    struct Noise {
-        int noisePositionIntegerValue;
-        int nextNoisePositionIntegerValue;
-        SkScalar noisePositionFractionValue;
-        Noise(SkScalar component)
-        {
-            SkScalar position = component + kPerlinNoise;
-            noisePositionIntegerValue = SkScalarFloorToInt(position);
-            noisePositionFractionValue = position - SkIntToScalar(noisePositionIntegerValue);
-            nextNoisePositionIntegerValue = noisePositionIntegerValue + 1;
-        }
-    };
-    Noise noiseX(noiseVector.x());
-    Noise noiseY(noiseVector.y());
-    SkScalar u, v;
-    const SkPerlinNoiseShaderImpl& perlinNoiseShader = static_cast<const SkPerlinNoiseShaderImpl&>(fShader);
-    // If stitching, adjust lattice points accordingly.
-    if (perlinNoiseShader.fStitchTiles) {
-        noiseX.noisePositionIntegerValue =
-            checkNoise(noiseX.noisePositionIntegerValue, stitchData.fWrapX, stitchData.fWidth);
-        noiseY.noisePositionIntegerValue =
-            checkNoise(noiseY.noisePositionIntegerValue, stitchData.fWrapY, stitchData.fHeight);
-        noiseX.nextNoisePositionIntegerValue =
-            checkNoise(noiseX.nextNoisePositionIntegerValue, stitchData.fWrapX, stitchData.fWidth);
-        noiseY.nextNoisePositionIntegerValue =
-            checkNoise(noiseY.nextNoisePositionIntegerValue, stitchData.fWrapY, stitchData.fHeight);
-    }
-    noiseX.noisePositionIntegerValue &= kBlockMask;
-    noiseY.noisePositionIntegerValue &= kBlockMask;
-    noiseX.nextNoisePositionIntegerValue &= kBlockMask;
-    noiseY.nextNoisePositionIntegerValue &= kBlockMask;
-    int i = fPaintingData.fLatticeSelector[noiseX.noisePositionIntegerValue];
-    int j = fPaintingData.fLatticeSelector[noiseX.nextNoisePositionIntegerValue];
-    int b00 = (i + noiseY.noisePositionIntegerValue) & kBlockMask;
-    int b10 = (j + noiseY.noisePositionIntegerValue) & kBlockMask;
-    int b01 = (i + noiseY.nextNoisePositionIntegerValue) & kBlockMask;
-    int b11 = (j + noiseY.nextNoisePositionIntegerValue) & kBlockMask;
-    SkScalar sx = smoothCurve(noiseX.noisePositionFractionValue);
-    SkScalar sy = smoothCurve(noiseY.noisePositionFractionValue);
-
-    if (sx < 0 || sy < 0 || sx > 1 || sy > 1) {
-        return 0;  // Check for pathological inputs.
-    }
-
-    // This is taken 1:1 from SVG spec: http://www.w3.org/TR/SVG11/filters.html#feTurbulenceElement
-    SkPoint fractionValue = SkPoint::Make(noiseX.noisePositionFractionValue,
-                                          noiseY.noisePositionFractionValue); // Offset (0,0)
-    u = fPaintingData.fGradient[channel][b00].dot(fractionValue);
-    fractionValue.fX -= SK_Scalar1; // Offset (-1,0)
-    v = fPaintingData.fGradient[channel][b10].dot(fractionValue);
-    SkScalar a = SkScalarInterp(u, v, sx);
-    fractionValue.fY -= SK_Scalar1; // Offset (-1,-1)
-    v = fPaintingData.fGradient[channel][b11].dot(fractionValue);
-    fractionValue.fX = noiseX.noisePositionFractionValue; // Offset (0,-1)
-    u = fPaintingData.fGradient[channel][b01].dot(fractionValue);
-    SkScalar b = SkScalarInterp(u, v, sx);
-    return SkScalarInterp(a, b, sy);
-}
-
-SkScalar SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::calculateTurbulenceValueForPoint(
-        int channel, StitchData& stitchData, const SkPoint& point) const {
-    const SkPerlinNoiseShaderImpl& perlinNoiseShader = static_cast<const SkPerlinNoiseShaderImpl&>(fShader);
-    if (perlinNoiseShader.fStitchTiles) {
-        // Set up TurbulenceInitial stitch values.
-        stitchData = fPaintingData.fStitchDataInit;
-    }
-    SkScalar turbulenceFunctionResult = 0;
-    SkPoint noiseVector(SkPoint::Make(point.x() * fPaintingData.fBaseFrequency.fX,
-                                      point.y() * fPaintingData.fBaseFrequency.fY));
-    SkScalar ratio = SK_Scalar1;
-    for (int octave = 0; octave < perlinNoiseShader.fNumOctaves; ++octave) {
-        SkScalar noise = noise2D(channel, stitchData, noiseVector);
-        SkScalar numer = (perlinNoiseShader.fType == kFractalNoise_Type) ?
-                            noise : SkScalarAbs(noise);
-        turbulenceFunctionResult += numer / ratio;
-        noiseVector.fX *= 2;
-        noiseVector.fY *= 2;
-        ratio *= 2;
-        if (perlinNoiseShader.fStitchTiles) {
-            // Update stitch values
-            stitchData.fWidth  *= 2;
-            stitchData.fWrapX   = stitchData.fWidth + kPerlinNoise;
-            stitchData.fHeight *= 2;
-            stitchData.fWrapY   = stitchData.fHeight + kPerlinNoise;
-        }
-    }
-
-    // The value of turbulenceFunctionResult comes from ((turbulenceFunctionResult) + 1) / 2
-    // by fractalNoise and (turbulenceFunctionResult) by turbulence.
-    if (perlinNoiseShader.fType == kFractalNoise_Type) {
-        turbulenceFunctionResult = SkScalarHalf(turbulenceFunctionResult + 1);
-    }
-
-    if (channel == 3) { // Scale alpha by paint value
-        turbulenceFunctionResult *= SkIntToScalar(getPaintAlpha()) / 255;
-    }
-
-    // Clamp result
-    return SkScalarPin(turbulenceFunctionResult, 0, SK_Scalar1);
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Improved Perlin Noise based on Java implementation found at http://mrl.nyu.edu/~perlin/noise/
 static SkScalar fade(SkScalar t) {
@@ -626,9 +561,7 @@ SkScalar SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::calculateImprovedNoi
 }
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-SkPMColor SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::shade(
-        const SkPoint& point, StitchData& stitchData) const {
-    const SkPerlinNoiseShaderImpl& perlinNoiseShader = static_cast<const SkPerlinNoiseShaderImpl&>(fShader);
+SkPMColor SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::shade(const SkPoint& point) const {
     SkPoint newPoint;
     fMatrix.mapPoints(&newPoint, &point, 1);
     newPoint.fX = SkScalarRoundToScalar(newPoint.fX);
@@ -636,13 +569,7 @@ SkPMColor SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::shade(
 
     U8CPU rgba[4];
     for (int channel = 3; channel >= 0; --channel) {
-        SkScalar value;
-        if (perlinNoiseShader.fType == kImprovedNoise_Type) {
-            value = calculateImprovedNoiseValueForPoint(channel, newPoint);
-        }
-        else {
-            value = calculateTurbulenceValueForPoint(channel, stitchData, newPoint);
-        }
+        SkScalar value = calculateImprovedNoiseValueForPoint(channel, newPoint);
         rgba[channel] = SkScalarFloorToInt(255 * value);
     }
     return SkPreMultiplyARGB(rgba[3], rgba[0], rgba[1], rgba[2]);
@@ -650,6 +577,9 @@ SkPMColor SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::shade(
 
 SkShaderBase::Context* SkPerlinNoiseShaderImpl::onMakeContext(const ContextRec& rec,
                                                            SkArenaAlloc* alloc) const {
+    if (fType != kImprovedNoise_Type) {
+        return nullptr;  // Use onAppendStages().
+    }
     return alloc->make<PerlinNoiseShaderContext>(*this, rec);
 }
 
@@ -667,8 +597,6 @@ SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::PerlinNoiseShaderContext(
         const SkPerlinNoiseShaderImpl& shader, const ContextRec& rec)
     : INHERITED(shader, rec)
     , fMatrix(total_matrix(rec, shader)) // used for temp storage, adjusted below
-    , fPaintingData(shader.fTileSize, shader.fSeed, shader.fBaseFrequencyX,
-                    shader.fBaseFrequencyY, fMatrix)
 {
     // This (1,1) translation is due to WebKit's 1 based coordinates for the noise
     // (as opposed to 0 based, usually). The same adjustment is in the setData() function.
@@ -679,13 +607,52 @@ SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::PerlinNoiseShaderContext(
 void SkPerlinNoiseShaderImpl::PerlinNoiseShaderContext::shadeSpan(
         int x, int y, SkPMColor result[], int count) {
     SkPoint point = SkPoint::Make(SkIntToScalar(x), SkIntToScalar(y));
-    StitchData stitchData;
     for (int i = 0; i < count; ++i) {
-        result[i] = shade(point, stitchData);
+        result[i] = shade(point);
         point.fX += SK_Scalar1;
     }
 }
 
+bool SkPerlinNoiseShaderImpl::onAppendStages(const StageRec& rec) const {
+    if (fType == kImprovedNoise_Type) {
+        return this->INHERITED::onAppendStages(rec);
+    }
+
+    SkMatrix matrix = SkMatrix::Concat(rec.fCTM, this->getLocalMatrix());
+    if (rec.fLocalM) {
+        matrix.preConcat(*rec.fLocalM);
+    }
+
+    auto paintingData = rec.fAlloc->make<PaintingData>(fTileSize, fSeed, fBaseFrequencyX,
+                                                       fBaseFrequencyY, matrix);
+
+    auto ctx = rec.fAlloc->make<SkJumper_PerlinNoiseCtx>();
+    ctx->latticeSelector = paintingData->fLatticeSelector;
+    for (int channel = 0; channel < 4; ++channel) {
+        ctx->gradients[channel] = &paintingData->fGradient[channel][0].fX;
+    }
+    ctx->baseFrequency[0] = paintingData->fBaseFrequency.fX;
+    ctx->baseFrequency[1] = paintingData->fBaseFrequency.fY;
+    ctx->numOctaves       = fNumOctaves;
+    ctx->fractalNoise     = fType == kFractalNoise_Type;
+    ctx->stitchTiles      = fStitchTiles;
+    ctx->stitchWidth      = paintingData->fStitchDataInit.fWidth;
+    ctx->stitchHeight     = paintingData->fStitchDataInit.fHeight;
+
+    // Like the GPU effect, only the translation applies to device coordinates; the rest of the
+    // matrix is folded into the base frequency.  The (1,1) is for WebKit's 1-based coordinates.
+    auto translate = rec.fAlloc->makeArray<float>(2);
+    translate[0] = 1 - matrix.getTranslateX();
+    translate[1] = 1 - matrix.getTranslateY();
+
+    auto p = rec.fPipeline;
+    p->append(SkRasterPipeline::seed_shader);
+    p->append(SkRasterPipeline::matrix_translate, translate);
+    p->append(SkRasterPipeline::perlin_noise, ctx);
+    p->append(SkRasterPipeline::premul);
+    return true;
+}
+
 /////////////////////////////////////////////////////////////////////
 
 #if SK_SUPPORT_GPU
@@ -1409,6 +1376,7 @@ std::unique_ptr<GrFragmentProcessor> SkPerlinNoiseShaderImpl::asFragmentProcesso
                                                                   fBaseFrequencyX,
                                                                   fBaseFrequencyY,
                                                                   matrix);
+    paintingData->makeImages();
 
     SkMatrix m = *args.fViewMatrix;
     m.setTranslateX(-localMatrix->getTranslateX() + SK_Scalar1);
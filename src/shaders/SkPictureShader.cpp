@@ -12,13 +12,16 @@
 #include "SkBitmapProcShader.h"
 #include "SkCanvas.h"
 #include "SkColorSpaceXformCanvas.h"
+#include "SkExecutor.h"
 #include "SkImage.h"
 #include "SkImageShader.h"
 #include "SkMatrixUtils.h"
 #include "SkPicture.h"
 #include "SkPictureImageGenerator.h"
+#include "SkMutex.h"
 #include "SkReadBuffer.h"
 #include "SkResourceCache.h"
+#include "SkTArray.h"
 
 #if SK_SUPPORT_GPU
 #include "GrCaps.h"
@@ -62,6 +65,18 @@ public:
         return (sharedID << 32) | shaderID;
     }
 
+    const SkSize& scale() const { return fScale; }
+
+    // Is this the same picture tile as other, possibly at a different scale?
+    bool sameTileAs(const BitmapShaderKey& other) const {
+        return this->getSharedID() == other.getSharedID() &&
+               fColorSpace     == other.fColorSpace &&
+               fTile           == other.fTile &&
+               fTmx            == other.fTmx &&
+               fTmy            == other.fTmy &&
+               fBlendBehavior  == other.fBlendBehavior;
+    }
+
 private:
     // TODO: there are some fishy things about using CS sk_sps in the key:
     //   - false negatives: keys are memcmp'ed, so we don't detect equivalent CSs
@@ -107,6 +122,120 @@ struct BitmapShaderRec : public SkResourceCache::Rec {
     }
 };
 
+// Holds a tile already rendered to raster pixels for asynchronous tile rendering.
+struct AsyncTileRec : public SkResourceCache::Rec {
+    AsyncTileRec(const BitmapShaderKey& key, sk_sp<SkShader> tileShader, size_t pixelBytes)
+        : fKey(key)
+        , fShader(std::move(tileShader))
+        , fPixelBytes(pixelBytes) {}
+
+    BitmapShaderKey fKey;
+    sk_sp<SkShader> fShader;
+    size_t          fPixelBytes;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fPixelBytes; }
+    const char* getCategory() const override { return "picture-shader-tile"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+};
+
+// Tiles rendered to raster pixels on an executor for the picture shaders sharing this cache.
+class AsyncTiles final : public SkPictureShader::AsyncTileCache {
+public:
+    AsyncTiles(SkExecutor* executor, size_t byteLimit)
+        : fExecutor(executor)
+        , fCache(byteLimit) {}
+
+    Stats stats() const override {
+        SkAutoMutexAcquire lock(fMutex);
+        Stats stats = fStats;
+        stats.fBytesUsed = fCache.getTotalBytesUsed();
+        return stats;
+    }
+
+    enum Found { kHit, kFallback, kMiss };
+
+    // Finds key's tile, or failing that the closest scale of the same tile, returning its shader
+    // and scale.
+    Found find(const BitmapShaderKey& key, sk_sp<SkShader>* tileShader, SkSize* scale) {
+        struct Closest {
+            const BitmapShaderKey* fKey;
+            const AsyncTileRec*    fRec;
+            SkScalar               fDistance;
+        } closest = { &key, nullptr, SK_ScalarMax };
+
+        SkAutoMutexAcquire lock(fMutex);
+        if (fCache.find(key, [](const SkResourceCache::Rec& rec, void* ctx) {
+                *(const AsyncTileRec**)ctx = static_cast<const AsyncTileRec*>(&rec);
+                return true;
+            }, &closest.fRec)) {
+            fStats.fHits++;
+            *tileShader = closest.fRec->fShader;
+            *scale      = closest.fRec->fKey.scale();
+            return kHit;
+        }
+
+        fCache.visitAll([](const SkResourceCache::Rec& baseRec, void* ctx) {
+            const AsyncTileRec& rec = static_cast<const AsyncTileRec&>(baseRec);
+            Closest* closest = (Closest*)ctx;
+            if (!rec.fKey.sameTileAs(*closest->fKey)) {
+                return;
+            }
+            SkScalar distance = SkScalarAbs(SkScalarLog2(rec.fKey.scale().width() /
+                                                         closest->fKey->scale().width()));
+            if (distance < closest->fDistance) {
+                closest->fRec      = &rec;
+                closest->fDistance = distance;
+            }
+        }, &closest);
+
+        if (!closest.fRec) {
+            fStats.fMisses++;
+            return kMiss;
+        }
+        fStats.fFallbacks++;
+        *tileShader = closest.fRec->fShader;
+        *scale      = closest.fRec->fKey.scale();
+        return kFallback;
+    }
+
+    // Returns the executor to render key's tile on, or null if it's already queued.
+    SkExecutor* queue(const BitmapShaderKey& key) {
+        SkAutoMutexAcquire lock(fMutex);
+        for (const BitmapShaderKey& pending : fPending) {
+            if (pending == key) {
+                return nullptr;
+            }
+        }
+        fPending.push_back(key);
+        return fExecutor;
+    }
+
+    void add(const BitmapShaderKey& key, sk_sp<SkShader> tileShader, size_t pixelBytes) {
+        SkAutoMutexAcquire lock(fMutex);
+        for (int i = 0; i < fPending.count(); ++i) {
+            if (fPending[i] == key) {
+                fPending.removeShuffle(i);
+                break;
+            }
+        }
+        // The tile may have been rendered twice if a draw could not wait for it; keep the first.
+        if (tileShader &&
+                !fCache.find(key, [](const SkResourceCache::Rec&, void*) { return true; },
+                             nullptr)) {
+            fCache.add(new AsyncTileRec(key, std::move(tileShader), pixelBytes));
+        }
+    }
+
+private:
+    // Everything below is guarded by fMutex.
+    mutable SkMutex           fMutex;
+    SkExecutor* const         fExecutor;
+    SkResourceCache           fCache;
+    SkTArray<BitmapShaderKey> fPending;  // Tiles queued on fExecutor.
+    Stats                     fStats = {0, 0, 0, 0};
+};
+
 static int32_t gNextID = 1;
 uint32_t next_id() {
     int32_t id;
@@ -120,13 +249,15 @@ uint32_t next_id() {
 
 SkPictureShader::SkPictureShader(sk_sp<SkPicture> picture, TileMode tmx, TileMode tmy,
                                  const SkMatrix* localMatrix, const SkRect* tile,
-                                 sk_sp<SkColorSpace> colorSpace)
+                                 sk_sp<SkColorSpace> colorSpace,
+                                 sk_sp<AsyncTileCache> asyncTiles)
     : INHERITED(localMatrix)
     , fPicture(std::move(picture))
     , fTile(tile ? *tile : fPicture->cullRect())
     , fTmx(tmx)
     , fTmy(tmy)
     , fColorSpace(std::move(colorSpace))
+    , fAsyncTiles(std::move(asyncTiles))
     , fUniqueID(next_id())
     , fAddedToCache(false) {}
 
@@ -137,12 +268,21 @@ SkPictureShader::~SkPictureShader() {
 }
 
 sk_sp<SkShader> SkPictureShader::Make(sk_sp<SkPicture> picture, TileMode tmx, TileMode tmy,
-                                      const SkMatrix* localMatrix, const SkRect* tile) {
+                                      const SkMatrix* localMatrix, const SkRect* tile,
+                                      sk_sp<AsyncTileCache> asyncTiles) {
     if (!picture || picture->cullRect().isEmpty() || (tile && tile->isEmpty())) {
         return SkShader::MakeEmptyShader();
     }
     return sk_sp<SkShader>(new SkPictureShader(std::move(picture), tmx, tmy, localMatrix, tile,
-                                               nullptr));
+                                               nullptr, std::move(asyncTiles)));
+}
+
+sk_sp<SkPictureShader::AsyncTileCache> SkPictureShader::AsyncTileCache::Make(SkExecutor* executor,
+                                                                             size_t byteLimit) {
+    if (!executor) {
+        return nullptr;
+    }
+    return sk_make_sp<AsyncTiles>(executor, byteLimit);
 }
 
 sk_sp<SkFlattenable> SkPictureShader::CreateProc(SkReadBuffer& buffer) {
@@ -240,35 +380,77 @@ sk_sp<SkShader> SkPictureShader::refBitmapShader(const SkMatrix& viewMatrix,
                         tileScale,
                         blendBehavior);
 
-    if (!SkResourceCache::Find(key, BitmapShaderRec::Visitor, &tileShader)) {
-        SkMatrix tileMatrix;
-        tileMatrix.setRectToRect(fTile, SkRect::MakeIWH(tileSize.width(), tileSize.height()),
-                                 SkMatrix::kFill_ScaleToFit);
-
-        sk_sp<SkImage> tileImage = SkImage::MakeFromGenerator(
-                SkPictureImageGenerator::Make(tileSize, fPicture, &tileMatrix, nullptr,
-                                              SkImage::BitDepth::kU8, sk_ref_sp(dstColorSpace)));
+    SkSize shaderScale = tileScale;
+    // Async tiles are raster only.
+    AsyncTiles* tiles = maxTextureSize ? nullptr : static_cast<AsyncTiles*>(fAsyncTiles.get());
+    if (tiles) {
+        AsyncTiles::Found found = tiles->find(key, &tileShader, &shaderScale);
+        if (found != AsyncTiles::kHit) {
+            // Our tiles go in the async cache, so have ~SkPictureShader purge them from there.
+            fAddedToCache.store(true);
+
+            // Renders the tile to raster pixels now, so drawing with it never has to.
+            // This picture shader may be gone by the time the executor runs it.
+            const TileMode tmx = fTmx, tmy = fTmy;
+            sk_sp<SkImage> tileImage = this->makeTileImage(tileSize, sk_ref_sp(dstColorSpace));
+            sk_sp<AsyncTileCache> cache = fAsyncTiles;
+            auto render = [key, tileSize, tmx, tmy, tileImage, cache]() {
+                sk_sp<SkImage> rasterImage = tileImage ? tileImage->makeRasterImage() : nullptr;
+                sk_sp<SkShader> shader = rasterImage ? rasterImage->makeShader(tmx, tmy)
+                                                     : nullptr;
+                static_cast<AsyncTiles*>(cache.get())->add(
+                        key, shader, SkImageInfo::MakeN32Premul(tileSize).computeMinByteSize());
+                return shader;
+            };
+
+            if (found == AsyncTiles::kMiss) {
+                // There's nothing to draw with meanwhile, so wait for the tile by rendering it.
+                tileShader = render();
+                if (!tileShader) {
+                    return nullptr;
+                }
+            } else if (SkExecutor* executor = tiles->queue(key)) {
+                executor->add(render);
+            }
+        }
+    } else if (!SkResourceCache::Find(key, BitmapShaderRec::Visitor, &tileShader)) {
+        sk_sp<SkImage> tileImage = this->makeTileImage(tileSize, sk_ref_sp(dstColorSpace));
         if (!tileImage) {
             return nullptr;
         }
 
-        if (fColorSpace) {
-            tileImage = tileImage->makeColorSpace(fColorSpace, SkTransferFunctionBehavior::kIgnore);
-        }
-
         tileShader = tileImage->makeShader(fTmx, fTmy);
 
         SkResourceCache::Add(new BitmapShaderRec(key, tileShader.get()));
         fAddedToCache.store(true);
     }
 
-    if (tileScale.width() != 1 || tileScale.height() != 1) {
-        localMatrix->writable()->preScale(1 / tileScale.width(), 1 / tileScale.height());
+    if (shaderScale.width() != 1 || shaderScale.height() != 1) {
+        localMatrix->writable()->preScale(1 / shaderScale.width(), 1 / shaderScale.height());
     }
 
     return tileShader;
 }
 
+sk_sp<SkImage> SkPictureShader::makeTileImage(const SkISize& tileSize,
+                                              sk_sp<SkColorSpace> dstColorSpace) const {
+    SkMatrix tileMatrix;
+    tileMatrix.setRectToRect(fTile, SkRect::MakeIWH(tileSize.width(), tileSize.height()),
+                             SkMatrix::kFill_ScaleToFit);
+
+    sk_sp<SkImage> tileImage = SkImage::MakeFromGenerator(
+            SkPictureImageGenerator::Make(tileSize, fPicture, &tileMatrix, nullptr,
+                                          SkImage::BitDepth::kU8, std::move(dstColorSpace)));
+    if (!tileImage) {
+        return nullptr;
+    }
+
+    if (fColorSpace) {
+        tileImage = tileImage->makeColorSpace(fColorSpace, SkTransferFunctionBehavior::kIgnore);
+    }
+    return tileImage;
+}
+
 bool SkPictureShader::onAppendStages(const StageRec& rec) const {
     auto lm = this->totalLocalMatrix(rec.fLocalM);
 
@@ -313,7 +495,7 @@ sk_sp<SkShader> SkPictureShader::onMakeColorSpace(SkColorSpaceXformer* xformer)
     }
 
     return sk_sp<SkPictureShader>(new SkPictureShader(fPicture, fTmx, fTmy, &this->getLocalMatrix(),
-                                                      &fTile, std::move(dstCS)));
+                                                      &fTile, std::move(dstCS), fAsyncTiles));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
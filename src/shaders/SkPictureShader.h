@@ -13,6 +13,8 @@
 
 class SkArenaAlloc;
 class SkBitmap;
+class SkExecutor;
+class SkImage;
 class SkPicture;
 
 /*
@@ -25,8 +27,34 @@ class SkPictureShader : public SkShaderBase {
 public:
     ~SkPictureShader() override;
 
+    /**
+     *  Picture shaders made with one of these render their raster tiles on an executor instead
+     *  of in the draw that first needs them.  Until a tile is ready, draws use the nearest
+     *  already rendered scale of the same tile, or render the tile themselves if there is none.
+     *  These tiles are cached apart from the global SkResourceCache, within this cache's own
+     *  budget of byteLimit bytes.
+     *
+     *  Several picture shaders may share one cache.  Tiles still queued on the executor keep
+     *  their cache alive, and a shader's tiles are purged once it's destroyed.
+     *
+     *  This is internal for now: there's no public SkShader factory that takes one.
+     */
+    class AsyncTileCache : public SkRefCnt {
+    public:
+        // Returns null if executor is null.
+        static sk_sp<AsyncTileCache> Make(SkExecutor* executor, size_t byteLimit);
+
+        struct Stats {
+            int    fHits;       // Draws that found their tile ready.
+            int    fFallbacks;  // Draws that used another scale while their tile was rendering.
+            int    fMisses;     // Draws that found nothing usable, and rendered their own tile.
+            size_t fBytesUsed;
+        };
+        virtual Stats stats() const = 0;
+    };
+
     static sk_sp<SkShader> Make(sk_sp<SkPicture>, TileMode, TileMode, const SkMatrix*,
-                                const SkRect*);
+                                const SkRect*, sk_sp<AsyncTileCache> = nullptr);
 
     void toString(SkString* str) const override;
     SK_DECLARE_PUBLIC_FLATTENABLE_DESERIALIZATION_PROCS(SkPictureShader)
@@ -44,11 +72,12 @@ protected:
 
 private:
     SkPictureShader(sk_sp<SkPicture>, TileMode, TileMode, const SkMatrix*, const SkRect*,
-                    sk_sp<SkColorSpace>);
+                    sk_sp<SkColorSpace>, sk_sp<AsyncTileCache>);
 
     sk_sp<SkShader> refBitmapShader(const SkMatrix&, SkTCopyOnFirstWrite<SkMatrix>* localMatrix,
                                     SkColorSpace* dstColorSpace,
                                     const int maxTextureSize = 0) const;
+    sk_sp<SkImage> makeTileImage(const SkISize& tileSize, sk_sp<SkColorSpace> dstColorSpace) const;
 
     class PictureShaderContext : public Context {
     public:
@@ -74,6 +103,9 @@ private:
     // forces a deferred color space xform.
     sk_sp<SkColorSpace>    fColorSpace;
 
+    // Not serialized.
+    sk_sp<AsyncTileCache>  fAsyncTiles;
+
     const uint32_t         fUniqueID;
     mutable SkAtomic<bool> fAddedToCache;
 
@@ -274,6 +274,9 @@ static void init_stop_pos(
     add_stop_color(ctx, stop, Fs, Bs);
 }
 
+// Gradients with more stops than this search for t's interval with binary_search_gradient.
+static constexpr size_t kLinearSearchStopLimit = 32;
+
 bool SkGradientShaderBase::onAppendStages(const StageRec& rec) const {
     SkRasterPipeline* p = rec.fPipeline;
     SkArenaAlloc* alloc = rec.fAlloc;
@@ -396,7 +399,9 @@ bool SkGradientShaderBase::onAppendStages(const StageRec& rec) const {
             add_const_color(ctx, stopCount++, c_l);
 
             ctx->stopCount = stopCount;
-            p->append(SkRasterPipeline::gradient, ctx);
+            // With many stops, a binary search beats testing t against every one of them.
+            p->append(stopCount > kLinearSearchStopLimit ? SkRasterPipeline::binary_search_gradient
+                                                         : SkRasterPipeline::gradient, ctx);
         }
     }
 
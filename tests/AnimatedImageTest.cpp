@@ -14,6 +14,7 @@
 #include "SkCodec.h"
 #include "SkColor.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkImageInfo.h"
 #include "SkPicture.h"
 #include "SkRefCnt.h"
@@ -275,3 +276,69 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+// Frames taken from the frame cache, whether decoded ahead or shown before, should match
+// frames decoded without it.
+DEF_TEST(AnimatedImage_frameCache, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/webp-animated.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        auto expected = SkAnimatedImage::Make(SkAndroidCodec::MakeFromCodec(
+                    SkCodec::MakeFromData(data)));
+        auto actual = SkAnimatedImage::Make(SkAndroidCodec::MakeFromCodec(
+                    SkCodec::MakeFromData(data)));
+        if (!expected || !actual) {
+            ERRORF(r, "Could not create animated images for %s", file);
+            continue;
+        }
+        expected->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+        actual->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+
+        const SkRect bounds = expected->getBounds();
+        const auto info = SkImageInfo::MakeN32Premul(bounds.width(), bounds.height());
+        actual->setFrameCacheBudget(4 * info.computeMinByteSize());
+        actual->setDecodeAhead(executor.get(), 3);
+
+        auto draw = [&info](const sk_sp<SkAnimatedImage>& image) {
+            SkBitmap bm;
+            bm.allocPixels(info);
+            bm.eraseColor(0);
+            SkCanvas canvas(bm);
+            image->draw(&canvas);
+            return bm;
+        };
+
+        // Loop through the animation a few times, and start over in the middle of it.
+        for (int i = 0; i < 20; i++) {
+            if (i == 13) {
+                expected->reset();
+                actual->reset();
+            } else if (i > 0) {
+                REPORTER_ASSERT(r, expected->decodeNextFrame() == actual->decodeNextFrame());
+            }
+            REPORTER_ASSERT(r, expected->currentFrameDuration() == actual->currentFrameDuration());
+
+            SkBitmap e = draw(expected),
+                     a = draw(actual);
+            if (0 != memcmp(e.getPixels(), a.getPixels(), e.computeByteSize())) {
+                ERRORF(r, "%s differs on step %i", file, i);
+                break;
+            }
+        }
+        // Let the decode ahead finish before the resources go away.
+        executor.reset();
+        executor = SkExecutor::MakeFIFOThreadPool(2);
+    }
+}
@@ -10,6 +10,7 @@
 #include "SkAndroidCodec.h"
 #include "SkAutoMalloc.h"
 #include "SkBitmap.h"
+#include "SkBitmapRegionDecoder.h"
 #include "SkCanvas.h"
 #include "SkCodec.h"
 #include "SkCodecImageGenerator.h"
@@ -18,6 +19,7 @@
 #include "SkColorSpacePriv.h"
 #include "SkData.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
 #include "SkFrontBufferedStream.h"
 #include "SkImage.h"
 #include "SkImageGenerator.h"
@@ -958,6 +960,250 @@ DEF_TEST(Codec_wbmp_max_size, r) {
     REPORTER_ASSERT(r, !codec);
 }
 
+// Jpegs with restart markers may be decoded in bands of rows, but only when the whole image
+// is in memory.  The result should match decoding the image serially.
+DEF_TEST(Codec_jpeg_restart_bands, r) {
+    const char* path = "images/icc-v2-gbr.jpg";  // 4:2:0, restarts every 18 MCUs, one MCU row
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+
+    for (SkColorType ct : { kN32_SkColorType, kRGB_565_SkColorType }) {
+        SkBitmap bm[2];
+        for (int i = 0; i < 2; i++) {
+            std::unique_ptr<SkStream> stream;
+            if (0 == i) {
+                stream = skstd::make_unique<SkMemoryStream>(data);
+            } else {
+                stream = skstd::make_unique<NotAssetMemStream>(data);
+            }
+            std::unique_ptr<SkCodec> codec(SkCodec::MakeFromStream(std::move(stream)));
+            if (!codec) {
+                ERRORF(r, "Unable to create codec '%s'.", path);
+                return;
+            }
+
+            SkCodec::Options options;
+            options.fExecutor = &SkExecutor::GetDefault();
+            bm[i].allocPixels(codec->getInfo().makeColorType(ct));
+            auto result = codec->getPixels(bm[i].info(), bm[i].getPixels(), bm[i].rowBytes(),
+                                           &options);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+
+            // Decode again, to make sure the codec rewinds correctly afterwards.
+            result = codec->getPixels(bm[i].info(), bm[i].getPixels(), bm[i].rowBytes(),
+                                      &options);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+        }
+
+        SkMD5::Digest digests[2];
+        md5(bm[0], &digests[0]);
+        md5(bm[1], &digests[1]);
+        REPORTER_ASSERT(r, digests[0] == digests[1]);
+    }
+
+    // A truncated image has too few restart markers, and falls back to a serial decode.
+    data = SkData::MakeSubset(data.get(), 0, data->size() * 3 / 4);
+    std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(data));
+    if (codec) {
+        SkCodec::Options options;
+        options.fExecutor = &SkExecutor::GetDefault();
+        SkBitmap bm;
+        bm.allocPixels(codec->getInfo());
+        REPORTER_ASSERT(r, SkCodec::kIncompleteInput ==
+                           codec->getPixels(bm.info(), bm.getPixels(), bm.rowBytes(), &options));
+    }
+}
+
+// Subsets of jpegs with restart markers are decoded from the restart intervals that cover
+// them, and should match the same rows of the whole image.
+DEF_TEST(Codec_jpeg_restart_subset, r) {
+    const char* path = "images/icc-v2-gbr.jpg";  // 275x207, 4:2:0, restarts every MCU row
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+
+    for (SkColorType ct : { kN32_SkColorType, kRGB_565_SkColorType }) {
+        std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromData(data));
+        if (!codec) {
+            ERRORF(r, "Unable to create codec '%s'.", path);
+            return;
+        }
+
+        SkBitmap full;
+        full.allocPixels(codec->getInfo().makeColorType(ct));
+        REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                           codec->getAndroidPixels(full.info(), full.getPixels(), full.rowBytes()));
+
+        // Decode several subsets with the same codec, as SkBitmapRegionDecoder would.
+        for (SkIRect subset : { SkIRect::MakeXYWH(  0,  96, 275,  64),
+                                SkIRect::MakeXYWH( 40, 100,  99,  50),
+                                SkIRect::MakeXYWH( 17, 170, 200,  37),
+                                SkIRect::MakeXYWH(  3,   5,  60, 180),
+                                SkIRect::MakeXYWH(  0, 206, 275,   1) }) {
+            SkAndroidCodec::AndroidOptions options;
+            options.fSubset = &subset;
+            SkBitmap bm;
+            bm.allocPixels(full.info().makeWH(subset.width(), subset.height()));
+            auto result = codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                  &options);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+
+            SkBitmap expected;
+            REPORTER_ASSERT(r, full.extractSubset(&expected, subset));
+            for (int y = 0; y < subset.height(); y++) {
+                if (0 != memcmp(bm.getAddr(0, y), expected.getAddr(0, y),
+                                subset.width() * bm.bytesPerPixel())) {
+                    ERRORF(r, "Subset [%d %d %d %d] of %s differs at row %d.",
+                           subset.fLeft, subset.fTop, subset.fRight, subset.fBottom, path, y);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Box filtered sampling should match averaging the blocks of a full size decode.
+DEF_TEST(Codec_sampleFilter_box, r) {
+    struct {
+        const char* fPath;
+        int         fSampleSize;
+        SkIRect     fSubset;  // Empty for the whole image.
+    } recs[] = {
+        { "images/mandrill_512.png",       3, SkIRect::MakeEmpty() },
+        { "images/mandrill_512.png",       4, SkIRect::MakeXYWH(100, 60, 301, 203) },
+        { "images/plane_interlaced.png",   5, SkIRect::MakeEmpty() },
+        { "images/mandrill_512_q075.jpg",  3, SkIRect::MakeXYWH(33, 0, 200, 512) },
+        { "images/randPixels.gif",         3, SkIRect::MakeEmpty() },
+        { "images/randPixels.bmp",         2, SkIRect::MakeEmpty() },
+    };
+    for (const auto& rec : recs) {
+        sk_sp<SkData> data(GetResourceAsData(rec.fPath));
+        if (!data) {
+            continue;
+        }
+        std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromData(data));
+        if (!codec) {
+            ERRORF(r, "Unable to create codec '%s'.", rec.fPath);
+            continue;
+        }
+
+        const SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType)
+                                                 .makeAlphaType(kPremul_SkAlphaType);
+        SkBitmap full;
+        full.allocPixels(info);
+        auto result = codec->getAndroidPixels(info, full.getPixels(), full.rowBytes());
+        REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+
+        SkIRect subset = rec.fSubset.isEmpty() ? info.bounds() : rec.fSubset;
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = rec.fSampleSize;
+        options.fSampleFilter = SkAndroidCodec::SampleFilter::kBox;
+        if (!rec.fSubset.isEmpty()) {
+            options.fSubset = &subset;
+        }
+        const SkISize size = SkISize::Make(subset.width() / rec.fSampleSize,
+                                           subset.height() / rec.fSampleSize);
+        SkBitmap bm;
+        bm.allocPixels(info.makeWH(size.width(), size.height()));
+        result = codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(), &options);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+
+        // The sampled size is rounded down, so each block may be larger than fSampleSize.
+        const int nx = subset.width()  / size.width(),
+                  ny = subset.height() / size.height();
+        const int left = subset.left() + (subset.width()  - size.width()  * nx) / 2,
+                  top  = subset.top()  + (subset.height() - size.height() * ny) / 2;
+        bool matches = true;
+        for (int y = 0; y < size.height() && matches; y++) {
+            for (int x = 0; x < size.width() && matches; x++) {
+                uint32_t sums[4] = { 0, 0, 0, 0 };
+                for (int j = 0; j < ny; j++) {
+                    for (int i = 0; i < nx; i++) {
+                        const uint8_t* px = (const uint8_t*) full.getAddr32(left + x * nx + i,
+                                                                            top  + y * ny + j);
+                        for (int c = 0; c < 4; c++) {
+                            sums[c] += px[c];
+                        }
+                    }
+                }
+                const uint8_t* px = (const uint8_t*) bm.getAddr32(x, y);
+                for (int c = 0; c < 4; c++) {
+                    if (px[c] != (sums[c] + nx * ny / 2) / (nx * ny)) {
+                        ERRORF(r, "%s sampled by %d differs at (%d, %d).",
+                               rec.fPath, rec.fSampleSize, x, y);
+                        matches = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Other 8-bit color types are averaged in 8888 and converted.
+        bm.allocPixels(bm.info().makeColorType(kRGB_565_SkColorType)
+                                .makeAlphaType(kOpaque_SkAlphaType));
+        if (codec->getInfo().isOpaque()) {
+            result = codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                             &options);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+        }
+    }
+}
+
+// Regions assembled from cached tiles should match regions decoded directly.
+DEF_TEST(Codec_regionDecoder_tileCache, r) {
+    for (const char* path : { "images/mandrill_512.png", "images/color_wheel.png" }) {
+        auto data = GetResourceAsData(path);
+        if (!data) {
+            continue;
+        }
+        std::unique_ptr<SkBitmapRegionDecoder> direct(SkBitmapRegionDecoder::Create(
+                data, SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+        std::unique_ptr<SkBitmapRegionDecoder> tiled(SkBitmapRegionDecoder::Create(
+                data, SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+        if (!direct || !tiled) {
+            ERRORF(r, "Could not create region decoders for %s", path);
+            continue;
+        }
+        tiled->setTileCacheSize(48);
+
+        const int w = direct->width(),
+                  h = direct->height();
+        for (int sampleSize : { 1, 2, 4 }) {
+            // Each region is decoded twice, so the second time comes entirely from the cache.
+            for (SkIRect region : { SkIRect::MakeXYWH(0, 0, w, h),
+                                    SkIRect::MakeXYWH(8, 16, w / 2, h / 3),
+                                    SkIRect::MakeXYWH(8, 16, w / 2, h / 3),
+                                    SkIRect::MakeXYWH(w / 2, h / 4, w, 40),
+                                    SkIRect::MakeXYWH(-40, -8, 100, h),
+                                    SkIRect::MakeXYWH(-40, -8, 100, h) }) {
+                region.fLeft  -= region.fLeft  % sampleSize;
+                region.fTop   -= region.fTop   % sampleSize;
+                SkBitmap expected, actual;
+                REPORTER_ASSERT(r, direct->decodeRegion(&expected, nullptr, region, sampleSize,
+                                                        kN32_SkColorType, false));
+                REPORTER_ASSERT(r, tiled->decodeRegion(&actual, nullptr, region, sampleSize,
+                                                       kN32_SkColorType, false));
+                REPORTER_ASSERT(r, expected.info() == actual.info());
+                if (expected.info() != actual.info()) {
+                    continue;
+                }
+                for (int y = 0; y < expected.height(); y++) {
+                    if (0 != memcmp(expected.getAddr(0, y), actual.getAddr(0, y),
+                                    expected.info().minRowBytes())) {
+                        ERRORF(r, "Region [%d %d %d %d] of %s at sampleSize %d differs at row %d.",
+                               region.fLeft, region.fTop, region.fRight, region.fBottom, path,
+                               sampleSize, y);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(Codec_jpeg_rewind, r) {
     const char* path = "images/mandrill_512_q075.jpg";
     sk_sp<SkData> data(GetResourceAsData(path));
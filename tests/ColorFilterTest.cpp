@@ -9,9 +9,11 @@
 #include "SkBlendMode.h"
 #include "SkColor.h"
 #include "SkColorFilter.h"
+#include "SkColorMatrix.h"
 #include "SkRandom.h"
 #include "SkReadBuffer.h"
 #include "SkRefCnt.h"
+#include "SkTableColorFilter.h"
 #include "SkWriteBuffer.h"
 #include "SkTypes.h"
 #include "Test.h"
@@ -112,3 +114,71 @@ DEF_TEST(ColorFilter, reporter) {
 
     test_composecolorfilter_limit(reporter);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool colors_close(SkColor a, SkColor b, int tolerance) {
+    return SkTAbs((int)SkColorGetA(a) - (int)SkColorGetA(b)) <= tolerance
+        && SkTAbs((int)SkColorGetR(a) - (int)SkColorGetR(b)) <= tolerance
+        && SkTAbs((int)SkColorGetG(a) - (int)SkColorGetG(b)) <= tolerance
+        && SkTAbs((int)SkColorGetB(a) - (int)SkColorGetB(b)) <= tolerance;
+}
+
+DEF_TEST(ColorFilterFoldChains, reporter) {
+    uint8_t ramp[256];
+    for (int i = 0; i < 256; ++i) {
+        ramp[i] = SkToU8(i / 2 + (i * i) / 510);
+    }
+    auto table  = SkTableColorFilter::MakeARGB(nullptr, ramp, ramp, ramp);
+    SkColorMatrix lightMatrix, dimMatrix;
+    lightMatrix.setScale(0.75f, 0.5f, 0.25f, 1);
+    lightMatrix.postTranslate(16, 32, 48, 0);
+    dimMatrix.setScale(0.5f, 0.5f, 0.5f, 0.75f);
+    auto light  = SkColorFilter::MakeMatrixFilterRowMajor255(lightMatrix.fMat);
+    auto dim    = SkColorFilter::MakeMatrixFilterRowMajor255(dimMatrix.fMat);
+    // Unlike make_filter(), a well conditioned filter, so we can compare against 8-bit steps.
+    auto mode   = SkColorFilter::MakeModeFilter(0x80204060, SkBlendMode::kSrcOver);
+
+    // Per-component matrices fold into tables from either side.
+    auto tableLight = table->makeComposed(light),
+         lightTable = light->makeComposed(table);
+    REPORTER_ASSERT(reporter, tableLight->asComponentTable(nullptr));
+    REPORTER_ASSERT(reporter, lightTable->asComponentTable(nullptr));
+
+    // Folds happen across the ends of existing compositions, however they were nested, so
+    // alternating matrices and tables around a mode filter never hit the compose limit.
+    sk_sp<SkColorFilter> filters[] = { table, light, dim, table, dim, light, table, light };
+    auto inner = mode->makeComposed(mode);
+    auto outer = mode->makeComposed(mode);
+    for (const auto& f : filters) {
+        inner = inner ? inner->makeComposed(f) : nullptr;
+        outer = outer ? f->makeComposed(outer) : nullptr;
+    }
+    REPORTER_ASSERT(reporter, inner && outer);
+    if (!inner || !outer) {
+        return;
+    }
+
+    const SkColor colors[] = {
+        SK_ColorBLACK, SK_ColorWHITE, 0xFF123456, 0xFFFEDCBA, 0xFF80FF00, 0xFF0A141E,
+    };
+    for (SkColor c : colors) {
+        REPORTER_ASSERT(reporter, colors_close(tableLight->filterColor(c),
+                                               table->filterColor(light->filterColor(c)), 1));
+        REPORTER_ASSERT(reporter, colors_close(lightTable->filterColor(c),
+                                               light->filterColor(table->filterColor(c)), 1));
+
+        SkColor expectInner = c,
+                expectOuter = mode->filterColor(mode->filterColor(c));
+        for (const auto& f : filters) {
+            expectOuter = f->filterColor(expectOuter);
+        }
+        for (int i = SK_ARRAY_COUNT(filters) - 1; i >= 0; --i) {
+            expectInner = filters[i]->filterColor(expectInner);
+        }
+        expectInner = mode->filterColor(mode->filterColor(expectInner));
+
+        REPORTER_ASSERT(reporter, colors_close(inner->filterColor(c), expectInner, 2));
+        REPORTER_ASSERT(reporter, colors_close(outer->filterColor(c), expectOuter, 2));
+    }
+}
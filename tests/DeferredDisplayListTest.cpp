@@ -7,6 +7,22 @@
 
 #include "SkTypes.h"
 
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorSpace.h"
+#include "SkDeferredDisplayList.h"
+#include "SkDeferredDisplayListRecorder.h"
+#include "SkImage.h"
+#include "SkImageInfo.h"
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "SkRefCnt.h"
+#include "SkSurface.h"
+#include "SkSurfaceCharacterization.h"
+#include "SkSurfaceProps.h"
+#include "SkTaskGroup.h"
+#include "Test.h"
+
 #if SK_SUPPORT_GPU
 #include "GrBackendSurface.h"
 #include "GrCaps.h"
@@ -21,23 +37,9 @@
 #include "GrTextureProxyPriv.h"
 #include "GrTypes.h"
 #include "GrTypesPriv.h"
-#include "SkBitmap.h"
-#include "SkCanvas.h"
-#include "SkColorSpace.h"
-#include "SkDeferredDisplayList.h"
-#include "SkDeferredDisplayListRecorder.h"
 #include "SkGpuDevice.h"
-#include "SkImage.h"
-#include "SkImageInfo.h"
 #include "SkImage_Gpu.h"
-#include "SkPaint.h"
-#include "SkRect.h"
-#include "SkRefCnt.h"
-#include "SkSurface.h"
-#include "SkSurfaceCharacterization.h"
-#include "SkSurfaceProps.h"
 #include "SkSurface_Gpu.h"
-#include "Test.h"
 #include "gl/GrGLCaps.h"
 #include "gl/GrGLDefines.h"
 
@@ -941,3 +943,77 @@ DEF_GPUTEST_FOR_GL_RENDERING_CONTEXTS(DDLCompatibilityTest, reporter, ctxInfo) {
 }
 
 #endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Raster DDLs are recorded into a display list and don't need a GPU.
+
+static void draw_raster_ddl_content(SkCanvas* canvas, const sk_sp<SkImage>& image) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorRED);
+    canvas->drawCircle(32, 32, 20, paint);
+
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    canvas->translate(8, 8);
+    canvas->drawImageRect(image, SkRect::MakeWH(24, 24), nullptr);
+    canvas->restore();
+
+    paint.setColor(SK_ColorBLUE);
+    paint.setTextSize(16);
+    canvas->drawString("DDL", 4, 60, paint);
+}
+
+DEF_TEST(DDLRasterTest, reporter) {
+    const SkImageInfo ii = SkImageInfo::MakeN32Premul(64, 64);
+
+    // A lazy, encoded image: detach() should decode it on the recording thread.
+    sk_sp<SkImage> image;
+    {
+        auto src = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(16, 16));
+        src->getCanvas()->clear(SK_ColorGREEN);
+        sk_sp<SkData> encoded = src->makeImageSnapshot()->encodeToData();
+        REPORTER_ASSERT(reporter, encoded);
+        image = SkImage::MakeFromEncoded(std::move(encoded));
+        REPORTER_ASSERT(reporter, image && image->isLazyGenerated());
+    }
+
+    auto reference = SkSurface::MakeRaster(ii);
+    reference->getCanvas()->clear(SK_ColorWHITE);
+    draw_raster_ddl_content(reference->getCanvas(), image);
+
+    auto surface = SkSurface::MakeRaster(ii);
+    surface->getCanvas()->clear(SK_ColorWHITE);
+    // The DDL ignores whatever state the surface's own canvas is in.
+    surface->getCanvas()->translate(10, 10);
+    surface->getCanvas()->clipRect(SkRect::MakeWH(5, 5));
+
+    SkSurfaceCharacterization characterization;
+    REPORTER_ASSERT(reporter, surface->characterize(&characterization));
+    REPORTER_ASSERT(reporter, characterization.isValid());
+    REPORTER_ASSERT(reporter, characterization.isRaster());
+
+    std::unique_ptr<SkDeferredDisplayList> ddl;
+    SkTaskGroup().batch(1, [&](int) {
+        SkDeferredDisplayListRecorder recorder(characterization);
+        SkCanvas* canvas = recorder.getCanvas();
+        REPORTER_ASSERT(reporter, canvas);
+        draw_raster_ddl_content(canvas, image);
+        ddl = recorder.detach();
+        REPORTER_ASSERT(reporter, !recorder.getCanvas());
+    });
+    REPORTER_ASSERT(reporter, ddl);
+
+    // A surface with different properties can't play it back.
+    auto other = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(32, 32));
+    REPORTER_ASSERT(reporter, !other->draw(ddl.get()));
+
+    REPORTER_ASSERT(reporter, surface->draw(ddl.get()));
+
+    SkBitmap expected, actual;
+    expected.allocPixels(ii);
+    actual.allocPixels(ii);
+    REPORTER_ASSERT(reporter, reference->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(reporter, surface->readPixels(actual, 0, 0));
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.computeByteSize()));
+}
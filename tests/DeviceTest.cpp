@@ -6,9 +6,12 @@
  */
 
 #include "SkBitmap.h"
+#include "SkBitmapDevice.h"
 #include "SkDevice.h"
+#include "SkGraphics.h"
 #include "SkImage.h"
 #include "SkImageInfo.h"
+#include "SkPixmap.h"
 #include "SkRect.h"
 #include "SkRefCnt.h"
 #include "SkSpecialImage.h"
@@ -36,8 +39,109 @@ public:
     static sk_sp<SkSpecialImage> SnapSpecial(SkBaseDevice* dev) {
         return dev->snapSpecial();
     }
+
+    static sk_sp<SkBaseDevice> CreateLayer(SkBaseDevice* dev, const SkImageInfo& info) {
+        const SkBaseDevice::CreateInfo createInfo(info, SkBaseDevice::kNever_TileUsage,
+                                                  kUnknown_SkPixelGeometry);
+        return sk_sp<SkBaseDevice>(dev->onCreateDevice(createInfo, nullptr));
+    }
 };
 
+static const void* layer_pixels(SkBaseDevice* layer) {
+    SkPixmap pm;
+    return layer && layer->peekPixels(&pm) ? pm.addr() : nullptr;
+}
+
+DEF_TEST(BitmapDevice_LayerPool, reporter) {
+    const SkImageInfo ii = SkImageInfo::MakeN32Premul(100, 90);
+    sk_sp<SkBitmapDevice> top(SkBitmapDevice::Create(ii));
+
+    sk_sp<SkBaseDevice> layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    const void* pixels = layer_pixels(layer.get());
+    REPORTER_ASSERT(reporter, pixels);
+    SkPixmap pm;
+    REPORTER_ASSERT(reporter, layer->peekPixels(&pm));
+    pm.erase(SK_ColorRED);
+
+    // The next layer of a similar size gets the same buffer, cleared again.
+    layer = nullptr;
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii.makeWH(96, 90));
+    REPORTER_ASSERT(reporter, layer_pixels(layer.get()) == pixels);
+    REPORTER_ASSERT(reporter, layer->peekPixels(&pm));
+    bool cleared = true;
+    for (int y = 0; y < pm.height(); ++y) {
+        for (int x = 0; x < pm.width(); ++x) {
+            cleared = cleared && 0 == *pm.addr32(x, y);
+        }
+    }
+    REPORTER_ASSERT(reporter, cleared);
+
+    // A snapshot of a layer holds on to its pixels after the layer is gone.
+    sk_sp<SkSpecialImage> snapshot = DeviceTestingAccess::SnapSpecial(layer.get());
+    layer = nullptr;
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, layer_pixels(layer.get()) != pixels);
+    layer = nullptr;
+    snapshot = nullptr;
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, layer_pixels(layer.get()) == pixels);
+
+    // Layers of layers recycle through the top-level device's pool too.
+    sk_sp<SkBaseDevice> nested = DeviceTestingAccess::CreateLayer(layer.get(), ii);
+    const void* nestedPixels = layer_pixels(nested.get());
+    REPORTER_ASSERT(reporter, nestedPixels && nestedPixels != pixels);
+    nested = nullptr;
+    nested = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, layer_pixels(nested.get()) == nestedPixels);
+    REPORTER_ASSERT(reporter, 2 == top->layerPoolAllocationCount());
+
+    // Purging frees the idle buffers, so the next layer needs a new one.
+    layer = nullptr;
+    nested = nullptr;
+    SkBitmapDevice::PurgeLayerPools();
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, 3 == top->layerPoolAllocationCount());
+}
+
+DEF_TEST(BitmapDevice_LayerPoolBudget, reporter) {
+    const SkImageInfo ii = SkImageInfo::MakeN32Premul(100, 90);
+
+    // Without a budget, nothing is kept; layers still work, each with its own buffer.
+    sk_sp<SkBitmapDevice> unpooled(SkBitmapDevice::Create(ii));
+    unpooled->setLayerPoolBudget(0);
+    for (int i = 0; i < 3; ++i) {
+        sk_sp<SkBaseDevice> layer = DeviceTestingAccess::CreateLayer(unpooled.get(), ii);
+        REPORTER_ASSERT(reporter, layer_pixels(layer.get()));
+    }
+    REPORTER_ASSERT(reporter, 3 == unpooled->layerPoolAllocationCount());
+
+    // The budget belongs to the top-level device, and lowering it frees what no longer fits.
+    sk_sp<SkBitmapDevice> top(SkBitmapDevice::Create(ii));
+    sk_sp<SkBaseDevice> layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    layer = nullptr;
+    top->setLayerPoolBudget(ii.computeMinByteSize() / 2);
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, 2 == top->layerPoolAllocationCount());
+
+    // A buffer bigger than the budget isn't kept either.
+    layer = nullptr;
+    layer = DeviceTestingAccess::CreateLayer(top.get(), ii);
+    REPORTER_ASSERT(reporter, 3 == top->layerPoolAllocationCount());
+
+    // Every pool also counts against the global limit.  Lowering it frees idle buffers, and
+    // buffers that don't fit under it aren't kept.
+    sk_sp<SkBitmapDevice> other(SkBitmapDevice::Create(ii));
+    layer = DeviceTestingAccess::CreateLayer(other.get(), ii);
+    layer = nullptr;
+    const size_t prevLimit = SkGraphics::SetLayerPoolTotalByteLimit(0);
+    layer = DeviceTestingAccess::CreateLayer(other.get(), ii);
+    REPORTER_ASSERT(reporter, 2 == other->layerPoolAllocationCount());
+    layer = nullptr;
+    layer = DeviceTestingAccess::CreateLayer(other.get(), ii);
+    REPORTER_ASSERT(reporter, 3 == other->layerPoolAllocationCount());
+    SkGraphics::SetLayerPoolTotalByteLimit(prevLimit);
+}
+
 // TODO: re-enable this when Raster methods are implemented
 #if 0
 DEF_TEST(SpecialImage_BitmapDevice, reporter) {
@@ -8,9 +8,13 @@
 #include "Resources.h"
 #include "Test.h"
 
+#include "SkAutoMalloc.h"
 #include "SkBitmap.h"
+#include "SkCodec.h"
 #include "SkColorPriv.h"
+#include "SkColorSpace.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
 #include "SkImage.h"
 #include "SkJpegEncoder.h"
 #include "SkPngEncoder.h"
@@ -172,6 +176,81 @@ DEF_TEST(Encode_JpegDownsample, r) {
     REPORTER_ASSERT(r, almost_equals(bm1, bm2, 60));
 }
 
+DEF_TEST(Encode_JpegYUV, r) {
+    // 4:2:0, 4:4:4, 4:2:2, a size that is not a multiple of 8, and one with an ICC profile.
+    for (const char* path : { "images/mandrill_512_q075.jpg", "images/mandrill_h1v1.jpg",
+                              "images/mandrill_h2v1.jpg", "images/cropped_mandrill.jpg",
+                              "images/icc-v2-gbr.jpg" }) {
+        sk_sp<SkData> data = GetResourceAsData(path);
+        if (!data) {
+            continue;
+        }
+
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        SkYUVSizeInfo sizeInfo;
+        SkYUVColorSpace yuvColorSpace;
+        REPORTER_ASSERT(r, codec && codec->queryYUV8(&sizeInfo, &yuvColorSpace));
+        if (!codec) {
+            continue;
+        }
+
+        size_t sizes[3];
+        for (int i = 0; i < 3; i++) {
+            sizes[i] = sizeInfo.fWidthBytes[i] * sizeInfo.fSizes[i].height();
+        }
+        SkAutoMalloc storage(sizes[0] + sizes[1] + sizes[2]);
+        void* planes[3];
+        planes[0] = storage.get();
+        planes[1] = SkTAddOffset<void>(planes[0], sizes[0]);
+        planes[2] = SkTAddOffset<void>(planes[1], sizes[1]);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(sizeInfo, planes));
+
+        SkColorSpace* colorSpace = codec->getInfo().colorSpace();
+        SkJpegEncoder::Options options;
+        SkDynamicMemoryWStream dst;
+        REPORTER_ASSERT(r, !SkJpegEncoder::EncodeYUV(&dst, sizeInfo, planes,
+                                                     kRec601_SkYUVColorSpace, colorSpace,
+                                                     options));
+        REPORTER_ASSERT(r, SkJpegEncoder::EncodeYUV(&dst, sizeInfo, planes, yuvColorSpace,
+                                                    colorSpace, options));
+
+        // The re-encoded jpeg should have the same layout, and look the same.
+        std::unique_ptr<SkCodec> reencoded = SkCodec::MakeFromData(dst.detachAsData());
+        SkYUVSizeInfo reencodedSizeInfo;
+        REPORTER_ASSERT(r, reencoded && reencoded->queryYUV8(&reencodedSizeInfo, nullptr));
+        if (!reencoded) {
+            continue;
+        }
+        for (int i = 0; i < 3; i++) {
+            REPORTER_ASSERT(r, sizeInfo.fSizes[i] == reencodedSizeInfo.fSizes[i]);
+        }
+        REPORTER_ASSERT(r, SkColorSpace::Equals(colorSpace, reencoded->getInfo().colorSpace()));
+
+        // Decode both without any color conversion, in the original's color space.
+        SkBitmap expected, actual;
+        SkImageInfo info = codec->getInfo();
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(expected.pixmap()));
+        REPORTER_ASSERT(r, SkCodec::kSuccess == reencoded->getPixels(actual.pixmap()));
+        REPORTER_ASSERT(r, almost_equals(expected, actual, 8));
+    }
+
+    // Planes that are not a 2x subsampling of Y are not supported.
+    SkYUVSizeInfo sizeInfo;
+    sizeInfo.fSizes[0].set(16, 16);
+    sizeInfo.fSizes[1].set(4, 16);
+    sizeInfo.fSizes[2].set(4, 16);
+    uint8_t pixels[16 * 16];
+    const void* planes[3] = { pixels, pixels, pixels };
+    for (int i = 0; i < 3; i++) {
+        sizeInfo.fWidthBytes[i] = 16;
+    }
+    SkDynamicMemoryWStream dst;
+    REPORTER_ASSERT(r, !SkJpegEncoder::EncodeYUV(&dst, sizeInfo, planes, kJPEG_SkYUVColorSpace,
+                                                 nullptr, SkJpegEncoder::Options()));
+}
+
 static inline void pushComment(
         std::vector<std::string>& comments, const char* keyword, const char* text) {
     comments.push_back(keyword);
@@ -286,6 +365,72 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngExecutor, r) {
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* path : { "images/mandrill_512.png", "images/color_wheel.png" }) {
+        SkBitmap bitmap;
+        if (!GetResourceAsBitmap(path, &bitmap)) {
+            continue;
+        }
+
+        SkPixmap src;
+        REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+        for (auto filters : { SkPngEncoder::FilterFlag::kAll, SkPngEncoder::FilterFlag::kNone,
+                              SkPngEncoder::FilterFlag::kPaeth }) {
+            for (int zlibLevel : { 0, 6, 9 }) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filters;
+                options.fZLibLevel = zlibLevel;
+                SkDynamicMemoryWStream serial;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src, options));
+
+                // Encode all at once, and a few rows at a time.
+                options.fExecutor = executor.get();
+                SkDynamicMemoryWStream parallel, incremental;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, src, options));
+                auto encoder = SkPngEncoder::Make(&incremental, src, options);
+                REPORTER_ASSERT(r, encoder);
+                for (int y = 0; y < src.height(); y += 77) {
+                    REPORTER_ASSERT(r, encoder->encodeRows(77));
+                }
+
+                // Compressing bands separately should cost very little.
+                REPORTER_ASSERT(r, parallel.bytesWritten() < serial.bytesWritten() * 21 / 20);
+
+                SkBitmap expected, bm0, bm1;
+                SkImage::MakeFromEncoded(serial.detachAsData())->asLegacyBitmap(&expected);
+                sk_sp<SkImage> image0 = SkImage::MakeFromEncoded(parallel.detachAsData()),
+                               image1 = SkImage::MakeFromEncoded(incremental.detachAsData());
+                REPORTER_ASSERT(r, image0 && image1);
+                if (!image0 || !image1) {
+                    continue;
+                }
+                image0->asLegacyBitmap(&bm0);
+                image1->asLegacyBitmap(&bm1);
+                REPORTER_ASSERT(r, almost_equals(expected, bm0, 0));
+                REPORTER_ASSERT(r, almost_equals(expected, bm1, 0));
+            }
+        }
+    }
+
+    // Enough bands that they can't all be deflated before the first is written.
+    SkBitmap tall;
+    tall.allocN32Pixels(1024, 2048, true);
+    for (int y = 0; y < tall.height(); y++) {
+        for (int x = 0; x < tall.width(); x++) {
+            *tall.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y & 0xFF, (x ^ y) & 0xFF);
+        }
+    }
+    SkPngEncoder::Options options;
+    options.fExecutor = executor.get();
+    SkDynamicMemoryWStream parallel;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, tall.pixmap(), options));
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(parallel.detachAsData());
+    SkBitmap decoded;
+    REPORTER_ASSERT(r, image && image->asLegacyBitmap(&decoded));
+    REPORTER_ASSERT(r, image && almost_equals(tall, decoded, 0));
+}
+
 DEF_TEST(Encode_WebpOptions, r) {
     SkBitmap bitmap;
     bool success = GetResourceAsBitmap("images/google_chrome.ico", &bitmap);
@@ -7,6 +7,7 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 #include "Test.h"
 
 namespace {
@@ -150,3 +151,63 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+namespace {
+struct SizedRec : public TestingRec {
+    SizedRec(const TestingKey& key, uint32_t value, size_t bytes)
+        : TestingRec(key, value), fBytes(bytes) {}
+
+    size_t fBytes;
+
+    size_t bytesUsed() const override { return fBytes; }
+};
+}
+
+DEF_TEST(ImageCache_global, r) {
+    // The global cache is split into independently locked segments. From several threads at
+    // once, make sure every rec can be found again, and that together the segments still keep
+    // to the global budget.
+    static const uint64_t kLargeID = 0x5E65E6;
+    static const uint64_t kSmallID = 0x5E65E7;
+    static const int kThreads = 8;
+    static const int kRecsPerThread = 256;
+    const size_t recBytes = SkResourceCache::GetTotalByteLimit() / 64;
+
+    SkTaskGroup().batch(kThreads, [&](int thread) {
+        for (int i = 0; i < kRecsPerThread; ++i) {
+            intptr_t value = thread * kRecsPerThread + i;
+            TestingKey key(value, kLargeID);
+            SkResourceCache::Add(new SizedRec(key, value, recBytes));
+
+            // Other threads may have already pushed it out of the cache.
+            intptr_t found = -1;
+            if (SkResourceCache::Find(key, TestingRec::Visitor, &found)) {
+                REPORTER_ASSERT(r, found == value);
+            }
+        }
+    });
+    REPORTER_ASSERT(r, SkResourceCache::GetTotalBytesUsed() <
+                       SkResourceCache::GetTotalByteLimit());
+
+    int count = 0;
+    SkResourceCache::VisitAll([](const SkResourceCache::Rec& rec, void* context) {
+        if (kLargeID == rec.getKey().getSharedID()) {
+            *(int*)context += 1;
+        }
+    }, &count);
+    REPORTER_ASSERT(r, count > 0 && count < 64);
+    SkResourceCache::PostPurgeSharedID(kLargeID);
+
+    // Segments can borrow budget from each other, so small recs should all stay cached.
+    static const int kSmallRecs = 1024;
+    SkTaskGroup().batch(kSmallRecs, [&](int i) {
+        SkResourceCache::Add(new TestingRec(TestingKey(-1 - i, kSmallID), i));
+    });
+    for (int i = 0; i < kSmallRecs; ++i) {
+        intptr_t found = -1;
+        REPORTER_ASSERT(r, SkResourceCache::Find(TestingKey(-1 - i, kSmallID),
+                                                 TestingRec::Visitor, &found));
+        REPORTER_ASSERT(r, found == i);
+    }
+    SkResourceCache::PostPurgeSharedID(kSmallID);
+}
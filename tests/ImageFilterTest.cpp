@@ -7,14 +7,17 @@
 
 #include "SkArithmeticImageFilter.h"
 #include "SkBitmap.h"
+#include "SkBitmapDevice.h"
 #include "SkBlurImageFilter.h"
 #include "SkCanvas.h"
 #include "SkColorFilterImageFilter.h"
+#include "SkColorMatrix.h"
 #include "SkColorMatrixFilter.h"
 #include "SkColorSpaceXformer.h"
 #include "SkComposeImageFilter.h"
 #include "SkDisplacementMapEffect.h"
 #include "SkDropShadowImageFilter.h"
+#include "SkExecutor.h"
 #include "SkGradientShader.h"
 #include "SkImage.h"
 #include "SkImageFilterPriv.h"
@@ -30,6 +33,7 @@
 #include "SkPictureImageFilter.h"
 #include "SkPictureRecorder.h"
 #include "SkPoint3.h"
+#include "SkRandom.h"
 #include "SkReadBuffer.h"
 #include "SkRect.h"
 #include "SkSpecialImage.h"
@@ -656,6 +660,161 @@ DEF_GPUTEST_FOR_RENDERING_CONTEXTS(ImageFilterNegativeBlurSigma_Gpu, reporter, c
 }
 #endif
 
+// Runs work as soon as it's added, so anything filtered with it is done strictly serially.
+class InlineExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { work(); }
+};
+
+// Large raster filters are split into bands on the context's executor.  Filters src, clipped to
+// clip, both serially and on a thread pool, and checks that every pixel of the two results
+// matches.  Returns the serial result and its offset for any further checks, or false if either
+// filter failed.
+static bool check_threaded_matches_serial(skiatest::Reporter* reporter, SkImageFilter* filter,
+                                          const SkBitmap& src, const SkIRect& clip,
+                                          SkBitmap* result = nullptr, SkIPoint* offset = nullptr) {
+    sk_sp<SkSpecialImage> imgSrc(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(src.width(),
+                                                                                src.height()),
+                                                                src));
+    // Not SkExecutor::GetDefault(), which DM makes a thread pool.
+    InlineExecutor inlineExecutor;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkImageFilter::OutputProperties noColorSpace(nullptr);
+    SkImageFilter::Context serialCtx(SkMatrix::I(), clip, nullptr, noColorSpace,
+                                     &inlineExecutor);
+    SkImageFilter::Context threadedCtx(SkMatrix::I(), clip, nullptr, noColorSpace,
+                                       executor.get());
+
+    SkIPoint serialOffset, threadedOffset;
+    sk_sp<SkSpecialImage> serial(filter->filterImage(imgSrc.get(), serialCtx, &serialOffset));
+    sk_sp<SkSpecialImage> threaded(filter->filterImage(imgSrc.get(), threadedCtx,
+                                                       &threadedOffset));
+    SkBitmap serialBM, threadedBM;
+    REPORTER_ASSERT(reporter, serial && serial->getROPixels(&serialBM));
+    REPORTER_ASSERT(reporter, threaded && threaded->getROPixels(&threadedBM));
+    if (!serial || !threaded) {
+        return false;
+    }
+    REPORTER_ASSERT(reporter, serialOffset == threadedOffset);
+    REPORTER_ASSERT(reporter, serialBM.dimensions() == threadedBM.dimensions());
+    for (int y = 0; y < serialBM.height(); y++) {
+        if (memcmp(serialBM.getAddr32(0, y), threadedBM.getAddr32(0, y),
+                   serialBM.width() * sizeof(uint32_t))) {
+            ERRORF(reporter, "threaded result differs in row %d", y);
+            break;
+        }
+    }
+
+    if (result) {
+        *result = serialBM;
+    }
+    if (offset) {
+        *offset = serialOffset;
+    }
+    return true;
+}
+
+DEF_TEST(ImageFilterBlurExecutor, reporter) {
+    // Check that banding doesn't change the blur, for each direction alone and for both together.
+    const int width = 700, height = 600;
+    SkBitmap gradient = make_gradient_circle(width, height);
+
+    const SkVector sigmas[] = { {8, 0}, {0, 8}, {3, 20} };
+    for (const SkVector& sigma : sigmas) {
+        sk_sp<SkImageFilter> filter(SkBlurImageFilter::Make(sigma.fX, sigma.fY, nullptr));
+        check_threaded_matches_serial(reporter, filter.get(), gradient,
+                                      SkIRect::MakeWH(width, height));
+    }
+}
+
+// The raster morphology filters clamp each window to the (possibly padded) input, given by bounds.
+// Padding is transparent.
+static SkPMColor brute_force_morph(const SkBitmap& src, const SkIRect& bounds, int x, int y,
+                                   int rx, int ry, bool dilate) {
+    uint8_t extreme[4];
+    for (int c = 0; c < 4; c++) {
+        extreme[c] = dilate ? 0x00 : 0xFF;
+    }
+    for (int j = SkTMax(y - ry, bounds.top()); j <= SkTMin(y + ry, bounds.bottom() - 1); j++) {
+        for (int i = SkTMax(x - rx, bounds.left()); i <= SkTMin(x + rx, bounds.right() - 1); i++) {
+            SkPMColor pixel = 0;
+            if (i >= 0 && i < src.width() && j >= 0 && j < src.height()) {
+                pixel = *src.getAddr32(i, j);
+            }
+            const uint8_t* p = (const uint8_t*)&pixel;
+            for (int c = 0; c < 4; c++) {
+                extreme[c] = dilate ? SkTMax(extreme[c], p[c]) : SkTMin(extreme[c], p[c]);
+            }
+        }
+    }
+    SkPMColor result;
+    memcpy(&result, extreme, sizeof(result));
+    return result;
+}
+
+// Random premultiplied pixels, all of them opaque if opaque is set.
+static SkBitmap make_noise(int width, int height, bool opaque) {
+    SkBitmap noise;
+    noise.allocN32Pixels(width, height, opaque);
+    SkRandom rand;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            U8CPU a = opaque ? 0xFF : rand.nextULessThan(256);
+            *noise.getAddr32(x, y) = SkPackARGB32(a, rand.nextULessThan(a + 1),
+                                                     rand.nextULessThan(a + 1),
+                                                     rand.nextULessThan(a + 1));
+        }
+    }
+    return noise;
+}
+
+DEF_TEST(ImageFilterMorphologyLargeRadius, reporter) {
+    // Raster morphology costs the same per pixel whatever the radius. Check it against a
+    // brute-force min/max over every window.
+    const int width = 560, height = 520;
+    SkBitmap noise = make_noise(width, height, false);
+    const SkIRect clip = SkIRect::MakeWH(width, height);
+
+    const SkISize radii[] = { {40, 0}, {0, 37}, {9, 60} };
+    for (const SkISize& radius : radii) {
+        for (bool dilate : { true, false }) {
+            sk_sp<SkImageFilter> filter =
+                    dilate ? SkDilateImageFilter::Make(radius.fWidth, radius.fHeight, nullptr)
+                           : SkErodeImageFilter::Make(radius.fWidth, radius.fHeight, nullptr);
+            SkBitmap resultBM;
+            SkIPoint offset;
+            if (!check_threaded_matches_serial(reporter, filter.get(), noise, clip,
+                                               &resultBM, &offset)) {
+                continue;
+            }
+            const SkIRect bounds = SkIRect::MakeXYWH(offset.x(), offset.y(),
+                                                     resultBM.width(), resultBM.height());
+            REPORTER_ASSERT(reporter, bounds.contains(clip));
+
+            // Spot check a diagonal band of pixels, which covers both edges in each direction.
+            const int w = bounds.width(), h = bounds.height();
+            for (int y = 0; y < h; y++) {
+                for (int x = y * w / h - 3; x <= y * w / h + 3; x++) {
+                    if (x < 0 || x >= w) {
+                        continue;
+                    }
+                    SkPMColor expected = brute_force_morph(noise, bounds,
+                                                           x + bounds.left(), y + bounds.top(),
+                                                           radius.fWidth, radius.fHeight,
+                                                           dilate);
+                    if (*resultBM.getAddr32(x, y) != expected) {
+                        ERRORF(reporter, "%s radius (%d, %d) differs at (%d, %d)",
+                               dilate ? "dilate" : "erode", radius.fWidth, radius.fHeight,
+                               x, y);
+                        y = h;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
 static void test_zero_blur_sigma(skiatest::Reporter* reporter, GrContext* context) {
     // Check that SkBlurImageFilter with a zero sigma and a non-zero srcOffset works correctly.
     SkImageFilter::CropRect cropRect(SkRect::Make(SkIRect::MakeXYWH(5, 0, 5, 10)));
@@ -1149,6 +1308,368 @@ DEF_TEST(ImageFilterMatrixConvolutionBorder, reporter) {
     canvas.restore();
 }
 
+DEF_TEST(ImageFilterMatrixConvolutionInterior, reporter) {
+    // Where the kernel stays within the source, raster matrix convolution runs vectorized, and in
+    // two 1D passes for separable kernels. Check those pixels against a direct 2D convolution.
+    const int width = 600, height = 560;
+    SkBitmap noise = make_noise(width, height, true);
+    // Keep the output within the source, so the opaque source is used without padding.
+    const SkIRect clip = SkIRect::MakeLTRB(8, 8, width - 8, height - 8);
+
+    // A separable 5x5 Gaussian, and a 7x7 edge detector that isn't separable.
+    const int gaussian[5] = { 1, 4, 6, 4, 1 };
+    SkScalar blur[25], edge[49];
+    for (int y = 0; y < 5; y++) {
+        for (int x = 0; x < 5; x++) {
+            blur[y * 5 + x] = SkIntToScalar(gaussian[x] * gaussian[y]);
+        }
+    }
+    for (int i = 0; i < 49; i++) {
+        edge[i] = -SK_Scalar1;
+    }
+    edge[24] = SkIntToScalar(48);
+
+    struct {
+        SkISize     fSize;
+        SkScalar*   fKernel;
+        SkScalar    fGain, fBias;
+        SkIPoint    fOffset;
+    } kernels[] = {
+        { { 5, 5 }, blur, 1.0f / 256,  0, { 2, 2 } },
+        { { 5, 5 }, blur, 1.0f / 256,  0, { 0, 4 } },
+        { { 7, 7 }, edge, 1.0f,       10, { 3, 3 } },
+    };
+
+    const SkMatrixConvolutionImageFilter::TileMode modes[] = {
+        SkMatrixConvolutionImageFilter::kClamp_TileMode,
+        SkMatrixConvolutionImageFilter::kRepeat_TileMode,
+        SkMatrixConvolutionImageFilter::kClampToBlack_TileMode,
+    };
+
+    for (const auto& k : kernels) {
+        for (auto mode : modes) {
+            for (bool convolveAlpha : { true, false }) {
+                sk_sp<SkImageFilter> filter(SkMatrixConvolutionImageFilter::Make(
+                        k.fSize, k.fKernel, k.fGain, k.fBias, k.fOffset, mode, convolveAlpha,
+                        nullptr));
+                SkBitmap serialBM;
+                SkIPoint serialOffset;
+                if (!check_threaded_matches_serial(reporter, filter.get(), noise, clip,
+                                                   &serialBM, &serialOffset)) {
+                    continue;
+                }
+
+                int mismatches = 0;
+                for (int y = 0; y < serialBM.height(); y++) {
+                    // Checking every fifth row is plenty, and keeps the test quick.
+                    // The clamp modes treat the output bounds as the edge of the source.
+                    const int srcY = y + serialOffset.y() - k.fOffset.y();
+                    if (y % 5 || srcY < clip.top() || srcY + k.fSize.height() > clip.bottom()) {
+                        continue;
+                    }
+                    for (int x = 0; x < serialBM.width(); x++) {
+                        const int srcX = x + serialOffset.x() - k.fOffset.x();
+                        if (srcX < clip.left() || srcX + k.fSize.width() > clip.right()) {
+                            continue;
+                        }
+                        SkScalar sumA = 0, sumR = 0, sumG = 0, sumB = 0;
+                        for (int cy = 0; cy < k.fSize.height(); cy++) {
+                            for (int cx = 0; cx < k.fSize.width(); cx++) {
+                                SkPMColor s = *noise.getAddr32(srcX + cx, srcY + cy);
+                                SkScalar weight = k.fKernel[cy * k.fSize.width() + cx];
+                                sumA += SkGetPackedA32(s) * weight;
+                                sumR += SkGetPackedR32(s) * weight;
+                                sumG += SkGetPackedG32(s) * weight;
+                                sumB += SkGetPackedB32(s) * weight;
+                            }
+                        }
+                        auto channel = [&](SkScalar sum, int max) {
+                            return SkClampMax(SkScalarFloorToInt(sum * k.fGain + k.fBias), max);
+                        };
+                        int a = convolveAlpha ? channel(sumA, 255) : 255;
+                        SkPMColor expected = SkPackARGB32(a, channel(sumR, a), channel(sumG, a),
+                                                          channel(sumB, a));
+                        if (*serialBM.getAddr32(x, y) != expected && mismatches++ == 0) {
+                            ERRORF(reporter, "%dx%d kernel, tile mode %d: (%d, %d) is %08x, "
+                                   "expected %08x", k.fSize.width(), k.fSize.height(), mode,
+                                   x, y, *serialBM.getAddr32(x, y), expected);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A lit surface, with the raster lighting filters' scalar math for any pixel not on the edge of
+// the filtered bounds: the interior Sobel normal, the light, then the lighting model.
+struct LightingCase {
+    enum Light { kDistant, kPoint, kSpot } fLight;
+    SkPoint3 fPoint;                            // The direction of distant lights, else location.
+    SkPoint3 fTarget;                           // Spot lights only.
+    SkScalar fSpecularExponent, fCutoffAngle;   // Spot lights only.
+    SkColor  fColor;
+    SkScalar fSurfaceScale;
+    bool     fSpecular;
+    SkScalar fK, fShininess;                    // fShininess is for specular lighting only.
+
+    sk_sp<SkImageFilter> makeFilter(const SkImageFilter::CropRect* crop) const {
+        switch (fLight) {
+            case kDistant:
+                return fSpecular
+                    ? SkLightingImageFilter::MakeDistantLitSpecular(fPoint, fColor, fSurfaceScale,
+                                                                    fK, fShininess, nullptr, crop)
+                    : SkLightingImageFilter::MakeDistantLitDiffuse(fPoint, fColor, fSurfaceScale,
+                                                                   fK, nullptr, crop);
+            case kPoint:
+                return fSpecular
+                    ? SkLightingImageFilter::MakePointLitSpecular(fPoint, fColor, fSurfaceScale,
+                                                                  fK, fShininess, nullptr, crop)
+                    : SkLightingImageFilter::MakePointLitDiffuse(fPoint, fColor, fSurfaceScale,
+                                                                 fK, nullptr, crop);
+            case kSpot:
+                return fSpecular
+                    ? SkLightingImageFilter::MakeSpotLitSpecular(fPoint, fTarget,
+                                                                 fSpecularExponent, fCutoffAngle,
+                                                                 fColor, fSurfaceScale, fK,
+                                                                 fShininess, nullptr, crop)
+                    : SkLightingImageFilter::MakeSpotLitDiffuse(fPoint, fTarget,
+                                                                fSpecularExponent, fCutoffAngle,
+                                                                fColor, fSurfaceScale, fK,
+                                                                nullptr, crop);
+        }
+        return nullptr;
+    }
+
+    static void Normalize(SkPoint3* v) {
+        SkScalar scale = sk_float_rsqrt(v->dot(*v) + SK_ScalarNearlyZero);
+        v->fX *= scale;
+        v->fY *= scale;
+        v->fZ *= scale;
+    }
+
+    // The lit color of (x, y) in src, which is transparent beyond its edges.
+    SkPMColor reference(const SkBitmap& src, int x, int y) const {
+        int m[9];
+        for (int j = 0; j < 3; j++) {
+            for (int i = 0; i < 3; i++) {
+                const int sx = x - 1 + i, sy = y - 1 + j;
+                bool inside = sx >= 0 && sx < src.width() && sy >= 0 && sy < src.height();
+                m[j * 3 + i] = inside ? SkGetPackedA32(*src.getAddr32(sx, sy)) : 0;
+            }
+        }
+        const SkScalar surfaceScale = fSurfaceScale / 255;
+        SkPoint3 normal = SkPoint3::Make(
+                -((-m[0] + m[2] - 2 * m[3] + 2 * m[5] - m[6] + m[8]) * 0.25f) * surfaceScale,
+                -((-m[0] + m[6] - 2 * m[1] + 2 * m[7] - m[2] + m[8]) * 0.25f) * surfaceScale,
+                1);
+        Normalize(&normal);
+
+        SkPoint3 surfaceToLight = fPoint;
+        SkPoint3 color = SkPoint3::Make(SkColorGetR(fColor), SkColorGetG(fColor),
+                                        SkColorGetB(fColor));
+        if (fLight != kDistant) {
+            surfaceToLight = SkPoint3::Make(fPoint.fX - x, fPoint.fY - y,
+                                            fPoint.fZ - m[4] * surfaceScale);
+            Normalize(&surfaceToLight);
+        }
+        if (fLight == kSpot) {
+            SkPoint3 s = fTarget - fPoint;
+            Normalize(&s);
+            const SkScalar exponent = SkScalarPin(fSpecularExponent, 1, 128),
+                           cosOuter = SkScalarCos(SkDegreesToRadians(fCutoffAngle)),
+                           cosInner = cosOuter + 0.016f,
+                           cosAngle = -surfaceToLight.dot(s);
+            SkScalar falloff = 0;
+            if (cosAngle >= cosOuter) {
+                falloff = SkScalarPow(cosAngle, exponent);
+                if (cosAngle < cosInner) {
+                    falloff *= (cosAngle - cosOuter) * SkScalarInvert(0.016f);
+                }
+            }
+            color = color.makeScale(falloff);
+        }
+
+        SkScalar colorScale;
+        if (fSpecular) {
+            SkPoint3 halfDir = surfaceToLight;
+            halfDir.fZ += 1;
+            Normalize(&halfDir);
+            colorScale = fK * SkScalarPow(normal.dot(halfDir), fShininess);
+        } else {
+            colorScale = fK * normal.dot(surfaceToLight);
+        }
+        color = color.makeScale(SkScalarClampMax(colorScale, 1));
+        auto byte = [](SkScalar v) { return SkClampMax(SkScalarRoundToInt(v), 255); };
+        const SkScalar maxComponent = SkTMax(color.fX, SkTMax(color.fY, color.fZ));
+        return SkPackARGB32(fSpecular ? byte(maxComponent) : 255,
+                            byte(color.fX), byte(color.fY), byte(color.fZ));
+    }
+};
+
+DEF_TEST(ImageFilterLightingExecutor, reporter) {
+    // Raster lighting runs four pixels at a time between the left and right columns. Check every
+    // light with both lighting models against the scalar math, including with a crop rect larger
+    // than the source.
+    const int width = 700, height = 600;
+    SkBitmap noise = make_noise(width, height, false);
+    const SkIRect clip = SkIRect::MakeLTRB(-10, -10, width + 10, height + 10);
+
+    const SkPoint3 direction = SkPoint3::Make(-0.6f, 0.3f, 0.74f);
+    const SkPoint3 location = SkPoint3::Make(200, 150, 80);
+    const SkPoint3 target = SkPoint3::Make(400, 300, 0);
+    const LightingCase cases[] = {
+        { LightingCase::kDistant, direction, {}, 0, 0, SK_ColorWHITE, 2, false, 1, 0 },
+        { LightingCase::kPoint, location, {}, 0, 0, 0xFFFF8040, 1.5f, false, 1, 0 },
+        { LightingCase::kSpot, location, target, 2, 30, 0xFF80FF40, 1, false, 1, 0 },
+        { LightingCase::kDistant, direction, {}, 0, 0, SK_ColorWHITE, 2, true, 1, 20 },
+        { LightingCase::kPoint, location, {}, 0, 0, 0xFFFF8040, 1.5f, true, 0.8f, 3.5f },
+        { LightingCase::kSpot, location, target, 2, 30, 0xFF80FF40, 1, true, 1, 8 },
+    };
+    SkImageFilter::CropRect crop(SkRect::MakeXYWH(-5, -5, width + 10, height + 10));
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(cases); i++) {
+        const LightingCase& c = cases[i];
+        sk_sp<SkImageFilter> filter = c.makeFilter(i % 3 == 2 ? &crop : nullptr);
+        SkBitmap resultBM;
+        SkIPoint offset;
+        if (!check_threaded_matches_serial(reporter, filter.get(), noise, clip,
+                                           &resultBM, &offset)) {
+            continue;
+        }
+
+        // Every third row is plenty, and keeps the test quick.
+        for (int y = 1; y < resultBM.height() - 1; y += 3) {
+            for (int x = 1; x < resultBM.width() - 1; x++) {
+                SkPMColor expected = c.reference(noise, x + offset.x(), y + offset.y());
+                if (*resultBM.getAddr32(x, y) != expected) {
+                    ERRORF(reporter, "case %d: (%d, %d) is %08x, expected %08x", (int)i,
+                           x, y, *resultBM.getAddr32(x, y), expected);
+                    y = resultBM.height();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(ImageFilterLightingFlat, reporter) {
+    // A flat surface faces straight up everywhere, edges included, so a distant light shades it
+    // uniformly by kd times the light's height.
+    const int width = 37, height = 9;
+    SkBitmap flat;
+    flat.allocN32Pixels(width, height);
+    flat.eraseColor(SkColorSetARGB(200, 200, 200, 200));
+    sk_sp<SkSpecialImage> imgSrc(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(width, height),
+                                                                flat));
+    SkImageFilter::OutputProperties noColorSpace(nullptr);
+    SkImageFilter::Context ctx(SkMatrix::I(), SkIRect::MakeWH(width, height), nullptr,
+                               noColorSpace);
+
+    sk_sp<SkImageFilter> filter(SkLightingImageFilter::MakeDistantLitDiffuse(
+            SkPoint3::Make(0.6f, 0, 0.8f), SK_ColorWHITE, 3, 0.5f, nullptr));
+    SkIPoint offset;
+    sk_sp<SkSpecialImage> result(filter->filterImage(imgSrc.get(), ctx, &offset));
+    SkBitmap resultBM;
+    REPORTER_ASSERT(reporter, result && result->getROPixels(&resultBM));
+    if (!result) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, resultBM.dimensions() == SkISize::Make(width, height));
+    const SkPMColor expected = SkPackARGB32(255, 102, 102, 102);
+    for (int y = 0; y < resultBM.height(); y++) {
+        for (int x = 0; x < resultBM.width(); x++) {
+            if (*resultBM.getAddr32(x, y) != expected) {
+                ERRORF(reporter, "(%d, %d) is %08x, expected %08x", x, y,
+                       *resultBM.getAddr32(x, y), expected);
+                return;
+            }
+        }
+    }
+}
+
+DEF_TEST(ImageFilterTiledEvaluation, reporter) {
+    // With a tile size set, raster devices evaluate filters that can filter in tiles one tile of
+    // their output at a time. Every pixel should match evaluating the whole output at once.
+    const int width = 600, height = 500;
+    SkBitmap noise;
+    noise.allocN32Pixels(width - 40, height - 40);
+    SkRandom rand;
+    for (int y = 0; y < noise.height(); y++) {
+        for (int x = 0; x < noise.width(); x++) {
+            int a = rand.nextULessThan(256);
+            *noise.getAddr32(x, y) = SkPreMultiplyARGB(a, rand.nextULessThan(256),
+                                                       rand.nextULessThan(256), 0x80);
+        }
+    }
+
+    sk_sp<SkImageFilter> blur(SkBlurImageFilter::Make(3, 3, nullptr));
+    sk_sp<SkImageFilter> offset(SkOffsetImageFilter::Make(15, -7, blur));
+    sk_sp<SkImageFilter> tint(SkColorFilterImageFilter::Make(
+            SkColorMatrixFilter::MakeLightingFilter(0xFF8080FF, 0x00200000), nullptr));
+    sk_sp<SkImageFilter> fill(SkColorFilterImageFilter::Make(
+            SkColorFilter::MakeModeFilter(0x40FF0000, SkBlendMode::kDstOver), blur));
+    sk_sp<SkImageFilter> mergeInputs[] = { blur, offset, tint };
+    SkImageFilter::CropRect crop(SkRect::MakeLTRB(50, 30, 420, 470));
+    sk_sp<SkImageFilter> filters[] = {
+        SkBlurImageFilter::Make(6, 9, nullptr),
+        SkMergeImageFilter::Make(mergeInputs, SK_ARRAY_COUNT(mergeInputs)),
+        SkComposeImageFilter::Make(SkOffsetImageFilter::Make(-20, 11, nullptr),
+                                   SkDilateImageFilter::Make(5, 3, nullptr)),
+        SkDropShadowImageFilter::Make(8, 5, 4, 4, SK_ColorBLUE,
+                SkDropShadowImageFilter::kDrawShadowAndForeground_ShadowMode, nullptr),
+        SkErodeImageFilter::Make(4, 7, offset),
+        SkXfermodeImageFilter::Make(SkBlendMode::kSrcOver, SkBlurImageFilter::Make(5, 5, tint),
+                                    offset, nullptr),
+        fill,
+        SkBlurImageFilter::Make(4, 2, offset, &crop),
+    };
+
+    // The tile size is set on the canvas' device, and its layer devices inherit it: when nested,
+    // the filtered layer is drawn into an unfiltered one.
+    auto draw = [&](sk_sp<SkImageFilter> filter, int tileSize, bool nested) {
+        SkBitmap result;
+        result.allocN32Pixels(width, height);
+        result.eraseColor(SK_ColorTRANSPARENT);
+        sk_sp<SkBitmapDevice> device(new SkBitmapDevice(result));
+        device->setImageFilterTileSize(tileSize);
+        SkCanvas canvas(std::move(device));
+        SkPaint paint;
+        paint.setImageFilter(std::move(filter));
+        canvas.clipRect(SkRect::MakeLTRB(3, 5, width - 2, height - 7));
+
+        if (nested) {
+            canvas.saveLayer(nullptr, nullptr);
+        }
+        canvas.saveLayer(nullptr, &paint);
+        canvas.drawBitmap(noise, 20, 20);
+        canvas.restoreToCount(1);
+        return result;
+    };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(filters); i++) {
+        REPORTER_ASSERT(reporter, filters[i]->canFilterInTiles());
+
+        SkBitmap whole = draw(filters[i], 0, false);
+        for (bool nested : { false, true }) {
+            SkBitmap tiled = draw(filters[i], 128, nested);
+            for (int y = 0; y < height; y++) {
+                if (memcmp(whole.getAddr32(0, y), tiled.getAddr32(0, y),
+                           width * sizeof(uint32_t))) {
+                    ERRORF(reporter, "filter %d differs in row %d%s", (int)i, y,
+                           nested ? " in a layer" : "");
+                    break;
+                }
+            }
+        }
+    }
+
+    // Lighting treats the edges of its output as the edges of the surface.
+    sk_sp<SkImageFilter> lighting(SkLightingImageFilter::MakeDistantLitDiffuse(
+            SkPoint3::Make(1, 1, 1), SK_ColorWHITE, 1, 1, blur));
+    REPORTER_ASSERT(reporter, !lighting->canFilterInTiles());
+}
+
 static void test_big_kernel(skiatest::Reporter* reporter, GrContext* context) {
     // Check that a kernel that is too big for the GPU still works
     SkScalar identityKernel[49] = {
@@ -1522,6 +2043,109 @@ DEF_GPUTEST_FOR_RENDERING_CONTEXTS(ComposedImageFilterOffset_Gpu, reporter, ctxI
 }
 #endif
 
+DEF_TEST(ImageFilterOffsetCollapse, reporter) {
+    sk_sp<SkImageFilter> blur(SkBlurImageFilter::Make(SK_Scalar1, SK_Scalar1, nullptr));
+    sk_sp<SkImageFilter> offsets(SkOffsetImageFilter::Make(3, 4,
+                                 SkOffsetImageFilter::Make(5, -6, blur)));
+    REPORTER_ASSERT(reporter, offsets->getInput(0) == blur.get());
+
+    // A cropped offset isn't just a translation, so it has to stay a separate node.
+    SkImageFilter::CropRect cropRect(SkRect::MakeWH(20, 20));
+    sk_sp<SkImageFilter> cropped(SkOffsetImageFilter::Make(3, 4,
+                                 SkOffsetImageFilter::Make(5, -6, blur, &cropRect)));
+    REPORTER_ASSERT(reporter, cropped->getInput(0) != blur.get());
+
+    // Composing keeps the offsets apart, and should give the same pixels.
+    sk_sp<SkImageFilter> composed(SkComposeImageFilter::Make(
+            SkOffsetImageFilter::Make(3, 4, nullptr),
+            SkComposeImageFilter::Make(SkOffsetImageFilter::Make(5, -6, nullptr), blur)));
+
+    SkBitmap noise = make_noise(100, 100, false);
+    sk_sp<SkSpecialImage> srcImg(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(100, 100),
+                                                                noise));
+    SkImageFilter::OutputProperties noColorSpace(nullptr);
+    SkImageFilter::Context ctx(SkMatrix::I(), SkIRect::MakeWH(100, 100), nullptr, noColorSpace);
+    SkIPoint composedOffset, offset;
+    sk_sp<SkSpecialImage> composedImg(composed->filterImage(srcImg.get(), ctx, &composedOffset));
+    sk_sp<SkSpecialImage> resultImg(offsets->filterImage(srcImg.get(), ctx, &offset));
+    REPORTER_ASSERT(reporter, composedImg && resultImg);
+    REPORTER_ASSERT(reporter, offset == composedOffset);
+
+    SkBitmap composedBM, resultBM;
+    REPORTER_ASSERT(reporter, composedImg->getROPixels(&composedBM));
+    REPORTER_ASSERT(reporter, resultImg->getROPixels(&resultBM));
+    REPORTER_ASSERT(reporter, composedBM.dimensions() == resultBM.dimensions());
+    for (int y = 0; y < resultBM.height(); y++) {
+        if (memcmp(composedBM.getAddr32(0, y), resultBM.getAddr32(0, y),
+                   resultBM.width() * sizeof(SkPMColor))) {
+            ERRORF(reporter, "collapsed offsets differ from composed offsets in row %d", y);
+            break;
+        }
+    }
+}
+
+DEF_TEST(ImageFilterColorFilterCollapse, reporter) {
+    uint8_t ramp[256];
+    for (int i = 0; i < 256; ++i) {
+        ramp[i] = SkToU8(255 - i);
+    }
+    SkColorMatrix scale;
+    scale.setScale(0.5f, 0.75f, 1, 1);
+    sk_sp<SkColorFilter> table(SkTableColorFilter::MakeARGB(nullptr, ramp, nullptr, ramp));
+    sk_sp<SkColorFilter> matrix(SkColorFilter::MakeMatrixFilterRowMajor255(scale.fMat));
+    sk_sp<SkImageFilter> blur(SkBlurImageFilter::Make(SK_Scalar1, SK_Scalar1, nullptr));
+
+    // Tables and per-component matrices fold in either order, so the whole run of color filter
+    // nodes is a single node over the blur.
+    sk_sp<SkImageFilter> chain = blur;
+    for (const auto& cf : { table, matrix, matrix, table, matrix }) {
+        chain = SkColorFilterImageFilter::Make(cf, std::move(chain));
+    }
+    REPORTER_ASSERT(reporter, chain->getInput(0) == blur.get());
+    SkColorFilter* cf;
+    REPORTER_ASSERT(reporter, chain->isColorFilterNode(&cf));
+    REPORTER_ASSERT(reporter, cf->asComponentTable(nullptr));
+    cf->unref();
+
+    // Composing the same color filter nodes, each with no input, keeps them apart.  Filtering
+    // noise through both should give the same pixels, give or take the rounding of each separate
+    // node: the same tolerance ColorFilterFoldChains allows its longer chains.
+    sk_sp<SkImageFilter> unfolded = blur;
+    for (const auto& nodeCF : { table, matrix, matrix, table, matrix }) {
+        unfolded = SkComposeImageFilter::Make(SkColorFilterImageFilter::Make(nodeCF, nullptr),
+                                              std::move(unfolded));
+    }
+
+    // Translucent noise: the blur marks its output opaque when its input is, even where it fades
+    // out at the edges, and the table filter would then skip unpremultiplying those pixels.
+    const SkBitmap noise = make_noise(64, 48, false);
+    sk_sp<SkSpecialImage> source(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(64, 48), noise));
+    SkImageFilter::OutputProperties noColorSpace(nullptr);
+    SkImageFilter::Context ctx(SkMatrix::I(), SkIRect::MakeWH(64, 48), nullptr, noColorSpace);
+    SkIPoint foldedOffset, unfoldedOffset;
+    sk_sp<SkSpecialImage> folded(chain->filterImage(source.get(), ctx, &foldedOffset)),
+                          expected(unfolded->filterImage(source.get(), ctx, &unfoldedOffset));
+    SkBitmap foldedBM, expectedBM;
+    REPORTER_ASSERT(reporter, folded && folded->getROPixels(&foldedBM));
+    REPORTER_ASSERT(reporter, expected && expected->getROPixels(&expectedBM));
+    if (!folded || !expected) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, foldedOffset == unfoldedOffset);
+    REPORTER_ASSERT(reporter, foldedBM.dimensions() == expectedBM.dimensions());
+    int maxDiff = 0;
+    for (int y = 0; y < foldedBM.height(); ++y) {
+        for (int x = 0; x < foldedBM.width(); ++x) {
+            const uint8_t* a = (const uint8_t*)foldedBM.getAddr32(x, y);
+            const uint8_t* b = (const uint8_t*)expectedBM.getAddr32(x, y);
+            for (int c = 0; c < 4; ++c) {
+                maxDiff = SkTMax(maxDiff, SkTAbs((int)a[c] - (int)b[c]));
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, maxDiff <= 2, "folded chain differs by %d", maxDiff);
+}
+
 static void test_composed_imagefilter_bounds(skiatest::Reporter* reporter, GrContext* context) {
     // The bounds passed to the inner filter must be filtered by the outer
     // filter, so that the inner filter produces the pixels that the outer
@@ -5,8 +5,11 @@
  * found in the LICENSE file.
  */
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <initializer_list>
+#include <thread>
 #include <vector>
 
 #include "SkAutoPixmapStorage.h"
@@ -14,6 +17,7 @@
 #include "SkCanvas.h"
 #include "SkColorSpacePriv.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkImageEncoder.h"
 #include "SkImageGenerator.h"
 #include "SkImage_Base.h"
@@ -22,6 +26,7 @@
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkRRect.h"
+#include "SkSemaphore.h"
 #include "SkSerialProcs.h"
 #include "SkStream.h"
 #include "SkSurface.h"
@@ -597,6 +602,116 @@ DEF_TEST(ImageEmpty, reporter) {
                                                             skstd::make_unique<EmptyGenerator>()));
 }
 
+namespace {
+// Counts its decodes.  If given a semaphore, each decode waits on it.
+class CountingGenerator : public SkImageGenerator {
+public:
+    CountingGenerator(std::atomic<int>* count, SkSemaphore* gate)
+        : SkImageGenerator(SkImageInfo::MakeN32Premul(16, 16))
+        , fCount(count)
+        , fGate(gate) {}
+
+protected:
+    bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                     const Options&) override {
+        fCount->fetch_add(1);
+        if (fGate) {
+            fGate->wait();
+        }
+        SkPixmap(info, pixels, rowBytes).erase(SK_ColorBLUE);
+        return true;
+    }
+
+private:
+    std::atomic<int>* fCount;
+    SkSemaphore*      fGate;
+};
+
+// Holds on to its tasks until told to run them.
+class DeferredExecutor : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { fWork.push_back(std::move(work)); }
+    void runAll() {
+        for (auto& work : fWork) {
+            work();
+        }
+        fWork.clear();
+    }
+
+private:
+    std::vector<std::function<void(void)>> fWork;
+};
+}
+
+DEF_TEST(Image_prefetchDecode, reporter) {
+    auto draw = [](SkImage* image) {
+        auto surface = SkSurface::MakeRasterN32Premul(image->width(), image->height());
+        surface->getCanvas()->drawImage(image, 0, 0);
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(1, 1);
+        return surface->readPixels(bitmap.pixmap(), 0, 0) &&
+               SK_ColorBLUE == bitmap.getColor(0, 0);
+    };
+
+    // Raster images have nothing to prefetch.
+    DeferredExecutor deferred;
+    std::atomic<int> count(0);
+    REPORTER_ASSERT(reporter, !create_image()->prefetchDecode(deferred, nullptr));
+
+    // A prefetched decode is found by the draw.
+    {
+        auto image = SkImage::MakeFromGenerator(
+                skstd::make_unique<CountingGenerator>(&count, nullptr));
+        auto handle = image->prefetchDecode(deferred, nullptr);
+        REPORTER_ASSERT(reporter, handle && !handle->isDone());
+        deferred.runAll();
+        handle->wait();
+        REPORTER_ASSERT(reporter, handle->isDone() && 1 == count);
+        REPORTER_ASSERT(reporter, draw(image.get()) && 1 == count);
+        REPORTER_ASSERT(reporter, !image->prefetchDecode(deferred, nullptr));
+    }
+
+    // A canceled decode never runs, and a draw that beats the decode to it is not repeated.
+    count = 0;
+    {
+        auto image = SkImage::MakeFromGenerator(
+                skstd::make_unique<CountingGenerator>(&count, nullptr));
+        auto handle = image->prefetchDecode(deferred, nullptr);
+        handle->cancel();
+        handle->wait();
+        REPORTER_ASSERT(reporter, handle->isDone());
+        deferred.runAll();
+        REPORTER_ASSERT(reporter, 0 == count);
+
+        handle = image->prefetchDecode(deferred, nullptr);
+        REPORTER_ASSERT(reporter, draw(image.get()) && 1 == count);
+        deferred.runAll();
+        handle->wait();
+        REPORTER_ASSERT(reporter, 1 == count);
+    }
+
+    // A draw while the decode is running waits for it.
+    count = 0;
+    {
+        SkSemaphore gate;
+        auto image = SkImage::MakeFromGenerator(
+                skstd::make_unique<CountingGenerator>(&count, &gate));
+        auto executor = SkExecutor::MakeFIFOThreadPool(1);
+        auto handle = image->prefetchDecode(*executor, nullptr);
+        while (0 == count) {
+            std::this_thread::yield();
+        }
+        bool drawn = false;
+        std::thread drawer([&] { drawn = draw(image.get()); });
+        // Give the draw a chance to find the image uncached.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate.signal(2);
+        drawer.join();
+        handle->wait();
+        REPORTER_ASSERT(reporter, drawn && 1 == count);
+    }
+}
+
 DEF_TEST(ImageDataRef, reporter) {
     SkImageInfo info = SkImageInfo::MakeN32Premul(1, 1);
     size_t rowBytes = info.minRowBytes();
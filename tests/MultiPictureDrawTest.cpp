@@ -0,0 +1,54 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkMultiPictureDraw.h"
+#include "SkPictureRecorder.h"
+#include "SkSurface.h"
+#include "Test.h"
+
+static sk_sp<SkPicture> make_fill(SkColor color) {
+    SkPictureRecorder recorder;
+    recorder.beginRecording(SkRect::MakeWH(16, 16))->drawColor(color, SkBlendMode::kSrc);
+    return recorder.finishRecordingAsPicture();
+}
+
+DEF_TEST(MultiPictureDraw_Raster, r) {
+    sk_sp<SkPicture> red   = make_fill(SK_ColorRED),
+                     green = make_fill(SK_ColorGREEN),
+                     blue  = make_fill(SK_ColorBLUE);
+
+    const int kSurfaces = 8;
+    sk_sp<SkSurface> surfaces[kSurfaces];
+    for (auto& surface : surfaces) {
+        surface = SkSurface::MakeRasterN32Premul(16, 16);
+    }
+
+    // Two canvases wrapping the same pixels.
+    SkBitmap shared;
+    shared.allocN32Pixels(16, 16);
+    SkCanvas sharedA(shared), sharedB(shared);
+
+    SkMultiPictureDraw mpd;
+    for (int i = 0; i < kSurfaces; i++) {
+        // Each independent surface sees red then (i%2 ? green : blue); only the last should stick.
+        mpd.add(surfaces[i]->getCanvas(), red.get());
+        mpd.add(surfaces[i]->getCanvas(), i % 2 ? green.get() : blue.get());
+    }
+    mpd.add(&sharedA, red.get());
+    mpd.add(&sharedB, green.get());
+    mpd.add(&sharedA, blue.get());
+    mpd.draw(true);
+
+    for (int i = 0; i < kSurfaces; i++) {
+        SkBitmap bm;
+        bm.allocN32Pixels(16, 16);
+        REPORTER_ASSERT(r, surfaces[i]->readPixels(bm.pixmap(), 0, 0));
+        REPORTER_ASSERT(r, bm.getColor(8, 8) == (i % 2 ? SK_ColorGREEN : SK_ColorBLUE));
+    }
+    REPORTER_ASSERT(r, shared.getColor(8, 8) == SK_ColorBLUE);
+}
@@ -6,6 +6,7 @@
  */
 
 #include "SkCanvas.h"
+#include "SkExecutor.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkPictureShader.h"
@@ -13,6 +14,8 @@
 #include "SkSurface.h"
 #include "Test.h"
 
+#include <vector>
+
 // Test that attempting to create a picture shader with a nullptr picture or
 // empty picture returns a shader that draws nothing.
 DEF_TEST(PictureShader_empty, reporter) {
@@ -78,3 +81,74 @@ DEF_TEST(PictureShader_caching, reporter) {
     // All but the local ref should be gone now.
     REPORTER_ASSERT(reporter, picture->unique());
 }
+
+// Test that tiles rendered on an executor are drawn at a nearby scale until they're ready.
+DEF_TEST(PictureShader_asyncTiles, reporter) {
+    struct DeferredExecutor : public SkExecutor {
+        void add(std::function<void(void)> work) override { fWork.push_back(std::move(work)); }
+        void runAll() {
+            for (auto& work : fWork) {
+                work();
+            }
+            fWork.clear();
+        }
+        std::vector<std::function<void(void)>> fWork;
+    } executor;
+
+    const size_t kBudget = 1024 * 1024;
+    sk_sp<SkPictureShader::AsyncTileCache> tiles =
+            SkPictureShader::AsyncTileCache::Make(&executor, kBudget);
+
+    SkPictureRecorder recorder;
+    recorder.beginRecording(10, 10)->drawColor(SK_ColorBLUE);
+    SkPaint paint;
+    paint.setShader(SkPictureShader::Make(recorder.finishRecordingAsPicture(),
+                                          SkShader::kRepeat_TileMode,
+                                          SkShader::kRepeat_TileMode, nullptr, nullptr, tiles));
+
+    sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(40, 40);
+    SkCanvas* canvas = surface->getCanvas();
+    auto draw = [&](SkScalar scale) {
+        canvas->clear(SK_ColorWHITE);
+        canvas->save();
+        canvas->scale(scale, scale);
+        canvas->drawPaint(paint);
+        canvas->restore();
+        SkBitmap bm;
+        bm.allocN32Pixels(1, 1);
+        REPORTER_ASSERT(reporter, surface->readPixels(bm.pixmap(), 20, 20));
+        REPORTER_ASSERT(reporter, *bm.getAddr32(0, 0) == SkPreMultiplyColor(SK_ColorBLUE));
+    };
+
+    // Nothing cached yet, so the first draw renders its own tile.
+    draw(1);
+    SkPictureShader::AsyncTileCache::Stats stats = tiles->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 0 && stats.fFallbacks == 0 && stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, executor.fWork.empty());
+
+    // A new scale draws with the existing tile while the new one is queued.
+    draw(2);
+    stats = tiles->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 0 && stats.fFallbacks == 1 && stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, executor.fWork.size() == 1);
+
+    // Drawing again before it's ready doesn't queue it twice.
+    draw(2);
+    REPORTER_ASSERT(reporter, tiles->stats().fFallbacks == 2);
+    REPORTER_ASSERT(reporter, executor.fWork.size() == 1);
+
+    executor.runAll();
+    draw(2);
+    stats = tiles->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1 && stats.fFallbacks == 2 && stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed >= (10*10 + 20*20) * sizeof(SkPMColor));
+    REPORTER_ASSERT(reporter, stats.fBytesUsed <= kBudget);
+
+    // Once the shader is gone, the next picture shader to use the cache purges its tiles.
+    recorder.beginRecording(10, 10)->drawColor(SK_ColorBLUE);
+    paint.setShader(SkPictureShader::Make(recorder.finishRecordingAsPicture(),
+                                          SkShader::kRepeat_TileMode,
+                                          SkShader::kRepeat_TileMode, nullptr, nullptr, tiles));
+    draw(1);
+    REPORTER_ASSERT(reporter, tiles->stats().fBytesUsed < 20*20 * sizeof(SkPMColor));
+}
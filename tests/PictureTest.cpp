@@ -9,6 +9,7 @@
 #include "SkBBoxHierarchy.h"
 #include "SkBigPicture.h"
 #include "SkBitmap.h"
+#include "SkBlurImageFilter.h"
 #include "SkCanvas.h"
 #include "SkClipOp.h"
 #include "SkClipOpPriv.h"
@@ -16,6 +17,7 @@
 #include "SkData.h"
 #include "SkFontStyle.h"
 #include "SkImageInfo.h"
+#include "SkMaskFilter.h"
 #include "SkMatrix.h"
 #include "SkMiniRecorder.h"
 #include "SkPaint.h"
@@ -873,3 +875,98 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+
+DEF_TEST(Picture_approximateCost, r) {
+    const SkRect cull = SkRect::MakeWH(200, 100);
+    SkRTreeFactory factory;
+
+    for (SkBBHFactory* bbh : { (SkBBHFactory*)nullptr, (SkBBHFactory*)&factory }) {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(cull, bbh);
+            // Left half: a plain rect drawn twice, then a blurred rect.
+            canvas->drawRect(SkRect::MakeWH(100, 100), SkPaint());
+            canvas->drawRect(SkRect::MakeWH(100, 100), SkPaint());
+            SkPaint blur;
+            blur.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 3));
+            canvas->drawRect(SkRect::MakeXYWH(10, 10, 10, 10), blur);
+
+            // Right half: a concave, image filtered path inside a saveLayer.
+            SkPaint layerPaint;
+            layerPaint.setAlpha(0x80);
+            canvas->saveLayer(SkRect::MakeXYWH(100, 0, 100, 100), &layerPaint);
+                SkPath path;
+                path.moveTo(110, 10);
+                path.lineTo(190, 10);
+                path.lineTo(150, 50);
+                path.lineTo(190, 90);
+                path.lineTo(110, 90);
+                path.close();
+                SkPaint pathPaint;
+                pathPaint.setImageFilter(SkBlurImageFilter::Make(2, 2, nullptr));
+                canvas->drawPath(path, pathPaint);
+            canvas->restore();
+
+            // Anywhere with perspective.
+            SkMatrix persp;
+            persp.setAll(1, 0, 0, 0, 1, 0, 0.001f, 0, 1);
+            canvas->concat(persp);
+            canvas->drawRect(SkRect::MakeXYWH(0, 0, 1, 1), SkPaint());
+        sk_sp<SkPicture> pic = recorder.finishRecordingAsPicture();
+
+        SkPicture::Cost cost = pic->approximateCost(cull);
+        REPORTER_ASSERT(r, cost.fOps == 6);
+        REPORTER_ASSERT(r, cost.fSaveLayers == 1);
+        REPORTER_ASSERT(r, cost.fBlurMaskFilters == 1);
+        REPORTER_ASSERT(r, cost.fImageFilters == 1);
+        REPORTER_ASSERT(r, cost.fComplexPaths == 1);
+        REPORTER_ASSERT(r, cost.fPerspective == 1);
+        // Overdraw counts: at least both full rects and the layer composite.
+        REPORTER_ASSERT(r, cost.fPixels >= 3 * 100 * 100);
+
+        // The left half doesn't see the saveLayer or the path.
+        SkPicture::Cost left = pic->approximateCost(SkRect::MakeWH(50, 50));
+        REPORTER_ASSERT(r, left.fSaveLayers == 0);
+        REPORTER_ASSERT(r, left.fComplexPaths == 0);
+        REPORTER_ASSERT(r, left.fBlurMaskFilters == 1);
+        REPORTER_ASSERT(r, left.fPixels < cost.fPixels);
+        REPORTER_ASSERT(r, left.fPixels >= 2 * 50 * 50);
+
+        SkPicture::Cost right = pic->approximateCost(SkRect::MakeXYWH(150, 50, 50, 50));
+        REPORTER_ASSERT(r, right.fSaveLayers == 1);
+        REPORTER_ASSERT(r, right.fImageFilters == 1);
+        REPORTER_ASSERT(r, right.fComplexPaths == 1);
+        REPORTER_ASSERT(r, right.fBlurMaskFilters == 0);
+    }
+
+    // A single op picture and a picture nested in another picture.
+    SkPictureRecorder recorder;
+    recorder.beginRecording(cull)->drawRect(SkRect::MakeWH(10, 10), SkPaint());
+    sk_sp<SkPicture> mini = recorder.finishRecordingAsPicture();
+    REPORTER_ASSERT(r, mini->approximateCost(cull).fOps == 1);
+    REPORTER_ASSERT(r, mini->approximateCost(cull).fPixels == 100);
+    REPORTER_ASSERT(r, mini->approximateCost(SkRect::MakeXYWH(50, 50, 10, 10)).fOps == 0);
+
+    // The inner picture needs more than one op, or drawPicture() unrolls it into the outer one.
+    SkCanvas* canvas = recorder.beginRecording(cull);
+        SkPaint blur;
+        blur.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 3));
+        canvas->drawRect(SkRect::MakeWH(10, 10), SkPaint());
+        canvas->drawRect(SkRect::MakeWH(10, 10), SkPaint());
+        canvas->drawRect(SkRect::MakeWH(10, 10), blur);
+    sk_sp<SkPicture> inner = recorder.finishRecordingAsPicture();
+    SkPicture::Cost innerCost = inner->approximateCost(cull);
+    REPORTER_ASSERT(r, innerCost.fOps == 3);
+    REPORTER_ASSERT(r, innerCost.fBlurMaskFilters == 1);
+
+    canvas = recorder.beginRecording(cull);
+        canvas->drawPicture(SkPicture::MakePlaceholder(cull));
+        canvas->drawPicture(mini);
+        canvas->drawPicture(inner);
+        canvas->drawPicture(inner);
+    sk_sp<SkPicture> outer = recorder.finishRecordingAsPicture();
+    REPORTER_ASSERT(r, outer->approximateOpCount() == 4);  // Only mini was unrolled.
+    SkPicture::Cost outerCost = outer->approximateCost(cull);
+    REPORTER_ASSERT(r, outerCost.fOps == 1 + 1 + 2 * innerCost.fOps);
+    REPORTER_ASSERT(r, outerCost.fBlurMaskFilters == 2 * innerCost.fBlurMaskFilters);
+    REPORTER_ASSERT(r, outerCost.fPixels >= 2 * innerCost.fPixels);
+}
@@ -8,9 +8,11 @@
 #include "Resources.h"
 #include "SkCanvas.h"
 #include "SkPipe.h"
+#include "SkPipeFormat.h"
 #include "SkPaint.h"
 #include "SkStream.h"
 #include "SkSurface.h"
+#include "SkTDArray.h"
 #include "Test.h"
 
 #include "SkNullCanvas.h"
@@ -185,3 +187,77 @@ DEF_TEST(Pipe_picture_draw_second, reporter) {
     size_t offset2 = stream.bytesWritten();
     REPORTER_ASSERT(reporter, offset2 <= 16);
 }
+
+static void draw_frame(SkCanvas* canvas, int frame) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 50; ++i) {
+        paint.setColor(SkColorSetARGB(0xFF, i * 5, 0x80, 0xFF - i * 5));
+        canvas->drawRect(SkRect::MakeXYWH(i * 2.0f, i * 1.5f, 20, 10), paint);
+    }
+    // Only this part of the scene moves.
+    canvas->save();
+    canvas->translate(SkIntToScalar(frame), SkIntToScalar(frame * 2));
+    paint.setColor(SK_ColorRED);
+    canvas->drawCircle(20, 20, 10, paint);
+    canvas->restore();
+    if (frame & 1) {
+        canvas->drawString("odd", 10, 90, paint);
+    }
+    for (int i = 0; i < 50; ++i) {
+        paint.setColor(SkColorSetARGB(0x80, 0, i * 5, 0));
+        canvas->drawOval(SkRect::MakeXYWH(100 - i * 2.0f, i * 1.5f, 10, 20), paint);
+    }
+}
+
+DEF_TEST(Pipe_frame_delta, reporter) {
+    const SkRect cull = SkRect::MakeWH(100, 100);
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(100, 100);
+
+    SkPipeSerializer serializer, plainSerializer;
+    SkPipeDeserializer deserializer;
+
+    for (int frame = 0; frame < 6; ++frame) {
+        SkDynamicMemoryWStream stream;
+        draw_frame(serializer.beginFrame(cull, &stream), frame);
+        serializer.endFrame();
+        sk_sp<SkData> data = stream.detachAsData();
+
+        SkDynamicMemoryWStream plainStream;
+        draw_frame(plainSerializer.beginWrite(cull, &plainStream), frame);
+        plainSerializer.endWrite();
+        if (frame > 0) {
+            REPORTER_ASSERT(reporter, data->size() * 4 < plainStream.bytesWritten());
+        }
+
+        auto expected = SkSurface::MakeRaster(info);
+        auto actual = SkSurface::MakeRaster(info);
+        expected->getCanvas()->clear(SK_ColorWHITE);
+        actual->getCanvas()->clear(SK_ColorWHITE);
+        draw_frame(expected->getCanvas(), frame);
+        REPORTER_ASSERT(reporter,
+                        deserializer.playback(data->data(), data->size(), actual->getCanvas()));
+        REPORTER_ASSERT(reporter, deep_equal(expected->makeImageSnapshot().get(),
+                                             actual->makeImageSnapshot().get()));
+    }
+}
+
+DEF_TEST(Pipe_frame_delta_nested, reporter) {
+    // A frame delta whose frame is itself a frame delta, which would otherwise recurse as deep as
+    // the data is nested.
+    const uint32_t inner[] = {
+        pack_verb(SkPipeVerb::kFrameDelta), 1, 1 << kCount_FrameDeltaShift,
+        pack_verb(SkPipeVerb::kSave),
+    };
+    const int innerCount = SK_ARRAY_COUNT(inner);
+    SkTDArray<uint32_t> outer;
+    outer.push(pack_verb(SkPipeVerb::kFrameDelta));
+    outer.push(innerCount);
+    outer.push(innerCount << kCount_FrameDeltaShift);
+    outer.append(innerCount, inner);
+
+    SkPipeDeserializer deserializer;
+    std::unique_ptr<SkCanvas> canvas = SkMakeNullCanvas();
+    REPORTER_ASSERT(reporter, deserializer.playback(inner, sizeof(inner), canvas.get()));
+    REPORTER_ASSERT(reporter, !deserializer.playback(outer.begin(), outer.bytes(), canvas.get()));
+}
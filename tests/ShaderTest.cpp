@@ -8,6 +8,7 @@
 #include "Test.h"
 #include "SkBitmap.h"
 #include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkImage.h"
 #include "SkPerlinNoiseShader.h"
 #include "SkRRect.h"
@@ -79,3 +80,87 @@ DEF_TEST(ComposeShaderSingle, reporter) {
     rr.setRectRadii({0, 0, 0, 0}, rd);
     canvas.drawRRect(rr, p);
 }
+
+// Noise should follow the canvas translation, and should look the same when its tables come from
+// the cache as when they were first built.
+DEF_TEST(PerlinNoise_translate, reporter) {
+    const SkISize tile = SkISize::Make(32, 24);
+    const int dx = 5, dy = 3;
+
+    auto draw = [&](SkBitmap* bm, int tx, int ty) {
+        SkPaint p;
+        p.setShader(SkPerlinNoiseShader::MakeTurbulence(0.1f, 0.07f, 3, 7.0f, &tile));
+        p.setBlendMode(SkBlendMode::kSrc);
+        bm->allocN32Pixels(48, 40);
+        SkCanvas canvas(*bm);
+        canvas.translate(SkIntToScalar(tx), SkIntToScalar(ty));
+        canvas.drawPaint(p);
+    };
+
+    SkBitmap first, second, translated;
+    draw(&first, 0, 0);
+    draw(&second, 0, 0);
+    draw(&translated, dx, dy);
+
+    bool varies = false;
+    for (int y = 0; y < first.height() - dy; ++y) {
+        for (int x = 0; x < first.width() - dx; ++x) {
+            SkPMColor c = *first.getAddr32(x, y);
+            REPORTER_ASSERT(reporter, c == *second.getAddr32(x, y));
+            REPORTER_ASSERT(reporter, c == *translated.getAddr32(x + dx, y + dy));
+            varies |= c != *first.getAddr32(0, 0);
+        }
+    }
+    REPORTER_ASSERT(reporter, varies);
+}
+
+// The perlin_noise stage should match the scalar SVG turbulence code it replaced.  These premul
+// ARGB values were drawn by that code; the stage may differ from them by rounding.
+DEF_TEST(PerlinNoise_reference, reporter) {
+    const SkISize tile = SkISize::Make(32, 24);
+    const SkIPoint points[] = {
+        {0, 0}, {5, 3}, {17, 9}, {31, 23}, {40, 2}, {12, 37}, {63, 63}, {50, 20},
+    };
+    const struct {
+        sk_sp<SkShader> fShader;
+        uint32_t        fExpected[SK_ARRAY_COUNT(points)];
+    } cases[] = {
+        { SkPerlinNoiseShader::MakeFractalNoise(0.05f, 0.08f, 2, 3.0f),
+          { 0x7e41403e, 0x8442361e, 0x84393342, 0x924e426a,
+            0x8c512e41, 0xbe438e86, 0x49232430, 0x59204624 } },
+        { SkPerlinNoiseShader::MakeTurbulence(0.1f, 0.07f, 3, 7.0f),
+          { 0x17060206, 0x52121832, 0x70262c1d, 0x3c041825,
+            0x783a1d30, 0x61351e53, 0x401f1526, 0x370b080a } },
+        { SkPerlinNoiseShader::MakeTurbulence(0.1f, 0.07f, 3, 7.0f, &tile),
+          { 0x06010001, 0x450f152d, 0x6f101b26, 0x00000000,
+            0x631f2328, 0x55161305, 0x370a0514, 0x1f100408 } },
+    };
+
+    for (const auto& c : cases) {
+        SkBitmap bm;
+        bm.allocN32Pixels(64, 64);
+        SkCanvas canvas(bm);
+        SkPaint p;
+        p.setShader(c.fShader);
+        p.setBlendMode(SkBlendMode::kSrc);
+        canvas.drawPaint(p);
+
+        for (size_t i = 0; i < SK_ARRAY_COUNT(points); ++i) {
+            // The table is ARGB; SkPMColor's byte order depends on the platform.
+            const uint32_t argb = c.fExpected[i];
+            SkPMColor actual = *bm.getAddr32(points[i].fX, points[i].fY),
+                      expected = SkPackARGB32(argb >> 24, (argb >> 16) & 0xFF,
+                                              (argb >> 8) & 0xFF, argb & 0xFF);
+            int diff = SkTMax(SkTMax(SkTAbs((int)SkGetPackedA32(actual) -
+                                            (int)SkGetPackedA32(expected)),
+                                     SkTAbs((int)SkGetPackedR32(actual) -
+                                            (int)SkGetPackedR32(expected))),
+                              SkTMax(SkTAbs((int)SkGetPackedG32(actual) -
+                                            (int)SkGetPackedG32(expected)),
+                                     SkTAbs((int)SkGetPackedB32(actual) -
+                                            (int)SkGetPackedB32(expected))));
+            REPORTER_ASSERT(reporter, diff <= 2, "(%d, %d): %08x, expected %08x", points[i].fX,
+                            points[i].fY, actual, expected);
+        }
+    }
+}
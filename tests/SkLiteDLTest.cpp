@@ -5,9 +5,13 @@
  * found in the LICENSE file.
  */
 
+#include "SkBBHFactory.h"
 #include "SkLiteDL.h"
 #include "SkLiteRecorder.h"
+#include "SkPictureRecorder.h"
 #include "SkRSXform.h"
+#include "SkSurface.h"
+#include "SkTaskGroup.h"
 #include "Test.h"
 
 DEF_TEST(SkLiteDL_basics, r) {
@@ -88,3 +92,81 @@ DEF_TEST(SkLiteRecorder_RSXformAlignment, r) {
     // We're just checking that this recorded our draw without SkASSERTing in Debug builds.
     REPORTER_ASSERT(r, !dl.empty());
 }
+
+DEF_TEST(SkLiteDL_BBH, r) {
+    SkLiteDL dl;
+    dl.save();
+        dl.translate(100, 100);
+        dl.drawRect(SkRect{0,0,10,10}, SkPaint{});
+    dl.restore();
+    dl.drawRect(SkRect{0,0,10,10}, SkPaint{});
+
+    SkRTreeFactory factory;
+    dl.finish(SkRect{0,0,200,200}, &factory);
+    REPORTER_ASSERT(r, dl.hasBBH());
+
+    // Counts the ops drawn into a canvas clipped to bounds, not counting the clip itself.
+    auto count_ops_drawn_into = [&](const SkRect& bounds) {
+        SkPictureRecorder rec;
+        SkCanvas* canvas = rec.beginRecording(SkRect{0,0,200,200});
+        canvas->clipRect(bounds);
+        dl.draw(canvas);
+        return rec.finishRecordingAsPicture()->approximateOpCount() - 1;
+    };
+
+    // Only the untranslated rect touches the top left corner...
+    REPORTER_ASSERT(r, 1 == count_ops_drawn_into(SkRect{0,0,50,50}));
+    // ... and the save, translate, rect, restore block is all that touches the bottom right.
+    REPORTER_ASSERT(r, 4 == count_ops_drawn_into(SkRect{90,90,150,150}));
+    REPORTER_ASSERT(r, 5 == count_ops_drawn_into(SkRect{0,0,200,200}));
+
+    // Recording anything new drops the BBH.
+    dl.drawRect(SkRect{0,0,10,10}, SkPaint{});
+    REPORTER_ASSERT(r, !dl.hasBBH());
+}
+
+DEF_TEST(SkLiteDL_ConcurrentDraw, r) {
+    SkLiteDL dl;
+    SkPath path;
+    path.addCircle(32, 32, 24);
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    dl.drawPath(path, paint);
+    dl.concat(SkMatrix::MakeScale(2, 2));
+    dl.drawRect(SkRect{4,4,12,12}, paint);
+
+    SkRTreeFactory factory;
+    dl.finish(SkRect{0,0,64,64}, &factory);
+
+    // Draw the one SkLiteDL into four tiles at once, then compare against a serial draw.
+    const int kTiles = 4;
+    sk_sp<SkSurface> tiles[kTiles];
+    for (auto& tile : tiles) {
+        tile = SkSurface::MakeRasterN32Premul(32, 32);
+    }
+    SkTaskGroup().batch(kTiles, [&](int i) {
+        SkCanvas* canvas = tiles[i]->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        canvas->translate(-32.0f * (i % 2), -32.0f * (i / 2));
+        dl.draw(canvas);
+    });
+
+    auto expected = SkSurface::MakeRasterN32Premul(64, 64);
+    expected->getCanvas()->clear(SK_ColorWHITE);
+    dl.draw(expected->getCanvas());
+
+    SkBitmap full;
+    full.allocN32Pixels(64, 64);
+    expected->readPixels(full.pixmap(), 0, 0);
+    for (int i = 0; i < kTiles; i++) {
+        SkBitmap tile;
+        tile.allocN32Pixels(32, 32);
+        tiles[i]->readPixels(tile.pixmap(), 0, 0);
+        for (int y = 0; y < 32; y++) {
+            for (int x = 0; x < 32; x++) {
+                REPORTER_ASSERT(r, *tile.getAddr32(x, y) ==
+                                   *full.getAddr32(x + 32 * (i % 2), y + 32 * (i / 2)));
+            }
+        }
+    }
+}
@@ -232,3 +232,70 @@ DEF_TEST(SkRasterPipeline_lowp, r) {
         }
     }
 }
+
+DEF_TEST(SkRasterPipeline_binary_search_gradient, r) {
+    // binary_search_gradient should pick exactly the same stop as gradient's linear search,
+    // including for t exactly on a stop, outside [0,1], and NaN.
+    const int kStops = 37;
+    float fs[4][kStops], bs[4][kStops], ts[kStops];
+    for (int i = 0; i < kStops; i++) {
+        ts[i] = i / (kStops - 1.0f);
+        for (int c = 0; c < 4; c++) {
+            fs[c][i] = 0.5f * c;
+            bs[c][i] = i / (float)kStops;
+        }
+    }
+    SkJumper_GradientCtx ctx;
+    ctx.stopCount = kStops;
+    ctx.ts = ts;
+    for (int c = 0; c < 4; c++) {
+        ctx.fs[c] = fs[c];
+        ctx.bs[c] = bs[c];
+    }
+
+    // highp, with t loaded straight from memory.
+    const int N = 64;
+    float src[4*N], linear[4*N], binary[4*N];
+    for (int i = 0; i < N; i++) {
+        src[4*i+0] = i < 2*kStops ? ts[i/2] + (i & 1) * 0.001f : (i - 2*kStops) * 0.37f - 2;
+        src[4*i+1] = src[4*i+2] = src[4*i+3] = 0;
+    }
+    src[4*(N-1)] = SK_FloatNaN;
+
+    auto run_highp = [&](SkRasterPipeline::StockStage stage, float* dst) {
+        SkJumper_MemoryCtx srcCtx = { src, 0 },
+                           dstCtx = { dst, 0 };
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipeline::load_f32, &srcCtx);
+        p.append(stage, &ctx);
+        p.append(SkRasterPipeline::store_f32, &dstCtx);
+        p.run(0,0,N,1);
+    };
+    run_highp(SkRasterPipeline::gradient,               linear);
+    run_highp(SkRasterPipeline::binary_search_gradient, binary);
+    for (int i = 0; i < 4*N; i++) {
+        if (memcmp(&linear[i], &binary[i], sizeof(float))) {
+            ERRORF(r, "highp t=%g: got %g, want %g\n", src[i & ~3], binary[i], linear[i]);
+        }
+    }
+
+    // lowp, with t from the x coordinate.
+    uint32_t linear8888[N], binary8888[N];
+    auto run_lowp = [&](SkRasterPipeline::StockStage stage, uint32_t* dst) {
+        const float matrix[] = { 1.0f / (N - 8), 1, -4.0f / (N - 8), 0 };
+        SkJumper_MemoryCtx dstCtx = { dst, 0 };
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipeline::seed_shader);
+        p.append(SkRasterPipeline::matrix_scale_translate, matrix);
+        p.append(stage, &ctx);
+        p.append(SkRasterPipeline::store_8888, &dstCtx);
+        p.run(0,0,N,1);
+    };
+    run_lowp(SkRasterPipeline::gradient,               linear8888);
+    run_lowp(SkRasterPipeline::binary_search_gradient, binary8888);
+    for (int i = 0; i < N; i++) {
+        if (linear8888[i] != binary8888[i]) {
+            ERRORF(r, "lowp x=%d: got %08x, want %08x\n", i, binary8888[i], linear8888[i]);
+        }
+    }
+}
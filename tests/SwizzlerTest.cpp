@@ -5,7 +5,9 @@
  * found in the LICENSE file.
  */
 
+#include "SkColorData.h"
 #include "SkImageInfoPriv.h"
+#include "SkRandom.h"
 #include "SkSwizzle.h"
 #include "SkSwizzler.h"
 #include "Test.h"
@@ -161,3 +163,55 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+// Check the optimized row procs against simple loops, for every length up to a few vectors.
+DEF_TEST(SwizzleOpts_rows, r) {
+    SkRandom rand;
+    uint32_t ctable[256];
+    for (uint32_t& c : ctable) {
+        c = rand.nextU();
+    }
+
+    const int kMax = 67;
+    uint32_t srcPixels[2 * kMax];
+    uint8_t* src = (uint8_t*) srcPixels;
+    const int srcBytes = sizeof(srcPixels);
+    uint32_t dst32[kMax];
+    uint16_t dst16[kMax];
+    for (int count = 0; count <= kMax; count++) {
+        for (int i = 0; i < srcBytes; i++) {
+            src[i] = rand.nextU() >> 24;
+        }
+
+        uint8_t dst8[4 * kMax];
+        SkOpts::strip_16_to_8(dst8, src, 2 * count);
+        for (int i = 0; i < 2 * count; i++) {
+            REPORTER_ASSERT(r, dst8[i] == src[2 * i]);
+        }
+
+        SkOpts::index_to_n32(dst32, src, count, ctable);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst32[i] == ctable[src[i]]);
+        }
+
+        SkOpts::RGBA_to_565(dst16, srcPixels, count);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst16[i] == SkPack888ToRGB16(src[4*i+0], src[4*i+1], src[4*i+2]));
+        }
+        SkOpts::BGRA_to_565(dst16, srcPixels, count);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst16[i] == SkPack888ToRGB16(src[4*i+2], src[4*i+1], src[4*i+0]));
+        }
+
+        for (int stride : { 4, 6, 8 }) {
+            const int n = (srcBytes - 4) / stride + 1;
+            const int gathered = SkTMin(count, n);
+            SkOpts::gather_32(dst32, src, gathered, stride);
+            for (int i = 0; i < gathered; i++) {
+                uint32_t expected;
+                memcpy(&expected, src + i * stride, 4);
+                REPORTER_ASSERT(r, dst32[i] == expected);
+            }
+        }
+    }
+}